@@ -0,0 +1,63 @@
+#!/bin/sh
+# Сравнение подсистем ввода-вывода пакетного режима cipher_tool
+#
+# Использование: bench/batch_bench.sh [ФАЙЛОВ [БАЙТ_В_ФАЙЛЕ [ПОТОКОВ [ПОВТОРОВ]]]]
+# По умолчанию 10000 файлов по 8 КиБ, 3 повтора. Каталог с данными
+# создаётся во временном каталоге и удаляется по завершении. Для каждой
+# подсистемы выводится лучшее время; перед каждым запуском выполняется
+# sync, чтобы отложенная запись предыдущего запуска не искажала замер.
+# Результаты всех подсистем сравниваются побайтно.
+
+set -e
+
+FILES=${1:-10000}
+SIZE=${2:-8192}
+THREADS=${3:-0}
+REPEAT=${4:-3}
+TOOL=$(dirname "$0")/../cipher_tool
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "Генерация $FILES файлов по $SIZE байт в $WORK ..."
+mkdir "$WORK/in"
+# Строка: 31 русская буква (62 байта UTF-8) и перевод строки
+LINE="ПРИВЕТМИРЭТОТЕКСТДЛЯШИФРОВАНИЯ"
+i=0
+BLOCK=""
+while [ $(( ${#BLOCK} * 2 )) -lt "$SIZE" ]; do
+    BLOCK="$BLOCK$LINE
+"
+done
+printf '%s' "$BLOCK" | head -c "$SIZE" > "$WORK/sample"
+while [ $i -lt "$FILES" ]; do
+    cp "$WORK/sample" "$WORK/in/f$i.txt"
+    i=$((i + 1))
+done
+
+for backend in stdio threads uring; do
+    best=""
+    run=0
+    while [ $run -lt "$REPEAT" ]; do
+        rm -rf "$WORK/$backend"
+        mkdir "$WORK/$backend"
+        sync
+        # Прогрев кеша страниц входных файлов
+        cat "$WORK"/in/* > /dev/null
+        if ! "$TOOL" -e -c alpha -k ШИФР -p -t "$THREADS" -B $backend -o "$WORK/$backend" -v \
+                "$WORK"/in/* 2> "$WORK/$backend.log"; then
+            echo "$backend: ошибка"
+            cat "$WORK/$backend.log"
+            break
+        fi
+        seconds=$(sed -n 's/^Время: \([0-9.e-]*\) с.*/\1/p' "$WORK/$backend.log")
+        best=$(printf '%s\n' $best $seconds | sort -g | head -n 1)
+        run=$((run + 1))
+    done
+    [ -n "$best" ] && echo "$best" | awk -v b=$backend -v n="$FILES" \
+        '{ printf "%-8s лучшее время %.3f с, %.0f файлов/с\n", b, $1, n / $1 }'
+done
+
+diff -r "$WORK/stdio" "$WORK/threads" > /dev/null && echo "threads: результат совпадает со stdio"
+if [ -d "$WORK/uring" ] && diff -r "$WORK/stdio" "$WORK/uring" > /dev/null; then
+    echo "uring:   результат совпадает со stdio"
+fi
@@ -0,0 +1,203 @@
+/**
+ * @file AlphaLineCipher.cpp
+ * @brief Адаптер modAlphaCipher для конвейера
+ *
+ * Строки в UTF-8, CP1251 и KOI8-R шифруются байтовыми методами
+ * modAlphaCipher без преобразования в std::wstring. Шифр не проверяет
+ * UTF-8 вне букв, поэтому адаптер проверяет его сам: неверная строка -
+ * ошибка "Invalid UTF-8".
+ *
+ * Блоки контейнера шифруются как продолжение одного потока: позиция
+ * потока - число букв перед блоком, она же параметр блока, по которому
+ * блок дешифруется независимо. Блок без букв в режиме Filter даёт
+ * пустой шифротекст.
+ */
+
+#include "LineCipher.h"
+#include "modAlphaCipher.h"
+#include <codecvt>
+#include <locale>
+
+namespace {
+
+/**
+ * @brief Проверяет, что текст - корректный UTF-8
+ * @return false для лишних и недостающих байтов продолжения, избыточных
+ *         (overlong) последовательностей и кодов больше U+10FFFF
+ *
+ * Суррогаты допускаются, как в std::codecvt_utf8, которым адаптер
+ * проверял строки раньше. ASCII проходится без разбора последовательностей.
+ */
+bool validUtf8(const std::string& text)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.size();
+    for (size_t i = 0; i < n;) {
+        unsigned char c = s[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+        if (c < 0xC2 || c > 0xF4 || n - i < length)
+            return false;
+        // Границы второго байта отсекают избыточные последовательности и коды за U+10FFFF
+        unsigned char low = c == 0xE0 ? 0xA0 : c == 0xF0 ? 0x90 : 0x80;
+        unsigned char high = c == 0xF4 ? 0x8F : 0xBF;
+        if (s[i + 1] < low || s[i + 1] > high)
+            return false;
+        for (size_t j = 2; j < length; j++)
+            if ((s[i + j] & 0xC0) != 0x80)
+                return false;
+        i += length;
+    }
+    return true;
+}
+
+/**
+ * @class AlphaLineCipher
+ * @brief Построчный адаптер модифицированного алфавитного шифра
+ */
+class AlphaLineCipher final : public LineCipherImpl<AlphaLineCipher>
+{
+private:
+    modAlphaCipher cipher;              ///< Шифр
+    modAlphaCipher::Encoding encoding;  ///< Кодировка строк
+
+public:
+    /**
+     * @brief Конструктор
+     * @param options Параметры шифра (ключ - в UTF-8)
+     * @param encoding Кодировка строк
+     * @throw cipher_error если ключ невалиден
+     */
+    AlphaLineCipher(const CipherOptions& options, modAlphaCipher::Encoding encoding) :
+        cipher(std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(options.key),
+               options.passthrough ? modAlphaCipher::TextMode::Passthrough
+                                   : modAlphaCipher::TextMode::Filter,
+               options.preserveCase),
+        encoding(encoding)
+    {
+    }
+
+    /**
+     * @brief Конструктор над готовым шифром
+     * @param cipher Шифр
+     * @param encoding Кодировка строк
+     */
+    AlphaLineCipher(const modAlphaCipher& cipher, modAlphaCipher::Encoding encoding) :
+        cipher(cipher), encoding(encoding)
+    {
+    }
+
+    /**
+     * @brief Шифрует или дешифрует строку (см. LineCipherImpl)
+     */
+    bool transformLine(const std::string& in, std::string& out, std::string& error, bool decrypt)
+    {
+        if (!valid(in, error))
+            return false;
+        modAlphaCipher::ByteResult result = decrypt ? cipher.tryDecrypt(in, encoding)
+                                                    : cipher.tryEncrypt(in, encoding);
+        if (!result) {
+            error = modAlphaCipher::errorMessage(result.error);
+            return false;
+        }
+        out.swap(result.text);
+        return true;
+    }
+
+    /**
+     * @brief Шифрует блок контейнера с позиции потока position
+     */
+    bool encryptBlock(const std::string& in, uint64_t& position, std::string& out, uint64_t& param,
+                      std::string& error) override
+    {
+        if (!valid(in, error))
+            return false;
+        param = position;
+        modAlphaCipher::ByteResult result = cipher.tryEncrypt(in, encoding, position);
+        if (!result && result.error != modAlphaCipher::Error::EmptyOpenText) {
+            error = modAlphaCipher::errorMessage(result.error);
+            return false;
+        }
+        position += modAlphaCipher::countLetters(in, encoding);
+        out.swap(result.text);
+        return true;
+    }
+
+    /**
+     * @brief Дешифрует блок контейнера с позиции потока param
+     */
+    bool decryptBlock(const std::string& in, uint64_t param, std::string& out, std::string& error) override
+    {
+        out.clear();
+        if (in.empty())
+            return true;
+        if (!valid(in, error))
+            return false;
+        modAlphaCipher::ByteResult result = cipher.tryDecrypt(in, encoding, param);
+        if (!result) {
+            error = modAlphaCipher::errorMessage(result.error);
+            return false;
+        }
+        out.swap(result.text);
+        return true;
+    }
+
+private:
+    /**
+     * @brief Проверяет UTF-8 (однобайтовые кодировки не проверяются)
+     * @return false с сообщением в error для неверного UTF-8
+     */
+    bool valid(const std::string& in, std::string& error) const
+    {
+        if (encoding != modAlphaCipher::Encoding::UTF8 || validUtf8(in))
+            return true;
+        error = "Invalid UTF-8";
+        return false;
+    }
+};
+
+/**
+ * @brief Кодировка строк по имени
+ * @throw cipher_error если кодировка неизвестна
+ */
+modAlphaCipher::Encoding parseEncoding(const std::string& encoding)
+{
+    if (encoding == "utf8")
+        return modAlphaCipher::Encoding::UTF8;
+    if (encoding == "cp1251")
+        return modAlphaCipher::Encoding::CP1251;
+    if (encoding == "koi8r")
+        return modAlphaCipher::Encoding::KOI8R;
+    throw cipher_error("Неизвестная кодировка: " + encoding);
+}
+
+} // namespace
+
+/**
+ * @brief Создаёт адаптер modAlphaCipher
+ * @param options Параметры шифра
+ * @throw std::invalid_argument если ключ невалиден
+ */
+std::unique_ptr<LineCipher> makeAlphaLineCipher(const CipherOptions& options)
+{
+    modAlphaCipher::Encoding encoding = parseEncoding(options.encoding);
+    try {
+        return std::unique_ptr<LineCipher>(new AlphaLineCipher(options, encoding));
+    } catch (const std::range_error&) {
+        throw cipher_error("Invalid key");
+    }
+}
+
+/**
+ * @brief Создаёт адаптер над готовым modAlphaCipher
+ * @param cipher Шифр (адаптер хранит его копию)
+ * @param encoding Кодировка строк
+ * @throw std::invalid_argument если кодировка неизвестна
+ */
+std::unique_ptr<LineCipher> makeAlphaLineCipher(const modAlphaCipher& cipher, const std::string& encoding)
+{
+    return std::unique_ptr<LineCipher>(new AlphaLineCipher(cipher, parseEncoding(encoding)));
+}
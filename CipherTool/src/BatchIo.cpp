@@ -0,0 +1,715 @@
+/**
+ * @file BatchIo.cpp
+ * @brief Реализация пакетного шифрования файлов
+ */
+
+#include "BatchIo.h"
+#include "Uring.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @struct FileResult
+ * @brief Итоги обработки одного файла
+ */
+struct FileResult {
+    size_t bytesIn = 0;     ///< Обработано байт
+    size_t bytesOut = 0;    ///< Записано байт
+    size_t lines = 0;       ///< Обработано строк
+    LineErrors errors;      ///< Ошибки строк (номера строк в файле)
+    std::string failure;    ///< Ошибка ввода-вывода, если была
+};
+
+/**
+ * @class Batch
+ * @brief Общее состояние пакета: очередь файлов и итоги
+ */
+class Batch
+{
+private:
+    const std::vector<BatchJob>& jobs;  ///< Файлы пакета
+    std::atomic<size_t> next;           ///< Индекс следующего файла
+    std::ostream& log;                  ///< Поток сообщений об ошибках
+    std::mutex lock;                    ///< Защита log, stats и failure
+    std::exception_ptr failure;         ///< Первая ошибка рабочего потока
+
+public:
+    const BatchOptions& options;        ///< Параметры
+    BatchStats stats;                   ///< Итоги
+
+    Batch(const std::vector<BatchJob>& jobs, const BatchOptions& options, std::ostream& log) :
+        jobs(jobs), next(0), log(log), options(options) {}
+
+    /**
+     * @brief Берёт следующий файл
+     * @return nullptr, если файлы закончились
+     */
+    const BatchJob* take()
+    {
+        size_t i = next++;
+        return i < jobs.size() ? &jobs[i] : nullptr;
+    }
+
+    /**
+     * @brief Учитывает итоги файла и выводит его ошибки
+     */
+    void finish(const BatchJob& job, const FileResult& file)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stats.files++;
+        stats.bytesIn += file.bytesIn;
+        stats.bytesOut += file.bytesOut;
+        stats.lines += file.lines;
+        stats.errors += file.errors.size();
+        for (const auto& e : file.errors)
+            log << job.input << ": строка " << e.first + 1 << ": " << e.second << "\n";
+        if (!file.failure.empty()) {
+            stats.failed++;
+            log << job.input << ": " << file.failure << "\n";
+        }
+    }
+
+    /**
+     * @brief Запоминает ошибку рабочего потока (не связанную с файлом)
+     */
+    void abort(std::exception_ptr e)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!failure)
+            failure = e;
+        next = jobs.size();
+    }
+
+    /**
+     * @brief Повторно выбрасывает ошибку рабочего потока, если она была
+     */
+    void rethrow()
+    {
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+};
+
+/**
+ * @brief Исключение с текстом системной ошибки
+ */
+std::runtime_error systemError(const std::string& what, int code)
+{
+    return std::runtime_error(what + ": " + std::strerror(code));
+}
+
+/**
+ * @brief Длина префикса буфера из целых строк
+ * @param eof Достигнут конец файла: последняя строка может быть без перевода строки
+ * @return 0, если в буфере нет ни одной целой строки
+ */
+size_t completeLines(const char* data, size_t size, bool eof)
+{
+    if (eof)
+        return size;
+    const void* last = ::memrchr(data, '\n', size);
+    return last ? static_cast<const char*>(last) - data + 1 : 0;
+}
+
+/**
+ * @brief Обрабатывает блок целых строк файла
+ *
+ * Номера строк с ошибками переводятся из номеров в блоке в номера в файле.
+ */
+void transformBlock(const char* data, size_t size, LineCipher& cipher, bool decrypt,
+                    std::string& output, FileResult& file)
+{
+    size_t first = file.errors.size();
+    size_t lines = cipher.processLines(data, size, decrypt, output, file.errors);
+    for (size_t i = first; i < file.errors.size(); i++)
+        file.errors[i].first += file.lines;
+    file.lines += lines;
+    file.bytesIn += size;
+}
+
+/**
+ * @struct Worker
+ * @brief Состояние рабочего потока блокирующих подсистем
+ */
+struct Worker {
+    std::unique_ptr<LineCipher> cipher; ///< Шифр потока
+    std::vector<char> buffer;           ///< Буфер чтения
+    std::string output;                 ///< Результат блока
+};
+
+/**
+ * @brief Обрабатывает файл блоками через функции чтения и записи
+ * @tparam Read size_t(char*, size_t): прочитано байт, 0 в конце файла
+ * @tparam Write void(const char*, size_t): записывает буфер целиком
+ * @throw std::runtime_error если строка длиннее буфера
+ */
+template <class Read, class Write>
+void transformFile(Read read, Write write, Worker& worker, bool decrypt, FileResult& file)
+{
+    std::vector<char>& buffer = worker.buffer;
+    size_t filled = 0;
+    bool eof = false;
+    while (!eof) {
+        size_t n = read(buffer.data() + filled, buffer.size() - filled);
+        eof = n == 0;
+        filled += n;
+        size_t take = completeLines(buffer.data(), filled, eof);
+        if (take == 0) {
+            if (!eof && filled == buffer.size())
+                throw std::runtime_error("строка длиннее буфера");
+            continue;
+        }
+        worker.output.clear();
+        transformBlock(buffer.data(), take, *worker.cipher, decrypt, worker.output, file);
+        write(worker.output.data(), worker.output.size());
+        file.bytesOut += worker.output.size();
+        filled -= take;
+        std::memmove(buffer.data(), buffer.data() + take, filled);
+    }
+}
+
+/**
+ * @brief Закрывает дескриптор при выходе из области видимости
+ */
+struct FdGuard {
+    int fd;
+    ~FdGuard() { if (fd >= 0) ::close(fd); }
+};
+
+/**
+ * @brief Обрабатывает файл через pread/pwrite
+ * @throw std::runtime_error при ошибке ввода-вывода
+ */
+void posixFile(const BatchJob& job, Worker& worker, bool decrypt, FileResult& file)
+{
+    FdGuard in{::open(job.input.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (in.fd < 0)
+        throw systemError("открытие", errno);
+    FdGuard out{::open(job.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (out.fd < 0)
+        throw systemError(job.output, errno);
+
+    off_t readOffset = 0, writeOffset = 0;
+    auto read = [&](char* data, size_t size) {
+        for (;;) {
+            ssize_t n = ::pread(in.fd, data, size, readOffset);
+            if (n >= 0) {
+                readOffset += n;
+                return static_cast<size_t>(n);
+            }
+            if (errno != EINTR)
+                throw systemError("чтение", errno);
+        }
+    };
+    auto write = [&](const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::pwrite(out.fd, data, size, writeOffset);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw systemError("запись", errno);
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            writeOffset += n;
+        }
+    };
+    transformFile(read, write, worker, decrypt, file);
+
+    int fd = out.fd;
+    out.fd = -1;
+    if (::close(fd) != 0)
+        throw systemError("запись", errno);
+}
+
+/**
+ * @brief Обрабатывает файл через FILE*
+ * @throw std::runtime_error при ошибке ввода-вывода
+ */
+void stdioFile(const BatchJob& job, Worker& worker, bool decrypt, FileResult& file)
+{
+    std::unique_ptr<FILE, int (*)(FILE*)> in(std::fopen(job.input.c_str(), "rb"), std::fclose);
+    if (!in)
+        throw systemError("открытие", errno);
+    std::unique_ptr<FILE, int (*)(FILE*)> out(std::fopen(job.output.c_str(), "wb"), std::fclose);
+    if (!out)
+        throw systemError(job.output, errno);
+
+    auto read = [&](char* data, size_t size) {
+        size_t n = std::fread(data, 1, size, in.get());
+        if (n == 0 && std::ferror(in.get()))
+            throw systemError("чтение", errno);
+        return n;
+    };
+    auto write = [&](const char* data, size_t size) {
+        if (std::fwrite(data, 1, size, out.get()) != size)
+            throw systemError("запись", errno);
+    };
+    transformFile(read, write, worker, decrypt, file);
+
+    if (std::fclose(out.release()) != 0)
+        throw systemError("запись", errno);
+}
+
+/**
+ * @brief Блокирующая подсистема: пул потоков (pread/pwrite) или один поток (stdio)
+ */
+void runBlocking(Batch& batch, const CipherFactory& factory, unsigned threads, bool stdio)
+{
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            try {
+                Worker worker;
+                worker.cipher = factory();
+                worker.buffer.resize(batch.options.bufferSize);
+                worker.output.reserve(batch.options.bufferSize);
+                while (const BatchJob* job = batch.take()) {
+                    FileResult file;
+                    try {
+                        if (stdio)
+                            stdioFile(*job, worker, batch.options.decrypt, file);
+                        else
+                            posixFile(*job, worker, batch.options.decrypt, file);
+                    } catch (const std::runtime_error& e) {
+                        file.failure = e.what();
+                    }
+                    batch.finish(*job, file);
+                }
+            } catch (...) {
+                batch.abort(std::current_exception());
+            }
+        });
+    }
+    for (auto& t : pool)
+        t.join();
+}
+
+#ifdef CIPHER_HAVE_URING
+
+/**
+ * @class UringWorker
+ * @brief Рабочий поток подсистемы io_uring
+ *
+ * Поток держит в обработке до options.depth файлов (слотов). Для каждого
+ * слота выполняется цепочка: связанные OPENAT входа и выхода, READ_FIXED блока
+ * в зарегистрированный буфер, шифрование целых строк блока в потоке,
+ * WRITE_FIXED результата из второго зарегистрированного буфера.
+ * Чтение следующего блока идёт одновременно с записью текущего.
+ * Последняя запись связана (IOSQE_IO_LINK) с закрытием выходного файла,
+ * поэтому завершение файла не требует отдельного прохода по кольцу.
+ */
+class UringWorker
+{
+private:
+    /// Вид операции в user_data
+    enum Op : uint64_t { OpenIn, OpenOut, Read, Write, CloseIn, CloseOut };
+
+    /**
+     * @struct Slot
+     * @brief Файл в обработке
+     */
+    struct Slot {
+        const BatchJob* job = nullptr;  ///< Файл (nullptr - слот свободен)
+        FileResult file;                ///< Итоги файла
+        int in = -1;                    ///< Входной дескриптор
+        int out = -1;                   ///< Выходной дескриптор
+        unsigned opening = 0;           ///< Незавершённых OPENAT
+        unsigned inCloses = 0;          ///< Незавершённых CLOSE входа
+        unsigned outCloses = 0;         ///< Незавершённых CLOSE выхода
+        bool reading = false;           ///< Идёт чтение
+        bool writing = false;           ///< Идёт запись
+        bool eof = false;               ///< Вход прочитан полностью
+        bool failed = false;            ///< Ошибка ввода-вывода
+        std::vector<char> buffer;       ///< Буфер чтения (зарегистрирован)
+        size_t filled = 0;              ///< Заполнено байт буфера
+        size_t requested = 0;           ///< Запрошено байт текущим чтением
+        uint64_t readOffset = 0;        ///< Смещение чтения
+        uint64_t writeOffset = 0;       ///< Смещение записи
+        std::string output;             ///< Результат блока (ёмкость зарегистрирована)
+        size_t outPos = 0;              ///< Записано байт из output
+        bool outputFixed = false;       ///< output лежит в зарегистрированном буфере
+    };
+
+    Batch& batch;                       ///< Пакет
+    IoUring ring;                       ///< Кольцо потока
+    std::unique_ptr<LineCipher> cipher; ///< Шифр потока
+    std::vector<Slot> slots;            ///< Слоты файлов
+    std::vector<iovec> buffers;         ///< Зарегистрированные буферы: 2 на слот
+    bool fixed = false;                 ///< Буферы зарегистрированы
+    unsigned active = 0;                ///< Занятых слотов
+
+    static uint64_t tag(unsigned slot, Op op) { return (static_cast<uint64_t>(slot) << 3) | op; }
+
+    /**
+     * @brief Занимает слот следующим файлом пакета
+     */
+    void start(unsigned i)
+    {
+        const BatchJob* job = batch.take();
+        if (!job)
+            return;
+        Slot& s = slots[i];
+        s.job = job;
+        s.file = FileResult();
+        s.in = s.out = -1;
+        s.opening = 2;
+        s.inCloses = s.outCloses = 0;
+        s.reading = s.writing = s.eof = s.failed = false;
+        s.filled = s.requested = 0;
+        s.readOffset = s.writeOffset = 0;
+        s.output.clear();
+        s.outPos = 0;
+        active++;
+
+        io_uring_sqe* e = ring.sqe();
+        e->opcode = IORING_OP_OPENAT;
+        e->fd = AT_FDCWD;
+        e->addr = reinterpret_cast<uintptr_t>(job->input.c_str());
+        e->open_flags = O_RDONLY | O_CLOEXEC;
+        e->user_data = tag(i, OpenIn);
+        // Выходной файл не создаётся, если входной не открылся
+        e->flags |= IOSQE_IO_LINK;
+
+        e = ring.sqe();
+        e->opcode = IORING_OP_OPENAT;
+        e->fd = AT_FDCWD;
+        e->addr = reinterpret_cast<uintptr_t>(job->output.c_str());
+        e->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        e->len = 0644;
+        e->user_data = tag(i, OpenOut);
+    }
+
+    void fail(Slot& s, const std::string& what, int code)
+    {
+        if (!s.failed)
+            s.file.failure = what + ": " + std::strerror(code);
+        s.failed = true;
+    }
+
+    void submitRead(unsigned i)
+    {
+        Slot& s = slots[i];
+        s.requested = s.buffer.size() - s.filled;
+        io_uring_sqe* e = ring.sqe();
+        e->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        if (fixed)
+            e->buf_index = static_cast<uint16_t>(2 * i);
+        e->fd = s.in;
+        e->addr = reinterpret_cast<uintptr_t>(s.buffer.data() + s.filled);
+        e->len = static_cast<uint32_t>(s.requested);
+        e->off = s.readOffset;
+        e->user_data = tag(i, Read);
+        s.reading = true;
+    }
+
+    void submitWrite(unsigned i)
+    {
+        Slot& s = slots[i];
+        // Зарегистрирована исходная ёмкость output; если строка выросла
+        // и переехала, буфер больше не используется как фиксированный
+        if (s.output.data() != buffers[2 * i + 1].iov_base)
+            s.outputFixed = false;
+        bool last = s.eof && s.filled == 0;
+
+        io_uring_sqe* e = ring.sqe();
+        e->opcode = s.outputFixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        if (s.outputFixed)
+            e->buf_index = static_cast<uint16_t>(2 * i + 1);
+        e->fd = s.out;
+        e->addr = reinterpret_cast<uintptr_t>(s.output.data() + s.outPos);
+        e->len = static_cast<uint32_t>(s.output.size() - s.outPos);
+        e->off = s.writeOffset;
+        e->user_data = tag(i, Write);
+        s.writing = true;
+
+        if (last) {
+            e->flags |= IOSQE_IO_LINK;
+            e = ring.sqe();
+            e->opcode = IORING_OP_CLOSE;
+            e->fd = s.out;
+            e->user_data = tag(i, CloseOut);
+            s.outCloses++;
+        }
+    }
+
+    void submitClose(unsigned i, bool output)
+    {
+        Slot& s = slots[i];
+        io_uring_sqe* e = ring.sqe();
+        e->opcode = IORING_OP_CLOSE;
+        e->fd = output ? s.out : s.in;
+        e->user_data = tag(i, output ? CloseOut : CloseIn);
+        (output ? s.outCloses : s.inCloses)++;
+    }
+
+    /**
+     * @brief Обрабатывает завершение операции
+     */
+    void complete(const io_uring_cqe& cqe)
+    {
+        unsigned i = static_cast<unsigned>(cqe.user_data >> 3);
+        Op op = static_cast<Op>(cqe.user_data & 7);
+        Slot& s = slots[i];
+        int res = cqe.res;
+
+        switch (op) {
+        case OpenIn:
+        case OpenOut:
+            s.opening--;
+            if (res == -ECANCELED)
+                s.failed = true;    // причина записана при ошибке открытия входа
+            else if (res < 0)
+                fail(s, op == OpenIn ? std::string("открытие") : s.job->output, -res);
+            else
+                (op == OpenIn ? s.in : s.out) = res;
+            break;
+        case Read:
+            s.reading = false;
+            if (res < 0) {
+                fail(s, "чтение", -res);
+            } else {
+                s.filled += static_cast<size_t>(res);
+                s.readOffset += static_cast<uint64_t>(res);
+                // Для обычного файла короткое чтение означает конец файла
+                s.eof = static_cast<size_t>(res) < s.requested;
+            }
+            break;
+        case Write:
+            s.writing = false;
+            if (res < 0) {
+                fail(s, "запись", -res);
+            } else {
+                s.outPos += static_cast<size_t>(res);
+                s.writeOffset += static_cast<uint64_t>(res);
+                s.file.bytesOut += static_cast<size_t>(res);
+            }
+            break;
+        case CloseIn:
+            s.inCloses--;
+            if (res != -ECANCELED)
+                s.in = -1;
+            break;
+        case CloseOut:
+            // Закрытие отменяется, если связанная запись завершилась
+            // ошибкой или записала не всё: тогда файл ещё открыт
+            s.outCloses--;
+            if (res != -ECANCELED) {
+                s.out = -1;
+                if (res < 0)
+                    fail(s, "запись", -res);
+            }
+            break;
+        }
+        advance(i);
+    }
+
+    /**
+     * @brief Выполняет следующий шаг обработки файла слота
+     */
+    void advance(unsigned i)
+    {
+        Slot& s = slots[i];
+        if (s.opening || s.reading || s.writing)
+            return;
+
+        if (!s.failed) {
+            if (s.outPos < s.output.size()) {
+                // Короткая запись: дописываем остаток
+                submitWrite(i);
+                return;
+            }
+            // Вход дочитан: закрываем его, не дожидаясь записи
+            if (s.eof && s.in >= 0 && s.inCloses == 0)
+                submitClose(i, false);
+            if (!(s.eof && s.filled == 0)) {
+                size_t take = completeLines(s.buffer.data(), s.filled, s.eof);
+                if (take == 0) {
+                    if (s.filled < s.buffer.size()) {
+                        submitRead(i);
+                        return;
+                    }
+                    s.failed = true;
+                    s.file.failure = "строка длиннее буфера";
+                } else {
+                    s.output.clear();
+                    s.outPos = 0;
+                    transformBlock(s.buffer.data(), take, *cipher, batch.options.decrypt, s.output, s.file);
+                    s.filled -= take;
+                    std::memmove(s.buffer.data(), s.buffer.data() + take, s.filled);
+                    if (!s.output.empty())
+                        submitWrite(i);
+                    if (!s.eof)
+                        submitRead(i);
+                    if (s.reading || s.writing)
+                        return;
+                }
+            }
+        }
+
+        // Файл обработан или завершился ошибкой: закрываем и освобождаем слот
+        if (s.in >= 0 && s.inCloses == 0)
+            submitClose(i, false);
+        if (s.out >= 0 && s.outCloses == 0)
+            submitClose(i, true);
+        if (s.inCloses || s.outCloses)
+            return;
+        batch.finish(*s.job, s.file);
+        s.job = nullptr;
+        active--;
+        start(i);
+    }
+
+public:
+    UringWorker(Batch& batch, const CipherFactory& factory) :
+        batch(batch), ring(batch.options.depth * 4), cipher(factory()), slots(batch.options.depth)
+    {
+        for (auto& s : slots) {
+            s.buffer.resize(batch.options.bufferSize);
+            s.output.reserve(2 * batch.options.bufferSize);
+            buffers.push_back(iovec{s.buffer.data(), s.buffer.size()});
+            buffers.push_back(iovec{&s.output[0], s.output.capacity()});
+        }
+        fixed = ring.registerBuffers(buffers.data(), static_cast<unsigned>(buffers.size()));
+        for (auto& s : slots)
+            s.outputFixed = fixed;
+    }
+
+    /**
+     * @brief Обрабатывает файлы, пока они не закончатся
+     */
+    void run()
+    {
+        for (unsigned i = 0; i < slots.size(); i++)
+            start(i);
+        io_uring_cqe cqe;
+        while (active > 0) {
+            ring.submit(1);
+            while (ring.next(cqe))
+                complete(cqe);
+        }
+    }
+};
+
+/**
+ * @brief Подсистема io_uring: по кольцу на рабочий поток
+ */
+void runUring(Batch& batch, const CipherFactory& factory, unsigned threads)
+{
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            try {
+                UringWorker worker(batch, factory);
+                worker.run();
+            } catch (...) {
+                batch.abort(std::current_exception());
+            }
+        });
+    }
+    for (auto& t : pool)
+        t.join();
+}
+
+#endif // CIPHER_HAVE_URING
+
+/**
+ * @brief Доступен ли io_uring
+ */
+bool uringAvailable()
+{
+#ifdef CIPHER_HAVE_URING
+    return IoUring::available();
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+/**
+ * @brief Имя подсистемы ввода-вывода
+ */
+const char* backendName(IoBackend backend)
+{
+    switch (backend) {
+    case IoBackend::Auto: return "auto";
+    case IoBackend::Uring: return "uring";
+    case IoBackend::Threads: return "threads";
+    case IoBackend::Stdio: return "stdio";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Разбирает имя подсистемы ввода-вывода
+ */
+bool parseBackend(const std::string& name, IoBackend& backend)
+{
+    for (IoBackend b : {IoBackend::Auto, IoBackend::Uring, IoBackend::Threads, IoBackend::Stdio}) {
+        if (name == backendName(b)) {
+            backend = b;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Шифрует или дешифрует список файлов
+ * @param jobs Пары входных и выходных файлов
+ * @param factory Фабрика шифров для рабочих потоков
+ * @param options Параметры
+ * @param log Поток для сообщений об ошибках файлов и строк
+ * @return Итоги работы
+ * @throw std::runtime_error если явно выбранный io_uring недоступен
+ */
+BatchStats runBatch(const std::vector<BatchJob>& jobs, const CipherFactory& factory,
+                    const BatchOptions& options, std::ostream& log)
+{
+    auto start = std::chrono::steady_clock::now();
+    BatchOptions effective = options;
+    effective.bufferSize = std::max<size_t>(options.bufferSize, 1);
+    effective.depth = std::max(1u, std::min(options.depth, 1024u));
+    if (effective.backend == IoBackend::Auto)
+        effective.backend = uringAvailable() ? IoBackend::Uring : IoBackend::Threads;
+    if (effective.backend == IoBackend::Uring && !uringAvailable())
+        throw std::runtime_error("io_uring недоступен в этом ядре");
+
+    unsigned threads = options.workers ? options.workers
+                                       : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(jobs.size(), 1)));
+
+    Batch batch(jobs, effective, log);
+    switch (effective.backend) {
+#ifdef CIPHER_HAVE_URING
+    case IoBackend::Uring:
+        runUring(batch, factory, threads);
+        break;
+#endif
+    case IoBackend::Stdio:
+        runBlocking(batch, factory, 1, true);
+        break;
+    default:
+        runBlocking(batch, factory, threads, false);
+        break;
+    }
+    batch.rethrow();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    batch.stats.backend = effective.backend;
+    batch.stats.seconds = elapsed.count();
+    return batch.stats;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file BoundedQueue.h
+ * @brief Ограниченная потокобезопасная очередь
+ *
+ * Используется для передачи блоков между стадиями конвейера.
+ * Ограничение ёмкости обеспечивает обратное давление: быстрая стадия
+ * блокируется, пока медленная не освободит место.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @class BoundedQueue
+ * @brief Очередь фиксированной ёмкости с блокирующими push/pop
+ * @tparam T Тип элементов
+ */
+template <class T>
+class BoundedQueue
+{
+private:
+    std::deque<T> items;                ///< Элементы очереди
+    size_t capacity;                    ///< Максимальное число элементов
+    bool closed = false;                ///< Очередь закрыта для записи
+    std::mutex lock;                    ///< Защита состояния
+    std::condition_variable notEmpty;   ///< Появился элемент или очередь закрыта
+    std::condition_variable notFull;    ///< Освободилось место
+
+public:
+    /**
+     * @brief Конструктор
+     * @param capacity Максимальное число элементов (не меньше 1)
+     */
+    explicit BoundedQueue(size_t capacity) : capacity(capacity ? capacity : 1) {}
+
+    /**
+     * @brief Добавляет элемент, ожидая свободного места
+     * @param item Элемент
+     * @return false, если очередь закрыта
+     */
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        notFull.wait(guard, [this] { return closed || items.size() < capacity; });
+        if (closed)
+            return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Добавляет элемент, если есть свободное место, не ожидая
+     * @param item Элемент (перемещается только при успехе)
+     * @return false, если очередь заполнена или закрыта
+     */
+    bool tryPush(T& item)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (closed || items.size() >= capacity)
+            return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Извлекает элемент, ожидая его появления
+     * @param item Извлечённый элемент
+     * @return false, если очередь закрыта и пуста
+     */
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        notEmpty.wait(guard, [this] { return closed || !items.empty(); });
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Закрывает очередь: новые элементы не принимаются,
+     *        оставшиеся можно извлечь
+     */
+    void close()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
@@ -0,0 +1,486 @@
+/**
+ * @file Container.cpp
+ * @brief Запись и чтение контейнера с таблицей блоков
+ */
+
+#include "Container.h"
+#include "BoundedQueue.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// Магическое число и версия формата
+const char MAGIC[8] = {'C', 'I', 'P', 'H', 'C', 'T', 'R', '1'};
+
+/// Размер записи таблицы блоков
+const size_t ENTRY_SIZE = 32;
+
+/// Флаги заголовка
+const uint8_t FLAG_PASSTHROUGH = 1;
+const uint8_t FLAG_PRESERVE_CASE = 2;
+
+/// Дописывает u32 в сетевом порядке байт
+void putU32(std::string& out, uint32_t v)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out += static_cast<char>(v >> shift);
+}
+
+/// Дописывает u64 в сетевом порядке байт
+void putU64(std::string& out, uint64_t v)
+{
+    for (int shift = 56; shift >= 0; shift -= 8)
+        out += static_cast<char>(v >> shift);
+}
+
+/// Читает u32 в сетевом порядке байт
+uint32_t getU32(const char* p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+        v = v << 8 | static_cast<unsigned char>(p[i]);
+    return v;
+}
+
+/// Читает u64 в сетевом порядке байт
+uint64_t getU64(const char* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = v << 8 | static_cast<unsigned char>(p[i]);
+    return v;
+}
+
+/// Дописывает строку с префиксом длины u8
+void putName(std::string& out, const std::string& name)
+{
+    if (name.size() > 255)
+        throw std::runtime_error("Слишком длинное имя в заголовке контейнера: " + name);
+    out += static_cast<char>(name.size());
+    out += name;
+}
+
+/**
+ * @brief Записывает буфер целиком по смещению
+ * @throw std::runtime_error при ошибке записи
+ */
+void pwriteAll(int fd, const char* data, size_t size, off_t offset)
+{
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, data, size, offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Ошибка записи: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+}
+
+/**
+ * @class Input
+ * @brief Весь вход: отображение обычного файла или прочитанный канал
+ */
+class Input
+{
+public:
+    /**
+     * @brief Отображает файл в память или читает канал до конца
+     * @throw std::runtime_error при ошибке чтения
+     */
+    explicit Input(int fd)
+    {
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                map = static_cast<const char*>(p);
+                size = static_cast<size_t>(st.st_size);
+                return;
+            }
+        }
+        const size_t step = 1 << 20;
+        for (;;) {
+            size_t old = buffer.size();
+            buffer.resize(old + step);
+            size_t n = readSome(fd, &buffer[old], step);
+            buffer.resize(old + n);
+            if (n == 0)
+                break;
+        }
+        size = buffer.size();
+    }
+
+    ~Input()
+    {
+        if (map)
+            ::munmap(const_cast<char*>(map), size);
+    }
+
+    Input(const Input&) = delete;
+    Input& operator=(const Input&) = delete;
+
+    /// Начало данных
+    const char* data() const { return map ? map : buffer.data(); }
+
+    size_t size = 0;                ///< Размер данных
+
+private:
+    const char* map = nullptr;      ///< Отображение файла
+    std::string buffer;             ///< Прочитанный канал
+};
+
+/**
+ * @struct ChunkJob
+ * @brief Блок контейнера в обработке
+ */
+struct ChunkJob {
+    size_t index = 0;               ///< Номер блока
+    std::string output;             ///< Расшифрованный блок
+    std::string error;              ///< Сообщение об ошибке
+    bool ok = false;                ///< Блок расшифрован
+    std::promise<void> done;        ///< Обработка завершена
+};
+
+typedef std::shared_ptr<ChunkJob> ChunkJobPtr;
+
+} // namespace
+
+/**
+ * @brief Шифрует поток в контейнер
+ * @param inFd Дескриптор входного файла или канала
+ * @param outFd Дескриптор выходного файла
+ * @param cipherOptions Параметры шифра для заголовка
+ * @param cipher Шифр
+ * @param options Параметры
+ * @param log Поток для сообщений об ошибках блоков
+ * @return Итоги работы
+ * @throw std::runtime_error при ошибке ввода-вывода или если вход и выход - один файл
+ *
+ * Границы блоков известны до шифрования, поэтому место под заголовок
+ * и таблицу резервируется, блоки пишутся по порядку, а таблица
+ * дописывается в начало файла последней.
+ */
+PipelineStats writeContainer(int inFd, int outFd, const CipherOptions& cipherOptions, LineCipher& cipher,
+                             const PipelineOptions& options, std::ostream& log)
+{
+    struct stat inStat, outStat;
+    if (::fstat(inFd, &inStat) == 0 && ::fstat(outFd, &outStat) == 0 && inStat.st_dev == outStat.st_dev
+        && inStat.st_ino == outStat.st_ino)
+        throw std::runtime_error("Контейнер нельзя записать во входной файл");
+
+    auto start = std::chrono::steady_clock::now();
+    const size_t chunkSize = std::max<size_t>(options.chunkSize, 1);
+    Input input(inFd);
+    const char* text = input.data();
+
+    // Границы блоков: не меньше chunkSize байт, до конца строки
+    std::vector<size_t> bounds{0};
+    while (bounds.back() < input.size) {
+        size_t end = std::min(bounds.back() + chunkSize, input.size);
+        const void* eol = std::memchr(text + end - 1, '\n', input.size - end + 1);
+        bounds.push_back(eol ? static_cast<const char*>(eol) - text + 1 : input.size);
+    }
+    const size_t count = bounds.size() - 1;
+    if (count > UINT32_MAX)
+        throw std::runtime_error("Слишком много блоков контейнера");
+
+    std::string header(MAGIC, sizeof(MAGIC));
+    putU32(header, static_cast<uint32_t>(count));
+    putU64(header, input.size);
+    header += static_cast<char>((cipherOptions.passthrough ? FLAG_PASSTHROUGH : 0)
+                                | (cipherOptions.preserveCase ? FLAG_PRESERVE_CASE : 0));
+    putName(header, cipherOptions.cipher);
+    putName(header, cipherOptions.encoding);
+    const uint64_t dataStart = header.size() + count * ENTRY_SIZE;
+    if (::lseek(outFd, static_cast<off_t>(dataStart), SEEK_SET) < 0)
+        throw std::runtime_error("Контейнер записывается только в файл");
+
+    PipelineStats stats;
+    std::vector<ContainerChunk> table(count);
+    std::string block, out, error;
+    uint64_t position = 0, offset = dataStart;
+    for (size_t i = 0; i < count; i++) {
+        block.assign(text + bounds[i], bounds[i + 1] - bounds[i]);
+        ContainerChunk& entry = table[i];
+        entry.sourceOffset = bounds[i];
+        if (!cipher.encryptBlock(block, position, out, entry.param, error)) {
+            log << "Блок " << i + 1 << ": " << error << "\n";
+            stats.errors++;
+            out.clear();
+        }
+        writeAll(outFd, out.data(), out.size());
+        entry.offset = offset;
+        entry.length = out.size();
+        offset += out.size();
+    }
+
+    for (const ContainerChunk& entry : table) {
+        putU64(header, entry.offset);
+        putU64(header, entry.length);
+        putU64(header, entry.sourceOffset);
+        putU64(header, entry.param);
+    }
+    pwriteAll(outFd, header.data(), header.size(), 0);
+
+    stats.bytesIn = input.size;
+    stats.bytesOut = offset;
+    stats.chunks = count;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    return stats;
+}
+
+/**
+ * @brief Отображает контейнер в память и разбирает таблицу
+ * @param path Путь к файлу
+ * @throw std::runtime_error если файл не открывается или повреждён
+ */
+ContainerReader::ContainerReader(const std::string& path)
+{
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error(path + ": " + std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        throw std::runtime_error(path + ": контейнер должен быть обычным файлом");
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error(path + ": " + std::strerror(errno));
+        }
+        data = static_cast<const char*>(p);
+    }
+    try {
+        parse(path);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+ContainerReader::~ContainerReader()
+{
+    release();
+}
+
+/**
+ * @brief Снимает отображение и закрывает файл
+ */
+void ContainerReader::release()
+{
+    if (data)
+        ::munmap(const_cast<char*>(data), size);
+    if (fd >= 0)
+        ::close(fd);
+    data = nullptr;
+    fd = -1;
+}
+
+/**
+ * @brief Разбирает заголовок и таблицу
+ * @throw std::runtime_error если контейнер повреждён
+ */
+void ContainerReader::parse(const std::string& path)
+{
+    const std::string damaged = path + ": повреждённый контейнер";
+    size_t at = 0;
+    auto need = [&](uint64_t bytes) {
+        if (bytes > size - at)
+            throw std::runtime_error(damaged);
+    };
+    auto name = [&] {
+        need(1);
+        size_t length = static_cast<unsigned char>(data[at++]);
+        need(length);
+        std::string s(data + at, length);
+        at += length;
+        return s;
+    };
+
+    need(sizeof(MAGIC) + 13);
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+        throw std::runtime_error(path + ": не контейнер шифра");
+    uint32_t count = getU32(data + 8);
+    source = getU64(data + 12);
+    uint8_t flags = static_cast<uint8_t>(data[20]);
+    at = 21;
+    header.passthrough = flags & FLAG_PASSTHROUGH;
+    header.preserveCase = flags & FLAG_PRESERVE_CASE;
+    header.cipher = name();
+    header.encoding = name();
+
+    need(static_cast<uint64_t>(count) * ENTRY_SIZE);
+    table.resize(count);
+    for (ContainerChunk& entry : table) {
+        entry.offset = getU64(data + at);
+        entry.length = getU64(data + at + 8);
+        entry.sourceOffset = getU64(data + at + 16);
+        entry.param = getU64(data + at + 24);
+        at += ENTRY_SIZE;
+        if (entry.offset > size || entry.length > size - entry.offset || entry.sourceOffset > source)
+            throw std::runtime_error(damaged);
+    }
+    // Блоки покрывают открытый текст с нуля: иначе для начала текста нет блока
+    if (table.empty() ? source != 0 : table[0].sourceOffset != 0)
+        throw std::runtime_error(damaged);
+    for (size_t i = 1; i < table.size(); i++)
+        if (table[i].sourceOffset < table[i - 1].sourceOffset)
+            throw std::runtime_error(damaged);
+}
+
+/**
+ * @brief Номер блока, содержащего байт открытого текста
+ * @param sourceOffset Смещение в открытом тексте
+ * @return Номер блока или chunks()
+ */
+size_t ContainerReader::findChunk(uint64_t sourceOffset) const
+{
+    if (sourceOffset >= source)
+        return table.size();
+    auto after = std::upper_bound(table.begin(), table.end(), sourceOffset,
+                                  [](uint64_t value, const ContainerChunk& e) { return value < e.sourceOffset; });
+    if (after == table.begin())
+        return table.size();
+    return static_cast<size_t>(after - table.begin()) - 1;
+}
+
+/**
+ * @brief Дешифрует один блок
+ * @param index Номер блока
+ * @param cipher Шифр
+ * @param out Расшифрованный блок
+ * @param error Сообщение об ошибке
+ * @return false при ошибке
+ */
+bool ContainerReader::decryptChunk(size_t index, LineCipher& cipher, std::string& out, std::string& error) const
+{
+    const ContainerChunk& entry = table[index];
+    std::string block(data + entry.offset, entry.length);
+    return cipher.decryptBlock(block, entry.param, out, error);
+}
+
+/**
+ * @brief Дешифрует блоки контейнера параллельно
+ * @param reader Контейнер
+ * @param first Первый блок
+ * @param count Число блоков
+ * @param outFd Дескриптор выходного файла или канала
+ * @param factory Фабрика шифров для рабочих потоков
+ * @param options Параметры
+ * @param log Поток для сообщений об ошибках блоков
+ * @return Итоги работы
+ * @throw std::runtime_error при ошибке ввода-вывода
+ *
+ * Схема та же, что в runPipeline, но чтения нет: блоки уже в памяти,
+ * поэтому очереди несут только номера блоков.
+ */
+PipelineStats readContainer(const ContainerReader& reader, size_t first, size_t count, int outFd,
+                            const CipherFactory& factory, const PipelineOptions& options, std::ostream& log)
+{
+    auto start = std::chrono::steady_clock::now();
+    const unsigned workers = options.workers ? options.workers
+                                             : std::max(1u, std::thread::hardware_concurrency());
+    const size_t depth = options.queueDepth ? options.queueDepth : 2 * workers;
+    first = std::min(first, reader.chunks());
+    const size_t last = first + std::min(count, reader.chunks() - first);
+
+    BoundedQueue<ChunkJobPtr> work(depth);
+    BoundedQueue<ChunkJobPtr> ordered(depth);
+    PipelineStats stats;
+    std::exception_ptr failure;
+    std::mutex failureLock;
+    auto fail = [&](std::exception_ptr e) {
+        std::lock_guard<std::mutex> guard(failureLock);
+        if (!failure) failure = e;
+        work.close();
+        ordered.close();
+    };
+
+    std::thread feeder([&] {
+        for (size_t i = first; i < last; i++) {
+            ChunkJobPtr job = std::make_shared<ChunkJob>();
+            job->index = i;
+            if (!ordered.push(job))
+                break;
+            if (!work.push(job)) {
+                job->done.set_value();
+                break;
+            }
+        }
+        work.close();
+        ordered.close();
+    });
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; w++) {
+        pool.emplace_back([&] {
+            std::unique_ptr<LineCipher> cipher;
+            try {
+                cipher = factory();
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            ChunkJobPtr job;
+            while (work.pop(job)) {
+                try {
+                    if (cipher)
+                        job->ok = reader.decryptChunk(job->index, *cipher, job->output, job->error);
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+                job->done.set_value();
+            }
+        });
+    }
+
+    std::thread writer([&] {
+        try {
+            ChunkJobPtr job;
+            while (ordered.pop(job)) {
+                job->done.get_future().wait();
+                if (!job->ok) {
+                    log << "Блок " << job->index + 1 << ": " << job->error << "\n";
+                    job->output.clear();
+                    stats.errors++;
+                }
+                writeAll(outFd, job->output.data(), job->output.size());
+                stats.bytesIn += reader.chunk(job->index).length;
+                stats.bytesOut += job->output.size();
+                stats.chunks++;
+                job.reset();
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+
+    feeder.join();
+    for (auto& t : pool) t.join();
+    writer.join();
+
+    if (failure)
+        std::rethrow_exception(failure);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    return stats;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file Container.h
+ * @brief Контейнер с таблицей блоков для произвольного доступа и параллельного дешифрования
+ *
+ * Вход делится на блоки по границе строки (не меньше chunkSize байт),
+ * каждый блок шифруется как часть одного потока (LineCipher::encryptBlock),
+ * а таблица в начале файла хранит для каждого блока смещение, длину,
+ * смещение в открытом тексте и параметр шифра. Поэтому читатель
+ * отображает файл в память (mmap) и дешифрует любой блок независимо,
+ * а все блоки - параллельно.
+ *
+ * Формат (все числа - в сетевом порядке байт):
+ * ```
+ * "CIPHCTR1"                       магическое число и версия, 8 байт
+ * u32 N                            число блоков
+ * u64 длина открытого текста
+ * u8  флаги                        1 - Passthrough, 2 - сохранение регистра
+ * u8  длина, имя шифра             alpha, route, ...
+ * u8  длина, имя кодировки         utf8, cp1251, koi8r
+ * N x {u64 смещение блока в файле, u64 длина блока,
+ *      u64 смещение в открытом тексте, u64 параметр блока}
+ * данные блоков
+ * ```
+ * Параметр блока: для alpha - число букв потока перед блоком (позиция
+ * в ключе), для route - длина таблицы блока. Ключ в контейнер не
+ * записывается.
+ */
+
+#pragma once
+#include "LineCipher.h"
+#include "Pipeline.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ContainerChunk
+ * @brief Запись таблицы блоков
+ */
+struct ContainerChunk {
+    uint64_t offset = 0;        ///< Смещение данных блока от начала файла
+    uint64_t length = 0;        ///< Длина данных блока, байт
+    uint64_t sourceOffset = 0;  ///< Смещение блока в открытом тексте
+    uint64_t param = 0;         ///< Параметр шифра (LineCipher::decryptBlock)
+};
+
+/**
+ * @brief Шифрует поток в контейнер
+ * @param inFd Дескриптор входного файла или канала
+ * @param outFd Дескриптор выходного файла (должен поддерживать lseek)
+ * @param cipherOptions Параметры шифра (записываются в заголовок без ключа)
+ * @param cipher Шифр
+ * @param options Параметры: chunkSize - минимальный размер блока
+ * @param log Поток для сообщений об ошибках блоков
+ * @return Итоги работы (chunks - число блоков, errors - блоков с ошибкой)
+ * @throw std::runtime_error при ошибке ввода-вывода или если inFd и outFd - один файл
+ *
+ * Блоки шифруются по порядку: позиция потока блока зависит от всех
+ * предыдущих. Блок с ошибкой записывается пустым.
+ */
+PipelineStats writeContainer(int inFd, int outFd, const CipherOptions& cipherOptions, LineCipher& cipher,
+                             const PipelineOptions& options, std::ostream& log);
+
+/**
+ * @class ContainerReader
+ * @brief Контейнер, отображённый в память
+ *
+ * После конструктора заголовок и таблица проверены: все блоки лежат
+ * внутри файла. Методы const и потокобезопасны.
+ */
+class ContainerReader
+{
+public:
+    /**
+     * @brief Отображает контейнер в память и разбирает таблицу
+     * @param path Путь к файлу
+     * @throw std::runtime_error если файл не открывается или повреждён
+     */
+    explicit ContainerReader(const std::string& path);
+
+    ~ContainerReader();
+
+    ContainerReader(const ContainerReader&) = delete;
+    ContainerReader& operator=(const ContainerReader&) = delete;
+
+    /**
+     * @brief Параметры шифра из заголовка (ключ пуст)
+     */
+    const CipherOptions& cipherOptions() const { return header; }
+
+    /// Длина открытого текста, байт
+    uint64_t sourceSize() const { return source; }
+
+    /// Число блоков
+    size_t chunks() const { return table.size(); }
+
+    /// Запись таблицы блока index
+    const ContainerChunk& chunk(size_t index) const { return table[index]; }
+
+    /**
+     * @brief Номер блока, содержащего байт открытого текста
+     * @param sourceOffset Смещение в открытом тексте
+     * @return Номер блока или chunks(), если смещение за концом текста
+     */
+    size_t findChunk(uint64_t sourceOffset) const;
+
+    /**
+     * @brief Дешифрует один блок
+     * @param index Номер блока
+     * @param cipher Шифр с ключом контейнера
+     * @param out Расшифрованный блок
+     * @param error Сообщение об ошибке
+     * @return false при ошибке
+     */
+    bool decryptChunk(size_t index, LineCipher& cipher, std::string& out, std::string& error) const;
+
+private:
+    int fd = -1;                        ///< Дескриптор файла
+    const char* data = nullptr;         ///< Отображение файла
+    size_t size = 0;                    ///< Размер файла
+    CipherOptions header;               ///< Параметры шифра из заголовка
+    uint64_t source = 0;                ///< Длина открытого текста
+    std::vector<ContainerChunk> table;  ///< Таблица блоков
+
+    /**
+     * @brief Разбирает заголовок и таблицу
+     * @throw std::runtime_error если контейнер повреждён
+     */
+    void parse(const std::string& path);
+
+    /// Снимает отображение и закрывает файл
+    void release();
+};
+
+/**
+ * @brief Дешифрует блоки контейнера параллельно
+ * @param reader Контейнер
+ * @param first Первый блок
+ * @param count Число блоков (обрезается по концу таблицы)
+ * @param outFd Дескриптор выходного файла или канала
+ * @param factory Фабрика шифров для рабочих потоков
+ * @param options Параметры: workers, queueDepth
+ * @param log Поток для сообщений об ошибках блоков
+ * @return Итоги работы
+ * @throw std::runtime_error при ошибке ввода-вывода
+ *
+ * Блоки дешифруются пулом потоков и выводятся в исходном порядке;
+ * блок с ошибкой выводится пустым.
+ */
+PipelineStats readContainer(const ContainerReader& reader, size_t first, size_t count, int outFd,
+                            const CipherFactory& factory, const PipelineOptions& options, std::ostream& log);
@@ -0,0 +1,480 @@
+/**
+ * @file Daemon.cpp
+ * @brief Реализация демона шифрования на Unix-сокете
+ */
+
+#include "Daemon.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/// id событий epoll: слушающий сокет
+const uint64_t LISTEN_ID = 0;
+
+/// id событий epoll: eventfd
+const uint64_t WAKE_ID = 1;
+
+/// Размер буфера чтения из сокета
+const size_t READ_SIZE = 64 * 1024;
+
+/**
+ * @brief Исключение с текстом системной ошибки
+ */
+std::runtime_error systemError(const std::string& what)
+{
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+/**
+ * @brief Создаёт сокет и запускает рабочие потоки
+ * @param keys Хранилище ключей
+ * @param options Параметры демона
+ * @throw std::runtime_error при ошибке создания сокета
+ */
+CipherDaemon::CipherDaemon(KeyStore& keys, const DaemonOptions& options) :
+    keys(keys), options(options), stopping(false), reloadRequested(false), reloadDone(false), tasks(options.queueDepth)
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Недопустимый путь к сокету: " + options.socketPath);
+    std::strcpy(addr.sun_path, options.socketPath.c_str());
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+        throw systemError("socket");
+    ::unlink(options.socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listenFd, SOMAXCONN) < 0) {
+        std::runtime_error e = systemError(options.socketPath);
+        ::close(listenFd);
+        throw e;
+    }
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0)
+        throw systemError("epoll");
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = LISTEN_ID;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.u64 = WAKE_ID;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    unsigned count = options.workers ? options.workers
+                                     : std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < count; i++)
+        workers.emplace_back(&CipherDaemon::workerLoop, this);
+}
+
+/**
+ * @brief Останавливает потоки, закрывает и удаляет сокет
+ */
+CipherDaemon::~CipherDaemon()
+{
+    tasks.close();
+    for (auto& t : workers)
+        t.join();
+    if (reloader.joinable())
+        reloader.join();
+    for (auto& c : connections)
+        ::close(c.second.fd);
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(options.socketPath.c_str());
+    }
+    if (epollFd >= 0) ::close(epollFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+}
+
+/**
+ * @brief Запрашивает остановку (безопасно для обработчика сигнала)
+ */
+void CipherDaemon::stop()
+{
+    stopping.store(true);
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+/**
+ * @brief Запрашивает перезагрузку ключей (безопасно для обработчика сигнала)
+ */
+void CipherDaemon::reloadKeys()
+{
+    reloadRequested.store(true);
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+/**
+ * @brief Запускает перезагрузку ключей в отдельном потоке
+ *
+ * KeyStore::reload() подменяет версию атомарно, поэтому рабочие потоки
+ * продолжают искать ключи во время чтения файла. Итог возвращается
+ * в цикл событий через reloadMessage и eventfd.
+ */
+void CipherDaemon::startReload()
+{
+    reloader = std::thread([this] {
+        std::string message;
+        try {
+            if (keys.reload())
+                message = "Ключи перезагружены: " + std::to_string(keys.size());
+        } catch (const std::exception& e) {
+            message = std::string("[ОШИБКА] Перезагрузка ключей: ") + e.what();
+        }
+        {
+            std::lock_guard<std::mutex> guard(doneLock);
+            reloadMessage = message;
+        }
+        reloadDone.store(true);
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    });
+}
+
+/**
+ * @brief Дожидается потока перезагрузки и выводит её итог
+ */
+void CipherDaemon::finishReload()
+{
+    reloader.join();
+    std::string message;
+    {
+        std::lock_guard<std::mutex> guard(doneLock);
+        message.swap(reloadMessage);
+    }
+    if (!message.empty())
+        std::cerr << message << std::endl;
+}
+
+/**
+ * @brief Цикл обработки событий до вызова stop()
+ */
+void CipherDaemon::run()
+{
+    epoll_event events[64];
+    while (!stopping.load()) {
+        int n = ::epoll_wait(epollFd, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw systemError("epoll_wait");
+        }
+        for (int i = 0; i < n; i++) {
+            uint64_t id = events[i].data.u64;
+            if (id == LISTEN_ID) {
+                acceptClients();
+            } else if (id == WAKE_ID) {
+                uint64_t value;
+                while (::read(wakeFd, &value, sizeof(value)) > 0) {}
+                if (reloadDone.exchange(false))
+                    finishReload();
+                // Запрос, пришедший во время перезагрузки, ждёт её окончания
+                if (!reloader.joinable() && reloadRequested.exchange(false))
+                    startReload();
+                deliverResponses();
+                resumeStalled();
+            } else if (connections.count(id)) {
+                if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)) {
+                    closeClient(id);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN)
+                    readClient(id);
+                if (connections.count(id) && (events[i].events & EPOLLOUT))
+                    flushClient(id);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Принимает все ожидающие соединения
+ */
+void CipherDaemon::acceptClients()
+{
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+        uint64_t id = nextConnection++;
+        Connection& c = connections[id];
+        c.fd = fd;
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = id;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+/**
+ * @brief Читает данные клиента и передаёт полные кадры в пул
+ * @param id Идентификатор соединения
+ */
+void CipherDaemon::readClient(uint64_t id)
+{
+    Connection& c = connections[id];
+    char buffer[READ_SIZE];
+    for (;;) {
+        ssize_t n = ::read(c.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            c.in.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            c.readClosed = true;
+            break;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeClient(id);
+            return;
+        }
+        break;
+    }
+
+    if (dispatchRequests(id, c))
+        watch(id, c);
+}
+
+/**
+ * @brief Передаёт в пул разобранные кадры соединения
+ * @param id Идентификатор соединения
+ * @param c Состояние соединения
+ * @return false, если соединение закрыто из-за неверного кадра
+ *
+ * Очередь пула не ожидается: запрос, не поместившийся в неё, остаётся
+ * в c.blocked, соединение попадает в stalled, и разбор продолжится
+ * в resumeStalled().
+ */
+bool CipherDaemon::dispatchRequests(uint64_t id, Connection& c)
+{
+    if (c.blocked) {
+        if (!tasks.tryPush(*c.blocked)) {
+            stalled.push_back(id);
+            return true;
+        }
+        c.blocked.reset();
+        c.inFlight++;
+    }
+
+    size_t pos = 0, frame = 0;
+    int state;
+    while ((state = protocol::frameLength(c.in.data() + pos, c.in.size() - pos, frame)) == 1) {
+        Task task;
+        task.connection = id;
+        if (!protocol::decodeRequest(c.in.data() + pos + 4, frame - 4, task.request)) {
+            closeClient(id);
+            return false;
+        }
+        pos += frame;
+        if (!tasks.tryPush(task)) {
+            c.blocked = std::move(task);
+            stalled.push_back(id);
+            break;
+        }
+        c.inFlight++;
+    }
+    c.in.erase(0, pos);
+    if (state < 0) {
+        closeClient(id);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Продолжает разбор соединений, ожидавших места в очереди пула
+ */
+void CipherDaemon::resumeStalled()
+{
+    std::vector<uint64_t> waiting;
+    waiting.swap(stalled);
+    for (uint64_t id : waiting) {
+        auto it = connections.find(id);
+        if (it != connections.end() && dispatchRequests(id, it->second))
+            watch(id, it->second);
+    }
+}
+
+/**
+ * @brief Отправляет накопленные ответы клиенту
+ * @param id Идентификатор соединения
+ */
+void CipherDaemon::flushClient(uint64_t id)
+{
+    Connection& c = connections[id];
+    while (c.outPos < c.out.size()) {
+        ssize_t n = ::write(c.fd, c.out.data() + c.outPos, c.out.size() - c.outPos);
+        if (n > 0) {
+            c.outPos += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        closeClient(id);
+        return;
+    }
+    if (c.outPos == c.out.size()) {
+        c.out.clear();
+        c.outPos = 0;
+    }
+    watch(id, c);
+}
+
+/**
+ * @brief Переносит готовые ответы пула в буферы соединений
+ */
+void CipherDaemon::deliverResponses()
+{
+    std::vector<std::pair<uint64_t, std::string>> ready;
+    {
+        std::lock_guard<std::mutex> guard(doneLock);
+        ready.swap(done);
+    }
+    std::vector<uint64_t> touched;
+    for (auto& r : ready) {
+        auto it = connections.find(r.first);
+        if (it == connections.end())
+            continue;   // соединение уже закрыто
+        it->second.out += r.second;
+        it->second.inFlight--;
+        touched.push_back(r.first);
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (auto id : touched)
+        if (connections.count(id))
+            flushClient(id);
+}
+
+/**
+ * @brief Обновляет подписку epoll и закрывает завершённое соединение
+ * @param id Идентификатор соединения
+ * @param c Состояние соединения
+ *
+ * Соединение, закрытое клиентом, закрывается после отправки
+ * всех ответов на принятые запросы. Пока запрос ждёт места в очереди
+ * пула (c.blocked), EPOLLIN снят.
+ */
+void CipherDaemon::watch(uint64_t id, Connection& c)
+{
+    bool pending = c.outPos < c.out.size();
+    if (c.readClosed && !pending && c.inFlight == 0 && !c.blocked) {
+        closeClient(id);
+        return;
+    }
+    // Пока запрос ждёт места в очереди пула, новые данные не читаются
+    bool reading = !c.readClosed && !c.blocked;
+    if (pending != c.writing || reading != c.reading) {
+        epoll_event ev;
+        ev.events = (reading ? uint32_t(EPOLLIN) : 0u) | (pending ? uint32_t(EPOLLOUT) : 0u);
+        ev.data.u64 = id;
+        ::epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+        c.writing = pending;
+        c.reading = reading;
+    }
+}
+
+/**
+ * @brief Закрывает соединение
+ * @param id Идентификатор соединения
+ */
+void CipherDaemon::closeClient(uint64_t id)
+{
+    auto it = connections.find(id);
+    if (it == connections.end())
+        return;
+    ::close(it->second.fd);
+    connections.erase(it);
+}
+
+/**
+ * @brief Цикл рабочего потока
+ *
+ * Шифры создаются по id ключа при первом запросе и используются
+ * только этим потоком; после перезагрузки ключей кэш сбрасывается.
+ */
+void CipherDaemon::workerLoop()
+{
+    std::unordered_map<uint32_t, std::unique_ptr<LineCipher>> ciphers;
+    uint64_t generation = keys.generation();
+    TenantCipher tenant;
+    Task task;
+    std::string frame;
+    while (tasks.pop(task)) {
+        const protocol::Request& request = task.request;
+        protocol::Response response;
+        response.id = request.id;
+
+        uint64_t latest = keys.generation();
+        if (latest != generation) {
+            generation = latest;
+            ciphers.clear();
+        }
+        auto it = ciphers.find(request.keyId);
+        std::string lookupError;
+        if (it == ciphers.end()) {
+            try {
+                if (keys.lookup(request.keyId, tenant))
+                    it = ciphers.emplace(request.keyId, makeLineCipher(tenant)).first;
+            } catch (const std::exception& e) {
+                lookupError = e.what();
+            }
+        }
+
+        if (!lookupError.empty()) {
+            response.status = protocol::Status::CipherError;
+            response.text = lookupError;
+        } else if (it == ciphers.end()) {
+            response.status = protocol::Status::UnknownKey;
+            response.text = "Unknown key id";
+        } else if (request.op != protocol::Op::Encrypt && request.op != protocol::Op::Decrypt) {
+            response.status = protocol::Status::BadRequest;
+            response.text = "Unknown operation";
+        } else {
+            std::string error;
+            bool ok = request.op == protocol::Op::Encrypt
+                    ? it->second->encrypt(request.text, response.text, error)
+                    : it->second->decrypt(request.text, response.text, error);
+            if (!ok) {
+                response.status = protocol::Status::CipherError;
+                response.text = error;
+            }
+        }
+
+        frame.clear();
+        protocol::encodeResponse(frame, response);
+        {
+            std::lock_guard<std::mutex> guard(doneLock);
+            done.emplace_back(task.connection, frame);
+        }
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file Daemon.h
+ * @brief Локальный демон шифрования на Unix-сокете
+ *
+ * Один поток обслуживает все соединения через неблокирующий цикл epoll,
+ * а запросы шифрования выполняет пул рабочих потоков. Готовые ответы
+ * возвращаются в цикл событий через eventfd.
+ *
+ * Цикл событий никогда не ждёт очередь пула: если она заполнена,
+ * разобранный запрос остаётся в соединении, чтение из него
+ * приостанавливается, а остальные клиенты обслуживаются как обычно.
+ * Когда рабочие потоки возвращают ответы (и освобождают место),
+ * приостановленные соединения продолжают разбор.
+ */
+
+#pragma once
+#include "BoundedQueue.h"
+#include "KeyStore.h"
+#include "Protocol.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct DaemonOptions
+ * @brief Параметры демона
+ */
+struct DaemonOptions {
+    std::string socketPath;     ///< Путь к Unix-сокету
+    unsigned workers = 0;       ///< Число рабочих потоков (0 - по числу ядер)
+    size_t queueDepth = 4096;   ///< Максимум запросов в очереди к пулу
+};
+
+/**
+ * @class CipherDaemon
+ * @brief Сервер шифрования по двоичному протоколу (см. Protocol.h)
+ *
+ * Экземпляры шифров создаются по id ключа при первом обращении
+ * и хранятся в каждом рабочем потоке до перезагрузки ключей
+ * (reloadKeys) или остановки демона.
+ */
+class CipherDaemon
+{
+private:
+    /**
+     * @struct Task
+     * @brief Запрос для рабочего потока
+     */
+    struct Task {
+        uint64_t connection;        ///< Идентификатор соединения
+        protocol::Request request;  ///< Запрос
+    };
+
+    /**
+     * @struct Connection
+     * @brief Состояние клиентского соединения
+     */
+    struct Connection {
+        int fd = -1;                ///< Сокет клиента
+        std::string in;             ///< Принятые, ещё не разобранные байты
+        std::string out;            ///< Ответы, ожидающие отправки
+        size_t outPos = 0;          ///< Отправлено байт из out
+        size_t inFlight = 0;        ///< Запросов в обработке
+        std::optional<Task> blocked; ///< Разобранный запрос, не поместившийся в очередь пула
+        bool readClosed = false;    ///< Клиент закрыл свою сторону
+        bool reading = true;        ///< Подписка на EPOLLIN
+        bool writing = false;       ///< Подписка на EPOLLOUT
+    };
+
+    KeyStore& keys;                                     ///< Хранилище ключей
+    DaemonOptions options;                              ///< Параметры
+    int listenFd = -1;                                  ///< Слушающий сокет
+    int epollFd = -1;                                   ///< Дескриптор epoll
+    int wakeFd = -1;                                    ///< eventfd: готовые ответы и остановка
+    std::atomic<bool> stopping;                         ///< Запрошена остановка
+    std::atomic<bool> reloadRequested;                  ///< Запрошена перезагрузка ключей
+    std::atomic<bool> reloadDone;                       ///< Поток перезагрузки завершил работу
+    std::thread reloader;                               ///< Поток перезагрузки ключей
+    std::string reloadMessage;                          ///< Итог перезагрузки для журнала (под doneLock)
+    uint64_t nextConnection = 2;                        ///< Следующий id соединения (0, 1 заняты)
+    std::unordered_map<uint64_t, Connection> connections; ///< Открытые соединения
+
+    BoundedQueue<Task> tasks;                           ///< Очередь запросов к пулу
+    std::mutex doneLock;                                ///< Защита done
+    std::vector<std::pair<uint64_t, std::string>> done; ///< Готовые кадры ответов
+    std::vector<std::thread> workers;                   ///< Рабочие потоки
+    std::vector<uint64_t> stalled;                      ///< Соединения с запросом, ждущим места в очереди
+
+    void workerLoop();
+    void acceptClients();
+    void readClient(uint64_t id);
+    bool dispatchRequests(uint64_t id, Connection& c);
+    void resumeStalled();
+    void startReload();
+    void finishReload();
+    void flushClient(uint64_t id);
+    void deliverResponses();
+    void closeClient(uint64_t id);
+    void watch(uint64_t id, Connection& c);
+
+public:
+    /**
+     * @brief Создаёт сокет и запускает рабочие потоки
+     * @param keys Хранилище ключей (должно жить дольше демона)
+     * @param options Параметры демона
+     * @throw std::runtime_error при ошибке создания сокета
+     */
+    CipherDaemon(KeyStore& keys, const DaemonOptions& options);
+
+    /// Останавливает потоки, закрывает и удаляет сокет
+    ~CipherDaemon();
+
+    CipherDaemon(const CipherDaemon&) = delete;
+    CipherDaemon& operator=(const CipherDaemon&) = delete;
+
+    /**
+     * @brief Цикл обработки событий до вызова stop()
+     */
+    void run();
+
+    /**
+     * @brief Запрашивает остановку
+     *
+     * Безопасна для вызова из обработчика сигнала.
+     */
+    void stop();
+
+    /**
+     * @brief Запрашивает перезагрузку файла ключей
+     *
+     * Безопасна для вызова из обработчика сигнала: цикл событий
+     * запускает чтение файла в отдельном потоке (текстовый файл
+     * разбирается за линейное время) и продолжает обслуживать клиентов.
+     * Итог выводится в std::cerr; при ошибке прежние ключи остаются
+     * в силе.
+     */
+    void reloadKeys();
+};
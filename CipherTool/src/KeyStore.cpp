@@ -0,0 +1,440 @@
+/**
+ * @file KeyStore.cpp
+ * @brief Сборка, отображение и поиск в хранилище ключей арендаторов
+ */
+
+#include "KeyStore.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <codecvt>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// Магическое число и версия формата
+const char MAGIC[8] = {'C', 'I', 'P', 'H', 'K', 'E', 'Y', '1'};
+
+/// Размер заголовка
+const size_t HEADER_SIZE = 16;
+
+/// Размер ячейки таблицы
+const size_t SLOT_SIZE = 12;
+
+/// Шифр ячейки
+const uint8_t SLOT_EMPTY = 0;
+const uint8_t SLOT_ALPHA = 1;
+const uint8_t SLOT_ROUTE = 2;
+
+/// Флаги ячейки
+const uint8_t FLAG_PASSTHROUGH = 1;
+const uint8_t FLAG_PRESERVE_CASE = 2;
+
+/// Дописывает u16 в сетевом порядке байт
+void putU16(std::string& out, uint16_t v)
+{
+    out += static_cast<char>(v >> 8);
+    out += static_cast<char>(v);
+}
+
+/// Дописывает u32 в сетевом порядке байт
+void putU32(std::string& out, uint32_t v)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out += static_cast<char>(v >> shift);
+}
+
+/// Читает u16 в сетевом порядке байт
+uint16_t getU16(const char* p)
+{
+    return static_cast<uint16_t>(static_cast<unsigned char>(p[0]) << 8 | static_cast<unsigned char>(p[1]));
+}
+
+/// Читает u32 в сетевом порядке байт
+uint32_t getU32(const char* p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+        v = v << 8 | static_cast<unsigned char>(p[i]);
+    return v;
+}
+
+/**
+ * @brief Первая ячейка для id в таблице из 2^bits ячеек
+ *
+ * Мультипликативный хеш: старшие биты произведения перемешивают и
+ * подряд идущие id.
+ */
+size_t firstSlot(uint32_t id, unsigned bits)
+{
+    return bits == 0 ? 0 : (id * 0x9E3779B1u) >> (32 - bits);
+}
+
+/**
+ * @brief Исключение с текстом системной ошибки
+ */
+std::runtime_error systemError(const std::string& what)
+{
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+/**
+ * @brief Индексы букв ключа alpha
+ * @throw std::runtime_error если ключ невалиден
+ */
+std::vector<uint8_t> alphaIndices(const std::string& key)
+{
+    std::wstring letters;
+    try {
+        letters = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(key);
+    } catch (const std::range_error&) {
+        throw std::runtime_error("Invalid key");
+    }
+    std::vector<uint8_t> indices(letters.size());
+    alpha_core::KeyError error = alpha_core::keyIndices(letters.data(), letters.size(), indices.data());
+    if (error != alpha_core::KeyError::None)
+        throw std::runtime_error(alpha_core::keyErrorMessage(error));
+    if (indices.size() > UINT16_MAX)
+        throw std::runtime_error("Ключ длиннее 65535 букв");
+    return indices;
+}
+
+/**
+ * @brief Число столбцов ключа route
+ * @throw std::runtime_error если ключ не является положительным числом
+ */
+uint32_t routeColumns(const std::string& key)
+{
+    errno = 0;
+    char* end = nullptr;
+    long value = std::strtol(key.c_str(), &end, 10);
+    if (key.empty() || *end != '\0' || errno == ERANGE || value <= 0 || value > INT_MAX)
+        throw std::runtime_error("Ключ должен быть положительным целым числом");
+    return static_cast<uint32_t>(value);
+}
+
+} // namespace
+
+/**
+ * @struct KeyStore::Image
+ * @brief Одна версия файла: отображение или образ, собранный в памяти
+ */
+struct KeyStore::Image {
+    const char* data = nullptr;     ///< Начало образа
+    size_t size = 0;                ///< Размер образа
+    void* mapping = nullptr;        ///< Отображение файла (nullptr для образа в памяти)
+    std::string built;              ///< Образ, собранный из текстового файла ключей
+    uint32_t count = 0;             ///< Число ключей
+    uint32_t slots = 0;             ///< Число ячеек
+    unsigned bits = 0;              ///< log2(slots)
+    struct stat identity;           ///< Файл, из которого загружена версия
+
+    Image() { std::memset(&identity, 0, sizeof(identity)); }
+    ~Image()
+    {
+        if (mapping)
+            ::munmap(mapping, size);
+    }
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+};
+
+namespace {
+
+/**
+ * @brief Тот же ли файл (путь не заменялся и не изменялся)
+ */
+bool sameFile(const struct stat& a, const struct stat& b)
+{
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino && a.st_size == b.st_size
+           && a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+} // namespace
+
+/**
+ * @brief Собирает образ хранилища из таблицы ключей
+ * @param keys Таблица ключей
+ * @return Содержимое файла хранилища
+ * @throw std::runtime_error если шифр не поддерживается или ключ невалиден
+ *
+ * Записи добавляются по возрастанию id, поэтому одна таблица всегда
+ * даёт один и тот же файл.
+ */
+std::string buildKeyStore(const KeyTable& keys)
+{
+    if (keys.size() > (1u << 30))
+        throw std::runtime_error("Слишком много ключей: " + std::to_string(keys.size()));
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < 2 * keys.size())
+        bits++;
+    const size_t slots = size_t(1) << bits;
+
+    std::vector<uint32_t> ids;
+    for (const auto& entry : keys)
+        ids.push_back(entry.first);
+    std::sort(ids.begin(), ids.end());
+
+    std::vector<std::string> table(slots);
+    std::string letters;
+    const size_t lettersStart = HEADER_SIZE + slots * SLOT_SIZE;
+    for (uint32_t id : ids) {
+        const CipherOptions& options = keys.at(id);
+        std::string slot;
+        putU32(slot, id);
+        uint8_t flags = (options.passthrough ? FLAG_PASSTHROUGH : 0) | (options.preserveCase ? FLAG_PRESERVE_CASE : 0);
+        try {
+            if (options.encoding != "utf8")
+                throw std::runtime_error("кодировка " + options.encoding + " не поддерживается хранилищем ключей");
+            if (options.cipher == "alpha") {
+                std::vector<uint8_t> indices = alphaIndices(options.key);
+                size_t offset = lettersStart + letters.size();
+                if (offset > UINT32_MAX - indices.size())
+                    throw std::runtime_error("хранилище ключей больше 4 ГБ");
+                slot += static_cast<char>(SLOT_ALPHA);
+                slot += static_cast<char>(flags);
+                putU16(slot, static_cast<uint16_t>(indices.size()));
+                putU32(slot, static_cast<uint32_t>(offset));
+                letters.append(indices.begin(), indices.end());
+            } else if (options.cipher == "route") {
+                slot += static_cast<char>(SLOT_ROUTE);
+                slot += static_cast<char>(flags);
+                putU16(slot, 0);
+                putU32(slot, routeColumns(options.key));
+            } else {
+                throw std::runtime_error("шифр " + options.cipher + " не поддерживается хранилищем ключей");
+            }
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error("id " + std::to_string(id) + ": " + e.what());
+        }
+
+        size_t i = firstSlot(id, bits);
+        while (!table[i].empty())
+            i = (i + 1) & (slots - 1);
+        table[i] = slot;
+    }
+
+    std::string image(MAGIC, sizeof(MAGIC));
+    putU32(image, static_cast<uint32_t>(keys.size()));
+    putU32(image, static_cast<uint32_t>(slots));
+    for (const std::string& slot : table)
+        image += slot.empty() ? std::string(SLOT_SIZE, '\0') : slot;
+    return image + letters;
+}
+
+/**
+ * @brief Записывает хранилище в файл
+ * @param keys Таблица ключей
+ * @param path Путь к файлу
+ * @throw std::runtime_error при ошибке записи или невалидном ключе
+ *
+ * Образ пишется в path.tmp и переименовывается в path: читатели видят
+ * либо старый файл, либо новый целиком.
+ */
+void writeKeyStore(const KeyTable& keys, const std::string& path)
+{
+    std::string image = buildKeyStore(keys);
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+        throw systemError(temporary);
+    const char* data = image.data();
+    size_t left = image.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, data, left);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            std::runtime_error e = systemError(temporary);
+            ::close(fd);
+            ::unlink(temporary.c_str());
+            throw e;
+        }
+        data += n;
+        left -= static_cast<size_t>(n);
+    }
+    if (::fsync(fd) != 0 || ::close(fd) != 0 || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::runtime_error e = systemError(path);
+        ::unlink(temporary.c_str());
+        throw e;
+    }
+}
+
+/**
+ * @brief Открывает хранилище
+ * @param path Двоичный файл хранилища или текстовый файл ключей
+ * @throw std::runtime_error если файл не открывается или повреждён
+ */
+KeyStore::KeyStore(const std::string& path) : path(path), current(load(path)), version(0)
+{
+}
+
+KeyStore::~KeyStore() = default;
+
+/**
+ * @brief Открывает версию файла
+ * @param path Путь к файлу
+ * @throw std::runtime_error если файл не открывается или повреждён
+ *
+ * Двоичный файл отображается, и проверяется только заголовок: размер
+ * таблицы ячеек. Ячейки проверяются при поиске (lookup).
+ */
+std::shared_ptr<const KeyStore::Image> KeyStore::load(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw systemError(path);
+    auto image = std::make_shared<Image>();
+    char magic[sizeof(MAGIC)];
+    bool binary = ::fstat(fd, &image->identity) == 0 && S_ISREG(image->identity.st_mode)
+                  && ::pread(fd, magic, sizeof(magic), 0) == static_cast<ssize_t>(sizeof(magic))
+                  && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    if (binary) {
+        image->size = static_cast<size_t>(image->identity.st_size);
+        void* p = ::mmap(nullptr, image->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            throw systemError(path);
+        image->mapping = p;
+        image->data = static_cast<const char*>(p);
+    } else {
+        ::close(fd);
+        KeyTable table = loadKeyTable(path);    // сообщения уже начинаются с пути
+        try {
+            image->built = buildKeyStore(table);
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ": " + e.what());
+        }
+        image->data = image->built.data();
+        image->size = image->built.size();
+    }
+
+    auto corrupted = [&](const char* what) {
+        return std::runtime_error(path + ": повреждённое хранилище ключей (" + what + ")");
+    };
+    if (image->size < HEADER_SIZE)
+        throw corrupted("заголовок");
+    image->count = getU32(image->data + 8);
+    image->slots = getU32(image->data + 12);
+    while (image->bits < 32 && (uint64_t(1) << image->bits) < image->slots)
+        image->bits++;
+    if (image->slots == 0 || (uint64_t(1) << image->bits) != image->slots)
+        throw corrupted("число ячеек");
+    if (image->slots > (image->size - HEADER_SIZE) / SLOT_SIZE || image->count > image->slots / 2)
+        throw corrupted("таблица ячеек");
+    return image;
+}
+
+/**
+ * @brief Текущая версия
+ */
+std::shared_ptr<const KeyStore::Image> KeyStore::image() const
+{
+    return std::atomic_load(&current);
+}
+
+/**
+ * @brief Перечитывает файл, если он изменился
+ * @return true, если загружена новая версия
+ * @throw std::runtime_error если новая версия не открывается или повреждена
+ */
+bool KeyStore::reload()
+{
+    std::lock_guard<std::mutex> guard(reloading);
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        throw systemError(path);
+    if (sameFile(st, image()->identity))
+        return false;
+    std::atomic_store(&current, load(path));
+    version++;
+    return true;
+}
+
+/**
+ * @brief Ищет шифр арендатора
+ * @param tenant id арендатора
+ * @param out Шифр
+ * @return false, если id нет в хранилище
+ * @throw std::runtime_error если запись повреждена
+ *
+ * Шифр alpha удерживает версию файла (modAlphaCipher::fromIndices),
+ * поэтому остаётся годным после перезагрузки.
+ */
+bool KeyStore::lookup(uint32_t tenant, TenantCipher& out) const
+{
+    std::shared_ptr<const Image> snapshot = image();
+    const Image& in = *snapshot;
+    const size_t mask = in.slots - 1;
+    size_t i = firstSlot(tenant, in.bits);
+    for (size_t probe = 0; probe < in.slots; probe++, i = (i + 1) & mask) {
+        const char* slot = in.data + HEADER_SIZE + i * SLOT_SIZE;
+        uint8_t kind = static_cast<uint8_t>(slot[4]);
+        if (kind == SLOT_EMPTY)
+            return false;
+        if (getU32(slot) != tenant)
+            continue;
+
+        uint8_t flags = static_cast<uint8_t>(slot[5]);
+        uint16_t length = getU16(slot + 6);
+        uint32_t value = getU32(slot + 8);
+        auto corrupted = [&] {
+            return std::runtime_error(path + ": повреждена запись ключа " + std::to_string(tenant));
+        };
+        if (kind == SLOT_ALPHA) {
+            if (value > in.size || length > in.size - value)
+                throw corrupted();
+            try {
+                out.alpha = modAlphaCipher::fromIndices(
+                    snapshot, reinterpret_cast<const uint8_t*>(in.data + value), length,
+                    flags & FLAG_PASSTHROUGH ? modAlphaCipher::TextMode::Passthrough
+                                             : modAlphaCipher::TextMode::Filter,
+                    (flags & FLAG_PRESERVE_CASE) != 0);
+            } catch (const cipher_error&) {
+                throw corrupted();
+            }
+            out.cipher = "alpha";
+            out.route.reset();
+        } else if (kind == SLOT_ROUTE) {
+            if (value == 0 || value > INT_MAX)
+                throw corrupted();
+            out.cipher = "route";
+            out.route.emplace(static_cast<int>(value));
+            out.alpha.reset();
+        } else {
+            throw corrupted();
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Число ключей текущей версии
+ */
+size_t KeyStore::size() const
+{
+    return image()->count;
+}
+
+/**
+ * @brief Создаёт построчный адаптер для шифра из хранилища
+ * @param tenant Шифр арендатора
+ * @return Адаптер (строки в UTF-8)
+ */
+std::unique_ptr<LineCipher> makeLineCipher(const TenantCipher& tenant)
+{
+    if (tenant.alpha)
+        return makeAlphaLineCipher(*tenant.alpha, "utf8");
+    if (tenant.route)
+        return makeRouteLineCipher(*tenant.route);
+    throw std::invalid_argument("Шифр арендатора не задан");
+}
@@ -0,0 +1,139 @@
+/**
+ * @file KeyStore.h
+ * @brief Хранилище ключей арендаторов: двоичный файл, отображённый в память
+ *
+ * Ключи заранее проверены и записаны компактной хеш-таблицей
+ * (writeKeyStore), поэтому при запуске файл только отображается (mmap)
+ * и проверяется заголовок - время не зависит от числа ключей. Поиск по
+ * id арендатора - O(1): открытая адресация с линейным пробированием.
+ * Шифр alpha ссылается на индексы ключа прямо в отображении
+ * (modAlphaCipher::fromIndices), без копирования и перевода из букв.
+ *
+ * Формат (все числа - в сетевом порядке байт):
+ * ```
+ * "CIPHKEY1"                       магическое число и версия, 8 байт
+ * u32 N                            число ключей
+ * u32 S                            число ячеек (степень двойки, S >= 2 * N)
+ * S x {u32 id, u8 шифр, u8 флаги, u16 длина ключа, u32 значение}
+ * индексы букв ключей alpha (0..32) подряд
+ * ```
+ * Шифр: 0 - пустая ячейка, 1 - alpha, 2 - route. Флаги: 1 - Passthrough,
+ * 2 - сохранение регистра. Значение: для alpha - смещение индексов ключа
+ * от начала файла, для route - число столбцов. Ячейка id - (id *
+ * 0x9E3779B1) >> (32 - log2 S), при занятой - следующая по кругу.
+ *
+ * Файл заменяется целиком переименованием (writeKeyStore так и пишет),
+ * а reload() отображает новую версию и подменяет её атомарно: шифры,
+ * выданные раньше, удерживают старое отображение, пока живы.
+ */
+
+#pragma once
+#include "KeyTable.h"
+#include "modAlphaCipher.h"
+#include "TableRouteCipher.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+/**
+ * @struct TenantCipher
+ * @brief Шифр арендатора из хранилища
+ */
+struct TenantCipher {
+    std::string cipher;                     ///< Имя шифра: alpha или route
+    std::optional<modAlphaCipher> alpha;    ///< Шифр alpha (ключ - в отображении файла)
+    std::optional<TableRouteCipher> route;  ///< Шифр route
+};
+
+/**
+ * @brief Собирает образ хранилища из таблицы ключей
+ * @param keys Таблица ключей (KeyTable.h)
+ * @return Содержимое файла хранилища
+ * @throw std::runtime_error если шифр не поддерживается хранилищем или ключ невалиден
+ */
+std::string buildKeyStore(const KeyTable& keys);
+
+/**
+ * @brief Записывает хранилище в файл
+ * @param keys Таблица ключей
+ * @param path Путь к файлу; заменяется атомарно (запись во временный файл и rename)
+ * @throw std::runtime_error при ошибке записи или невалидном ключе
+ */
+void writeKeyStore(const KeyTable& keys, const std::string& path);
+
+/**
+ * @class KeyStore
+ * @brief Хранилище ключей с атомарной перезагрузкой
+ *
+ * Методы потокобезопасны: lookup() работает с текущей версией файла,
+ * reload() подменяет её для последующих вызовов.
+ */
+class KeyStore
+{
+public:
+    /**
+     * @brief Открывает хранилище
+     * @param path Двоичный файл хранилища или текстовый файл ключей (KeyTable.h)
+     * @throw std::runtime_error если файл не открывается или повреждён
+     *
+     * Текстовый файл разбирается и собирается в образ в памяти
+     * (buildKeyStore) - для него время запуска линейно.
+     */
+    explicit KeyStore(const std::string& path);
+
+    ~KeyStore();
+
+    KeyStore(const KeyStore&) = delete;
+    KeyStore& operator=(const KeyStore&) = delete;
+
+    /**
+     * @brief Перечитывает файл, если он изменился
+     * @return true, если загружена новая версия
+     * @throw std::runtime_error если новая версия не открывается или
+     *        повреждена (текущая остаётся в силе)
+     */
+    bool reload();
+
+    /**
+     * @brief Ищет шифр арендатора
+     * @param tenant id арендатора
+     * @param out Шифр (заполняется, если id найден)
+     * @return false, если id нет в хранилище
+     * @throw std::runtime_error если запись повреждена
+     */
+    bool lookup(uint32_t tenant, TenantCipher& out) const;
+
+    /// Число ключей текущей версии
+    size_t size() const;
+
+    /// Номер версии: увеличивается при каждой успешной перезагрузке
+    uint64_t generation() const { return version.load(); }
+
+private:
+    struct Image;
+
+    std::string path;                       ///< Путь к файлу
+    std::shared_ptr<const Image> current;   ///< Текущая версия (std::atomic_load/atomic_store)
+    std::atomic<uint64_t> version;          ///< Номер версии
+    std::mutex reloading;                   ///< Одна перезагрузка за раз
+
+    /// Текущая версия
+    std::shared_ptr<const Image> image() const;
+
+    /**
+     * @brief Открывает версию файла
+     * @throw std::runtime_error если файл не открывается или повреждён
+     */
+    static std::shared_ptr<const Image> load(const std::string& path);
+};
+
+/**
+ * @brief Создаёт построчный адаптер для шифра из хранилища
+ * @param tenant Шифр арендатора
+ * @return Адаптер (строки в UTF-8)
+ */
+std::unique_ptr<LineCipher> makeLineCipher(const TenantCipher& tenant);
@@ -0,0 +1,68 @@
+/**
+ * @file KeyTable.cpp
+ * @brief Загрузка таблицы ключей демона шифрования
+ */
+
+#include "KeyTable.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Загружает и проверяет таблицу ключей
+ * @param path Путь к файлу ключей
+ * @return Таблица ключей
+ * @throw std::runtime_error при ошибке чтения или неверной записи
+ */
+KeyTable loadKeyTable(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error(path + ": не удалось открыть файл ключей");
+
+    KeyTable table;
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); number++) {
+        std::istringstream fields(line);
+        std::string id;
+        if (!(fields >> id) || id[0] == '#')
+            continue;
+
+        auto fail = [&](const std::string& message) {
+            return std::runtime_error(path + ":" + std::to_string(number) + ": " + message);
+        };
+
+        CipherOptions options;
+        if (!(fields >> options.cipher >> options.key))
+            throw fail("ожидается: id шифр ключ [passthrough] [case]");
+        std::string flag;
+        while (fields >> flag) {
+            if (flag == "passthrough")
+                options.passthrough = true;
+            else if (flag == "case")
+                options.preserveCase = true;
+            else
+                throw fail("неизвестный флаг " + flag);
+        }
+
+        unsigned long keyId;
+        try {
+            size_t used;
+            keyId = std::stoul(id, &used);
+            if (used != id.size() || keyId > UINT32_MAX)
+                throw std::out_of_range(id);
+        } catch (const std::logic_error&) {
+            throw fail("неверный id ключа " + id);
+        }
+
+        // Ключ проверяется созданием шифра
+        try {
+            makeLineCipher(options);
+        } catch (const std::invalid_argument& e) {
+            throw fail(e.what());
+        }
+        if (!table.emplace(static_cast<uint32_t>(keyId), options).second)
+            throw fail("повторный id ключа " + id);
+    }
+    return table;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file KeyTable.h
+ * @brief Таблица ключей демона шифрования
+ *
+ * Файл ключей - текст, одна запись в строке:
+ * ```
+ * # id  шифр   ключ   [флаги]
+ * 1     alpha  КЛЮЧ
+ * 2     alpha  ШИФР   passthrough case
+ * 3     route  5
+ * ```
+ * Пустые строки и строки, начинающиеся с '#', пропускаются.
+ */
+
+#pragma once
+#include "LineCipher.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/// Параметры шифров по идентификатору ключа
+typedef std::unordered_map<uint32_t, CipherOptions> KeyTable;
+
+/**
+ * @brief Загружает и проверяет таблицу ключей
+ * @param path Путь к файлу ключей
+ * @return Таблица ключей
+ * @throw std::runtime_error если файл не читается, запись неверна
+ *        или ключ не проходит проверку шифра
+ */
+KeyTable loadKeyTable(const std::string& path);
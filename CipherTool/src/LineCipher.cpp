@@ -0,0 +1,114 @@
+/**
+ * @file LineCipher.cpp
+ * @brief Реестр шифров по имени и построчная обработка блоков контейнера
+ */
+
+#include "LineCipher.h"
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @struct Registry
+ * @brief Имена шифров и их фабрики
+ */
+struct Registry {
+    std::mutex lock;                                ///< Защита makers
+    std::map<std::string, LineCipherMaker> makers;  ///< Имя -> фабрика
+};
+
+/**
+ * @brief Реестр со встроенными шифрами
+ *
+ * Создаётся при первом обращении, поэтому не зависит от порядка
+ * инициализации статических объектов.
+ */
+Registry& registry()
+{
+    static Registry instance{{}, {{"alpha", makeAlphaLineCipher}, {"route", makeRouteLineCipher}}};
+    return instance;
+}
+
+/**
+ * @brief Обрабатывает блок контейнера построчно
+ * @return false, если в какой-либо строке ошибка (error - первая из них)
+ */
+bool processBlock(LineCipher& cipher, const std::string& in, bool decrypt, std::string& out, std::string& error)
+{
+    LineErrors errors;
+    out.clear();
+    cipher.processLines(in.data(), in.size(), decrypt, out, errors);
+    if (errors.empty())
+        return true;
+    error = "Строка " + std::to_string(errors.front().first + 1) + ": " + errors.front().second;
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Шифрует блок контейнера построчно
+ */
+bool LineCipher::encryptBlock(const std::string& in, uint64_t& /*position*/, std::string& out, uint64_t& param,
+                              std::string& error)
+{
+    param = 0;
+    return processBlock(*this, in, false, out, error);
+}
+
+/**
+ * @brief Дешифрует блок контейнера построчно
+ */
+bool LineCipher::decryptBlock(const std::string& in, uint64_t /*param*/, std::string& out, std::string& error)
+{
+    return processBlock(*this, in, true, out, error);
+}
+
+/**
+ * @brief Регистрирует шифр под именем
+ * @param name Имя шифра
+ * @param maker Фабрика
+ * @throw std::invalid_argument если имя уже занято
+ */
+void registerLineCipher(const std::string& name, LineCipherMaker maker)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    if (!r.makers.emplace(name, maker).second)
+        throw std::invalid_argument("Шифр уже зарегистрирован: " + name);
+}
+
+/**
+ * @brief Имена зарегистрированных шифров по алфавиту
+ */
+std::vector<std::string> lineCipherNames()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    std::vector<std::string> names;
+    for (const auto& entry : r.makers)
+        names.push_back(entry.first);
+    return names;
+}
+
+/**
+ * @brief Создаёт шифр по имени из реестра
+ * @param options Параметры шифра
+ * @throw std::invalid_argument если имя неизвестно или ключ невалиден
+ */
+std::unique_ptr<LineCipher> makeLineCipher(const CipherOptions& options)
+{
+    LineCipherMaker maker = nullptr;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        auto it = r.makers.find(options.cipher);
+        if (it != r.makers.end())
+            maker = it->second;
+    }
+    if (!maker)
+        throw std::invalid_argument("Неизвестный шифр: " + options.cipher);
+    return maker(options);
+}
@@ -0,0 +1,225 @@
+/**
+ * @file LineCipher.h
+ * @brief Общий построчный интерфейс шифров и реестр шифров по имени
+ *
+ * Конвейер, пакетный режим и демон работают с байтами UTF-8 и не
+ * зависят от конкретного шифра: шифр выбирается по имени из реестра
+ * (makeLineCipher). Встроенные шифры - alpha (modAlphaCipher) и route
+ * (TableRouteCipher); другие регистрируются registerLineCipher.
+ *
+ * Блок строк обрабатывается одним виртуальным вызовом processLines.
+ * Адаптеры наследуют LineCipherImpl, цикл по строкам которого вызывает
+ * метод адаптера напрямую, поэтому выбор шифра во время выполнения не
+ * добавляет косвенного вызова на каждую строку.
+ *
+ * Для контейнера (Container.h) шифр обрабатывает блок сплошного текста
+ * целиком (encryptBlock/decryptBlock): переводы строк - обычные символы,
+ * а параметр блока позволяет дешифровать его независимо от остальных.
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class modAlphaCipher;
+class TableRouteCipher;
+
+/**
+ * @struct CipherOptions
+ * @brief Параметры шифра из командной строки
+ */
+struct CipherOptions {
+    std::string cipher = "alpha";   ///< Имя шифра в реестре: alpha, route или зарегистрированное
+    std::string key;                ///< Ключ (слово для alpha, число столбцов для route)
+    bool passthrough = false;       ///< Режим Passthrough для alpha
+    bool preserveCase = false;      ///< Сохранение регистра для alpha
+    std::string encoding = "utf8";  ///< Кодировка текста для alpha: utf8, cp1251 или koi8r
+};
+
+/**
+ * @brief Ошибки строк блока: номер строки в блоке (с 0) и сообщение
+ */
+typedef std::vector<std::pair<size_t, std::string>> LineErrors;
+
+/**
+ * @class LineCipher
+ * @brief Шифрование и дешифрование строк текста в UTF-8
+ *
+ * Экземпляр не является потокобезопасным: каждый рабочий поток
+ * создаёт собственный экземпляр.
+ */
+class LineCipher
+{
+public:
+    virtual ~LineCipher() = default;
+
+    /**
+     * @brief Шифрует строку
+     * @param in Открытый текст (UTF-8, без перевода строки)
+     * @param out Зашифрованный текст
+     * @param error Сообщение об ошибке
+     * @return false при ошибке
+     */
+    virtual bool encrypt(const std::string& in, std::string& out, std::string& error) = 0;
+
+    /**
+     * @brief Дешифрует строку
+     * @param in Зашифрованный текст (UTF-8, без перевода строки)
+     * @param out Расшифрованный текст
+     * @param error Сообщение об ошибке
+     * @return false при ошибке
+     */
+    virtual bool decrypt(const std::string& in, std::string& out, std::string& error) = 0;
+
+    /**
+     * @brief Обрабатывает все строки блока
+     * @param data Начало блока
+     * @param size Размер блока, байт
+     * @param decrypt Дешифрование вместо шифрования
+     * @param output Строка, к которой дописывается результат
+     * @param errors Список, к которому дописываются ошибки строк
+     * @return Число строк в блоке (последняя может быть без перевода строки)
+     *
+     * Пустые строки сохраняются как есть, строка с ошибкой выводится пустой.
+     */
+    virtual size_t processLines(const char* data, size_t size, bool decrypt,
+                                std::string& output, LineErrors& errors) = 0;
+
+    /**
+     * @brief Шифрует блок сплошного текста контейнера
+     * @param in Блок (UTF-8 или кодировка шифра, с переводами строк)
+     * @param position Позиция потока перед блоком; увеличивается на блок
+     * @param out Зашифрованный блок
+     * @param param Параметр блока для таблицы контейнера
+     * @param error Сообщение об ошибке
+     * @return false при ошибке
+     *
+     * По умолчанию блок шифруется построчно (processLines), параметр - 0,
+     * а первая ошибка строки - ошибка блока. Шифры с состоянием потока
+     * (alpha: позиция в ключе) и с таблицей на блок (route) переопределяют
+     * метод.
+     */
+    virtual bool encryptBlock(const std::string& in, uint64_t& position, std::string& out, uint64_t& param,
+                              std::string& error);
+
+    /**
+     * @brief Дешифрует блок контейнера независимо от остальных
+     * @param in Зашифрованный блок
+     * @param param Параметр блока из таблицы контейнера
+     * @param out Расшифрованный блок
+     * @param error Сообщение об ошибке
+     * @return false при ошибке
+     */
+    virtual bool decryptBlock(const std::string& in, uint64_t param, std::string& out, std::string& error);
+};
+
+/**
+ * @class LineCipherImpl
+ * @brief Реализация LineCipher через метод адаптера transformLine
+ * @tparam Derived Адаптер с методом
+ *         `bool transformLine(const std::string& in, std::string& out, std::string& error, bool decrypt)`
+ *
+ * Все виртуальные методы сводятся к transformLine; в цикле
+ * processLines он вызывается без косвенного перехода и встраивается.
+ */
+template <class Derived>
+class LineCipherImpl : public LineCipher
+{
+public:
+    bool encrypt(const std::string& in, std::string& out, std::string& error) override
+    {
+        return self().transformLine(in, out, error, false);
+    }
+
+    bool decrypt(const std::string& in, std::string& out, std::string& error) override
+    {
+        return self().transformLine(in, out, error, true);
+    }
+
+    size_t processLines(const char* data, size_t size, bool decrypt,
+                        std::string& output, LineErrors& errors) override
+    {
+        std::string line, out, error;
+        size_t lines = 0;
+        const char* end = data + size;
+        while (data < end) {
+            const char* eol = static_cast<const char*>(std::memchr(data, '\n', end - data));
+            bool newline = eol != nullptr;
+            if (!newline)
+                eol = end;
+            line.assign(data, eol);
+
+            // Пустые строки сохраняются как есть
+            if (!line.empty()) {
+                if (self().transformLine(line, out, error, decrypt))
+                    output += out;
+                else
+                    errors.emplace_back(lines, error);
+            }
+            if (newline)
+                output += '\n';
+            lines++;
+            data = eol + 1;
+        }
+        return lines;
+    }
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+/**
+ * @brief Фабрика шифра реестра
+ * @throw std::invalid_argument если параметры (ключ) невалидны
+ */
+typedef std::unique_ptr<LineCipher> (*LineCipherMaker)(const CipherOptions& options);
+
+/**
+ * @brief Регистрирует шифр под именем
+ * @param name Имя для CipherOptions::cipher
+ * @param maker Фабрика
+ * @throw std::invalid_argument если имя уже занято
+ *
+ * Потокобезопасна; регистрировать шифры следует до запуска рабочих потоков.
+ */
+void registerLineCipher(const std::string& name, LineCipherMaker maker);
+
+/**
+ * @brief Имена зарегистрированных шифров по алфавиту
+ */
+std::vector<std::string> lineCipherNames();
+
+/**
+ * @brief Создаёт адаптер modAlphaCipher
+ * @throw std::invalid_argument если ключ невалиден
+ */
+std::unique_ptr<LineCipher> makeAlphaLineCipher(const CipherOptions& options);
+
+/**
+ * @brief Создаёт адаптер TableRouteCipher
+ * @throw std::invalid_argument если ключ невалиден
+ */
+std::unique_ptr<LineCipher> makeRouteLineCipher(const CipherOptions& options);
+
+/**
+ * @brief Создаёт адаптер над готовым modAlphaCipher (например, из KeyStore)
+ * @param cipher Шифр; адаптер хранит его копию (ключ не копируется)
+ * @param encoding Кодировка строк: utf8, cp1251 или koi8r
+ * @throw std::invalid_argument если кодировка неизвестна
+ */
+std::unique_ptr<LineCipher> makeAlphaLineCipher(const modAlphaCipher& cipher, const std::string& encoding);
+
+/**
+ * @brief Создаёт адаптер над готовым TableRouteCipher
+ */
+std::unique_ptr<LineCipher> makeRouteLineCipher(const TableRouteCipher& cipher);
+
+/**
+ * @brief Создаёт шифр по имени из реестра
+ * @throw std::invalid_argument если имя неизвестно или ключ невалиден
+ */
+std::unique_ptr<LineCipher> makeLineCipher(const CipherOptions& options);
@@ -0,0 +1,253 @@
+/**
+ * @file Pipeline.cpp
+ * @brief Реализация трёхстадийного конвейера шифрования
+ */
+
+#include "Pipeline.h"
+#include "BoundedQueue.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @struct Chunk
+ * @brief Блок входных строк и результат его обработки
+ */
+struct Chunk {
+    std::string input;                                      ///< Входные строки
+    std::string output;                                     ///< Результат
+    size_t lines = 0;                                       ///< Число строк в блоке
+    LineErrors errors;                                      ///< Ошибки строк блока
+    std::promise<void> done;                                ///< Обработка завершена
+};
+
+typedef std::shared_ptr<Chunk> ChunkPtr;
+
+} // namespace
+
+/**
+ * @brief Читает до size байт, повторяя чтение при прерывании
+ * @return Прочитано байт (0 - конец файла)
+ * @throw std::runtime_error при ошибке чтения
+ */
+size_t readSome(int fd, char* data, size_t size)
+{
+    for (;;) {
+        ssize_t n = ::read(fd, data, size);
+        if (n >= 0)
+            return static_cast<size_t>(n);
+        if (errno != EINTR)
+            throw std::runtime_error(std::string("Ошибка чтения: ") + std::strerror(errno));
+    }
+}
+
+/**
+ * @brief Записывает буфер целиком
+ * @throw std::runtime_error при ошибке записи
+ */
+void writeAll(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Ошибка записи: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+/**
+ * @brief Идентичность открытого файла
+ * @return FileId или пустой FileId, если fstat не удался
+ */
+FileId fileId(int fd)
+{
+    FileId id;
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        id.device = static_cast<uint64_t>(st.st_dev);
+        id.inode = static_cast<uint64_t>(st.st_ino);
+    }
+    return id;
+}
+
+/**
+ * @brief Идентичность файла по пути (символические ссылки разыменовываются)
+ * @return FileId или пустой FileId, если файла нет
+ */
+FileId fileId(const std::string& path)
+{
+    FileId id;
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0) {
+        id.device = static_cast<uint64_t>(st.st_dev);
+        id.inode = static_cast<uint64_t>(st.st_ino);
+    }
+    return id;
+}
+
+/**
+ * @brief Открывает выходной файл на запись с обрезкой, если это не входной файл
+ * @throw std::runtime_error если path указывает на входной файл или не открывается
+ */
+int openOutput(const std::string& path, const FileId& input)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0)
+        throw std::runtime_error(path + ": " + std::strerror(errno));
+    if (input.valid() && fileId(fd) == input) {
+        ::close(fd);
+        throw std::runtime_error(path + ": выходной файл совпадает с входным");
+    }
+    if (::ftruncate(fd, 0) != 0 && errno != EINVAL) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error(path + ": " + std::strerror(error));
+    }
+    return fd;
+}
+
+/**
+ * @brief Шифрует или дешифрует поток построчно
+ * @param inFd Дескриптор входного файла или канала
+ * @param outFd Дескриптор выходного файла или канала
+ * @param factory Фабрика шифров для рабочих потоков
+ * @param options Параметры конвейера
+ * @param log Поток для сообщений об ошибках в строках
+ * @return Итоги работы
+ * @throw std::runtime_error при ошибке ввода-вывода
+ */
+PipelineStats runPipeline(int inFd, int outFd, const CipherFactory& factory,
+                          const PipelineOptions& options, std::ostream& log)
+{
+    auto start = std::chrono::steady_clock::now();
+    const unsigned workers = options.workers ? options.workers
+                                             : std::max(1u, std::thread::hardware_concurrency());
+    const size_t depth = options.queueDepth ? options.queueDepth : 2 * workers;
+    const size_t chunkSize = std::max<size_t>(options.chunkSize, 1);
+
+    BoundedQueue<ChunkPtr> work(depth);     // reader -> workers
+    BoundedQueue<ChunkPtr> ordered(depth);  // reader -> writer, в порядке чтения
+    PipelineStats stats;
+    std::exception_ptr failure;
+    std::mutex failureLock;
+    auto fail = [&](std::exception_ptr e) {
+        std::lock_guard<std::mutex> guard(failureLock);
+        if (!failure) failure = e;
+        work.close();
+        ordered.close();
+    };
+
+    // Стадия 1: чтение блоков, выровненных по концу строки
+    std::thread reader([&] {
+        try {
+            std::string pending;
+            bool eof = false;
+            while (!eof) {
+                ChunkPtr chunk = std::make_shared<Chunk>();
+                std::string& data = chunk->input;
+                data.swap(pending);
+                size_t lineEnd = data.rfind('\n');
+                while (!eof && (lineEnd == std::string::npos || data.size() < chunkSize)) {
+                    size_t old = data.size();
+                    data.resize(old + chunkSize);
+                    size_t n = readSome(inFd, &data[old], chunkSize);
+                    data.resize(old + n);
+                    eof = n == 0;
+                    lineEnd = data.rfind('\n');
+                }
+                if (!eof && lineEnd + 1 < data.size()) {
+                    pending.assign(data, lineEnd + 1, std::string::npos);
+                    data.resize(lineEnd + 1);
+                }
+                if (data.empty())
+                    break;
+                stats.bytesIn += data.size();
+                if (!ordered.push(chunk))
+                    break;
+                if (!work.push(chunk)) {
+                    // Конвейер остановлен: блок не будет обработан
+                    chunk->done.set_value();
+                    break;
+                }
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        work.close();
+        ordered.close();
+    });
+
+    // Стадия 2: пул рабочих потоков, у каждого свой экземпляр шифра
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; w++) {
+        pool.emplace_back([&] {
+            std::unique_ptr<LineCipher> cipher;
+            try {
+                cipher = factory();
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            ChunkPtr chunk;
+            while (work.pop(chunk)) {
+                try {
+                    if (cipher) {
+                        chunk->output.reserve(chunk->input.size());
+                        chunk->lines = cipher->processLines(chunk->input.data(), chunk->input.size(),
+                                                            options.decrypt, chunk->output, chunk->errors);
+                    }
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+                chunk->done.set_value();
+            }
+        });
+    }
+
+    // Стадия 3: запись блоков в исходном порядке
+    std::thread writer([&] {
+        try {
+            ChunkPtr chunk;
+            while (ordered.pop(chunk)) {
+                chunk->done.get_future().wait();
+                writeAll(outFd, chunk->output.data(), chunk->output.size());
+                for (const auto& e : chunk->errors)
+                    log << "Строка " << stats.lines + e.first + 1 << ": " << e.second << "\n";
+                stats.bytesOut += chunk->output.size();
+                stats.lines += chunk->lines;
+                stats.errors += chunk->errors.size();
+                stats.chunks++;
+                chunk.reset();
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+
+    reader.join();
+    for (auto& t : pool) t.join();
+    writer.join();
+
+    if (failure)
+        std::rethrow_exception(failure);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    return stats;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file Pipeline.h
+ * @brief Трёхстадийный конвейер шифрования: чтение, обработка, запись
+ *
+ * Поток чтения заполняет большие блоки из входного файла, выравнивая
+ * их по границе строки. Пул рабочих потоков шифрует блоки независимо
+ * друг от друга. Поток записи выводит блоки строго в исходном порядке.
+ * Очереди между стадиями ограничены, поэтому объём данных в памяти
+ * не зависит от размера входа.
+ */
+
+#pragma once
+#include "LineCipher.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Фабрика экземпляров шифра (по одному на рабочий поток)
+ */
+typedef std::function<std::unique_ptr<LineCipher>()> CipherFactory;
+
+/**
+ * @struct PipelineOptions
+ * @brief Параметры конвейера
+ */
+struct PipelineOptions {
+    bool decrypt = false;           ///< Дешифрование вместо шифрования
+    size_t chunkSize = 1 << 20;     ///< Минимальный размер блока, байт
+    unsigned workers = 0;           ///< Число рабочих потоков (0 - по числу ядер)
+    size_t queueDepth = 0;          ///< Число блоков в обработке (0 - 2 * workers)
+};
+
+/**
+ * @struct PipelineStats
+ * @brief Итоги работы конвейера
+ */
+struct PipelineStats {
+    size_t bytesIn = 0;     ///< Прочитано байт
+    size_t bytesOut = 0;    ///< Записано байт
+    size_t chunks = 0;      ///< Обработано блоков
+    size_t lines = 0;       ///< Обработано строк
+    size_t errors = 0;      ///< Строк с ошибками
+    double seconds = 0.0;   ///< Время работы, с
+};
+
+/**
+ * @brief Шифрует или дешифрует поток построчно
+ * @param inFd Дескриптор входного файла или канала
+ * @param outFd Дескриптор выходного файла или канала
+ * @param factory Фабрика шифров для рабочих потоков
+ * @param options Параметры конвейера
+ * @param log Поток для сообщений об ошибках в строках
+ * @return Итоги работы
+ * @throw std::runtime_error при ошибке ввода-вывода
+ *
+ * Каждая строка обрабатывается независимо, как отдельный вызов
+ * encrypt/decrypt. Строка с ошибкой выводится пустой, а сообщение
+ * с номером строки пишется в log.
+ */
+PipelineStats runPipeline(int inFd, int outFd, const CipherFactory& factory,
+                          const PipelineOptions& options, std::ostream& log);
+
+/**
+ * @brief Читает до size байт, повторяя чтение при прерывании
+ * @return Прочитано байт (0 - конец файла)
+ * @throw std::runtime_error при ошибке чтения
+ */
+size_t readSome(int fd, char* data, size_t size);
+
+/**
+ * @brief Записывает буфер целиком, повторяя запись при прерывании
+ * @throw std::runtime_error при ошибке записи
+ */
+void writeAll(int fd, const char* data, size_t size);
+
+/**
+ * @struct FileId
+ * @brief Идентичность файла: устройство и номер индексного дескриптора
+ *
+ * Один и тот же файл под разными путями (символические и жёсткие
+ * ссылки, "./" и т.п.) даёт одинаковый FileId.
+ */
+struct FileId {
+    uint64_t device = 0;    ///< st_dev
+    uint64_t inode = 0;     ///< st_ino (0 - файл не найден)
+
+    bool valid() const { return inode != 0; }
+    bool operator==(const FileId& other) const { return device == other.device && inode == other.inode; }
+    bool operator!=(const FileId& other) const { return !(*this == other); }
+    bool operator<(const FileId& other) const
+    {
+        return device != other.device ? device < other.device : inode < other.inode;
+    }
+};
+
+/**
+ * @brief Идентичность открытого файла
+ * @return FileId или пустой FileId, если fstat не удался
+ */
+FileId fileId(int fd);
+
+/**
+ * @brief Идентичность файла по пути (символические ссылки разыменовываются)
+ * @return FileId или пустой FileId, если файла нет
+ */
+FileId fileId(const std::string& path);
+
+/**
+ * @brief Открывает выходной файл на запись с обрезкой, если это не входной файл
+ * @param path Путь к выходному файлу (создаётся при отсутствии)
+ * @param input Идентичность входного файла (пустая - без проверки)
+ * @return Дескриптор выходного файла
+ * @throw std::runtime_error если path указывает на входной файл
+ *        (файл не изменяется) или не открывается
+ *
+ * Файл открывается без O_TRUNC и обрезается только после сравнения
+ * fstat с входом, поэтому проверка не зависит от гонки между stat и open.
+ */
+int openOutput(const std::string& path, const FileId& input);
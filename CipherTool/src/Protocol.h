@@ -0,0 +1,163 @@
+/**
+ * @file Protocol.h
+ * @brief Двоичный протокол демона шифрования
+ *
+ * Каждое сообщение - кадр с префиксом длины. Все числа передаются
+ * в сетевом порядке байт.
+ *
+ * Запрос:
+ * ```
+ * u32 длина | u32 id | u8 операция | u32 ключ | текст (UTF-8)
+ * ```
+ * Ответ:
+ * ```
+ * u32 длина | u32 id | u8 статус | текст (результат или сообщение об ошибке)
+ * ```
+ * Длина не включает собственные 4 байта. Ответы на запросы одного
+ * соединения могут приходить не по порядку: их сопоставляют по id.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace protocol {
+
+/// Максимальная длина кадра, байт
+const uint32_t MAX_FRAME = 16u << 20;
+
+/// Размер заголовка запроса после поля длины
+const size_t REQUEST_HEADER = 9;
+
+/// Размер заголовка ответа после поля длины
+const size_t RESPONSE_HEADER = 5;
+
+/**
+ * @enum Op
+ * @brief Операция запроса
+ */
+enum class Op : uint8_t {
+    Encrypt = 1,    ///< Шифрование
+    Decrypt = 2     ///< Дешифрование
+};
+
+/**
+ * @enum Status
+ * @brief Статус ответа
+ */
+enum class Status : uint8_t {
+    Ok = 0,             ///< Успешно, текст - результат
+    CipherError = 1,    ///< Ошибка шифра, текст - сообщение
+    UnknownKey = 2,     ///< Ключ с таким id не загружен
+    BadRequest = 3      ///< Неизвестная операция или неверный кадр
+};
+
+/**
+ * @struct Request
+ * @brief Разобранный запрос
+ */
+struct Request {
+    uint32_t id = 0;            ///< Идентификатор запроса
+    Op op = Op::Encrypt;        ///< Операция
+    uint32_t keyId = 0;         ///< Идентификатор ключа
+    std::string text;           ///< Текст
+};
+
+/**
+ * @struct Response
+ * @brief Разобранный ответ
+ */
+struct Response {
+    uint32_t id = 0;                ///< Идентификатор запроса
+    Status status = Status::Ok;     ///< Статус
+    std::string text;               ///< Результат или сообщение об ошибке
+};
+
+/// Дописывает u32 в сетевом порядке байт
+inline void putU32(std::string& out, uint32_t v)
+{
+    out += static_cast<char>(v >> 24);
+    out += static_cast<char>(v >> 16);
+    out += static_cast<char>(v >> 8);
+    out += static_cast<char>(v);
+}
+
+/// Читает u32 в сетевом порядке байт
+inline uint32_t getU32(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | u[3];
+}
+
+/**
+ * @brief Дописывает кадр запроса в буфер
+ */
+inline void encodeRequest(std::string& out, const Request& r)
+{
+    putU32(out, static_cast<uint32_t>(REQUEST_HEADER + r.text.size()));
+    putU32(out, r.id);
+    out += static_cast<char>(r.op);
+    putU32(out, r.keyId);
+    out += r.text;
+}
+
+/**
+ * @brief Дописывает кадр ответа в буфер
+ */
+inline void encodeResponse(std::string& out, const Response& r)
+{
+    putU32(out, static_cast<uint32_t>(RESPONSE_HEADER + r.text.size()));
+    putU32(out, r.id);
+    out += static_cast<char>(r.status);
+    out += r.text;
+}
+
+/**
+ * @brief Длина первого полного кадра в буфере
+ * @param data Начало буфера
+ * @param size Размер буфера
+ * @param frame Полная длина кадра вместе с префиксом
+ * @return 1 - кадр готов, 0 - нужно больше данных, -1 - кадр слишком велик
+ */
+inline int frameLength(const char* data, size_t size, size_t& frame)
+{
+    if (size < 4)
+        return 0;
+    uint32_t len = getU32(data);
+    if (len > MAX_FRAME)
+        return -1;
+    frame = 4 + static_cast<size_t>(len);
+    return size >= frame ? 1 : 0;
+}
+
+/**
+ * @brief Разбирает тело запроса (после префикса длины)
+ * @return false, если тело короче заголовка
+ */
+inline bool decodeRequest(const char* body, size_t size, Request& r)
+{
+    if (size < REQUEST_HEADER)
+        return false;
+    r.id = getU32(body);
+    r.op = static_cast<Op>(static_cast<uint8_t>(body[4]));
+    r.keyId = getU32(body + 5);
+    r.text.assign(body + REQUEST_HEADER, size - REQUEST_HEADER);
+    return true;
+}
+
+/**
+ * @brief Разбирает тело ответа (после префикса длины)
+ * @return false, если тело короче заголовка
+ */
+inline bool decodeResponse(const char* body, size_t size, Response& r)
+{
+    if (size < RESPONSE_HEADER)
+        return false;
+    r.id = getU32(body);
+    r.status = static_cast<Status>(static_cast<uint8_t>(body[4]));
+    r.text.assign(body + RESPONSE_HEADER, size - RESPONSE_HEADER);
+    return true;
+}
+
+} // namespace protocol
@@ -0,0 +1,113 @@
+/**
+ * @file RouteLineCipher.cpp
+ * @brief Адаптер TableRouteCipher для конвейера
+ *
+ * Блок контейнера шифруется одной таблицей; параметр блока - длина
+ * таблицы (число букв), по ней при чтении проверяется длина блока.
+ */
+
+#include "LineCipher.h"
+#include "TableRouteCipher.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+
+/**
+ * @class RouteLineCipher
+ * @brief Построчный адаптер табличного маршрутного шифра
+ */
+class RouteLineCipher final : public LineCipherImpl<RouteLineCipher>
+{
+private:
+    TableRouteCipher cipher; ///< Шифр
+
+    /**
+     * @brief Разбирает число столбцов из строки ключа
+     * @throw cipher_error если ключ не является целым числом
+     */
+    static int parseKey(const std::string& key)
+    {
+        errno = 0;
+        char* end = nullptr;
+        long value = std::strtol(key.c_str(), &end, 10);
+        if (key.empty() || *end != '\0' || errno == ERANGE || value > INT_MAX || value < INT_MIN)
+            throw cipher_error("Ключ должен быть целым числом");
+        return static_cast<int>(value);
+    }
+
+public:
+    /**
+     * @brief Конструктор
+     * @param options Параметры шифра
+     * @throw cipher_error если ключ невалиден
+     */
+    explicit RouteLineCipher(const CipherOptions& options) : cipher(parseKey(options.key)) {}
+
+    /**
+     * @brief Конструктор над готовым шифром
+     * @param cipher Шифр
+     */
+    explicit RouteLineCipher(const TableRouteCipher& cipher) : cipher(cipher) {}
+
+    /**
+     * @brief Шифрует или дешифрует строку (см. LineCipherImpl)
+     */
+    bool transformLine(const std::string& in, std::string& out, std::string& error, bool decrypt)
+    {
+        TableRouteCipher::Result result = decrypt ? cipher.tryDecrypt(in) : cipher.tryEncrypt(in);
+        if (!result) {
+            error = TableRouteCipher::errorMessage(result.error);
+            return false;
+        }
+        out.swap(result.text);
+        return true;
+    }
+
+    /**
+     * @brief Шифрует блок контейнера одной таблицей
+     */
+    bool encryptBlock(const std::string& in, uint64_t& /*position*/, std::string& out, uint64_t& param,
+                      std::string& error) override
+    {
+        param = 0;
+        if (!transformLine(in, out, error, false))
+            return false;
+        param = out.size();
+        return true;
+    }
+
+    /**
+     * @brief Дешифрует блок контейнера, сверяя его длину с таблицей
+     */
+    bool decryptBlock(const std::string& in, uint64_t param, std::string& out, std::string& error) override
+    {
+        if (in.size() != param) {
+            error = "Длина блока не совпадает с длиной таблицы";
+            return false;
+        }
+        return transformLine(in, out, error, true);
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Создаёт адаптер TableRouteCipher
+ * @param options Параметры шифра
+ * @throw std::invalid_argument если ключ невалиден
+ */
+std::unique_ptr<LineCipher> makeRouteLineCipher(const CipherOptions& options)
+{
+    return std::unique_ptr<LineCipher>(new RouteLineCipher(options));
+}
+
+/**
+ * @brief Создаёт адаптер над готовым TableRouteCipher
+ * @param cipher Шифр (адаптер хранит его копию)
+ */
+std::unique_ptr<LineCipher> makeRouteLineCipher(const TableRouteCipher& cipher)
+{
+    return std::unique_ptr<LineCipher>(new RouteLineCipher(cipher));
+}
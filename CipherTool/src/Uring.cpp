@@ -0,0 +1,200 @@
+/**
+ * @file Uring.cpp
+ * @brief Реализация обёртки над io_uring
+ */
+
+#include "Uring.h"
+
+#ifdef CIPHER_HAVE_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+/// Операции, без которых пакетная обработка невозможна
+const unsigned REQUIRED_OPS[] = {
+    IORING_OP_OPENAT, IORING_OP_CLOSE, IORING_OP_READ_FIXED,
+    IORING_OP_WRITE_FIXED, IORING_OP_READ, IORING_OP_WRITE
+};
+
+/**
+ * @brief Указатель на поле кольца по смещению из io_uring_params
+ */
+template <class T>
+T* field(void* ring, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+} // namespace
+
+/**
+ * @brief Создаёт кольцо и отображает его в память
+ * @param entries Минимальный размер кольца отправки
+ * @throw std::runtime_error если io_uring недоступен
+ */
+IoUring::IoUring(unsigned entries)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0)
+        throw std::runtime_error(std::string("io_uring_setup: ") + std::strerror(errno));
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && cqSize > sqRingSize)
+        sqRingSize = cqSize;
+
+    sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        release();
+        throw std::runtime_error("io_uring: mmap кольца отправки");
+    }
+    if (single) {
+        cqRing = sqRing;
+    } else {
+        cqRingSize = cqSize;
+        cqRing = ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            release();
+            throw std::runtime_error("io_uring: mmap кольца завершения");
+        }
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* s = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd, IORING_OFF_SQES);
+    if (s == MAP_FAILED) {
+        release();
+        throw std::runtime_error("io_uring: mmap массива SQE");
+    }
+    sqes = static_cast<io_uring_sqe*>(s);
+
+    sqHead = field<unsigned>(sqRing, params.sq_off.head);
+    sqTail = field<unsigned>(sqRing, params.sq_off.tail);
+    sqMask = *field<unsigned>(sqRing, params.sq_off.ring_mask);
+    sqEntries = *field<unsigned>(sqRing, params.sq_off.ring_entries);
+    sqArray = field<unsigned>(sqRing, params.sq_off.array);
+    cqHead = field<unsigned>(cqRing, params.cq_off.head);
+    cqTail = field<unsigned>(cqRing, params.cq_off.tail);
+    cqMask = *field<unsigned>(cqRing, params.cq_off.ring_mask);
+    cqes = field<io_uring_cqe>(cqRing, params.cq_off.cqes);
+    localTail = *sqTail;
+}
+
+IoUring::~IoUring()
+{
+    release();
+}
+
+/**
+ * @brief Снимает отображения и закрывает кольцо
+ */
+void IoUring::release()
+{
+    if (sqes)
+        ::munmap(sqes, sqesSize);
+    if (cqRing && cqRing != sqRing)
+        ::munmap(cqRing, cqRingSize);
+    if (sqRing)
+        ::munmap(sqRing, sqRingSize);
+    if (fd >= 0)
+        ::close(fd);
+    sqes = nullptr;
+    sqRing = cqRing = nullptr;
+    fd = -1;
+}
+
+/**
+ * @brief Проверяет, что ядро поддерживает все нужные операции
+ */
+bool IoUring::available()
+{
+    try {
+        IoUring ring(2);
+        const unsigned count = 256;
+        std::vector<char> storage(sizeof(io_uring_probe) + count * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        if (::syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_PROBE, probe, count) < 0)
+            return false;
+        for (unsigned op : REQUIRED_OPS)
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        return true;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Регистрирует буферы для READ_FIXED/WRITE_FIXED
+ */
+bool IoUring::registerBuffers(const iovec* buffers, unsigned count)
+{
+    return ::syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+}
+
+/**
+ * @brief Возвращает очищенный SQE для заполнения
+ */
+io_uring_sqe* IoUring::sqe()
+{
+    if (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+        submit();
+        if (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+            throw std::runtime_error("io_uring: кольцо отправки переполнено");
+    }
+    unsigned index = localTail & sqMask;
+    io_uring_sqe* entry = &sqes[index];
+    std::memset(entry, 0, sizeof(*entry));
+    sqArray[index] = index;
+    localTail++;
+    unsubmitted++;
+    return entry;
+}
+
+/**
+ * @brief Отправляет подготовленные SQE и ждёт завершений
+ */
+void IoUring::submit(unsigned wait)
+{
+    // Ядро должно увидеть заполненные SQE до нового хвоста
+    __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+    unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+    for (;;) {
+        long n = ::syscall(__NR_io_uring_enter, fd, unsubmitted, wait, flags, nullptr, 0);
+        if (n >= 0) {
+            unsubmitted -= std::min(static_cast<unsigned>(n), unsubmitted);
+            return;
+        }
+        if (errno != EINTR)
+            throw std::runtime_error(std::string("io_uring_enter: ") + std::strerror(errno));
+    }
+}
+
+/**
+ * @brief Извлекает одно завершение, если оно есть
+ */
+bool IoUring::next(io_uring_cqe& cqe)
+{
+    unsigned head = *cqHead;
+    if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+        return false;
+    cqe = cqes[head & cqMask];
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#endif // CIPHER_HAVE_URING
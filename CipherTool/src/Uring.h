@@ -0,0 +1,110 @@
+/**
+ * @file Uring.h
+ * @brief Минимальная обёртка над io_uring без liburing
+ *
+ * Кольца отправки и завершения отображаются в память напрямую,
+ * системные вызовы io_uring_setup/io_uring_enter/io_uring_register
+ * выполняются через syscall(2). Поддерживается ровно то, что нужно
+ * пакетной обработке файлов (BatchIo.h).
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <sys/uio.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define CIPHER_HAVE_URING 1
+#endif
+#endif
+#endif
+
+#ifdef CIPHER_HAVE_URING
+
+/**
+ * @class IoUring
+ * @brief Кольцо io_uring одного потока
+ *
+ * Экземпляр не является потокобезопасным.
+ */
+class IoUring
+{
+private:
+    int fd = -1;                        ///< Дескриптор кольца
+    void* sqRing = nullptr;             ///< Отображение кольца отправки
+    size_t sqRingSize = 0;              ///< Размер отображения кольца отправки
+    void* cqRing = nullptr;             ///< Отображение кольца завершения
+    size_t cqRingSize = 0;              ///< Размер отображения (0 - общее с sqRing)
+    io_uring_sqe* sqes = nullptr;       ///< Массив SQE
+    size_t sqesSize = 0;                ///< Размер массива SQE, байт
+
+    unsigned* sqHead = nullptr;         ///< Голова кольца отправки (пишет ядро)
+    unsigned* sqTail = nullptr;         ///< Хвост кольца отправки
+    unsigned sqMask = 0;                ///< Маска индексов отправки
+    unsigned sqEntries = 0;             ///< Размер кольца отправки
+    unsigned* sqArray = nullptr;        ///< Индексы SQE в кольце отправки
+    unsigned* cqHead = nullptr;         ///< Голова кольца завершения
+    unsigned* cqTail = nullptr;         ///< Хвост кольца завершения (пишет ядро)
+    unsigned cqMask = 0;                ///< Маска индексов завершения
+    io_uring_cqe* cqes = nullptr;       ///< Массив CQE
+
+    unsigned localTail = 0;             ///< Хвост с учётом ещё не опубликованных SQE
+    unsigned unsubmitted = 0;           ///< Подготовлено SQE после последнего submit
+
+    void release();
+
+public:
+    /**
+     * @brief Создаёт кольцо
+     * @param entries Минимальный размер кольца отправки
+     * @throw std::runtime_error если io_uring недоступен
+     */
+    explicit IoUring(unsigned entries);
+
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * @brief Проверяет, что ядро поддерживает все нужные операции
+     * @return true, если пакетная обработка через io_uring возможна
+     */
+    static bool available();
+
+    /**
+     * @brief Регистрирует буферы для READ_FIXED/WRITE_FIXED
+     * @param buffers Буферы
+     * @param count Число буферов
+     * @return false, если регистрация не удалась (например, из-за RLIMIT_MEMLOCK)
+     */
+    bool registerBuffers(const iovec* buffers, unsigned count);
+
+    /**
+     * @brief Возвращает очищенный SQE для заполнения
+     * @throw std::runtime_error если кольцо переполнено
+     *
+     * При заполненном кольце сначала отправляет подготовленные SQE.
+     */
+    io_uring_sqe* sqe();
+
+    /**
+     * @brief Отправляет подготовленные SQE и ждёт завершений
+     * @param wait Минимальное число завершений для ожидания
+     * @throw std::runtime_error при ошибке io_uring_enter
+     */
+    void submit(unsigned wait = 0);
+
+    /**
+     * @brief Извлекает одно завершение, если оно есть
+     * @param cqe Копия завершения
+     * @return false, если очередь завершений пуста
+     */
+    bool next(io_uring_cqe& cqe);
+};
+
+#endif // CIPHER_HAVE_URING
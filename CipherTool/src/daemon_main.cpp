@@ -0,0 +1,111 @@
+/**
+ * @file daemon_main.cpp
+ * @brief Запуск демона шифрования
+ *
+ * Использование:
+ * ```
+ * cipher_daemon -s СОКЕТ -k ФАЙЛ_КЛЮЧЕЙ [-t ПОТОКИ] [-q ГЛУБИНА]
+ * cipher_daemon -k ФАЙЛ_КЛЮЧЕЙ -c ХРАНИЛИЩЕ
+ * ```
+ * Файл ключей - текстовый (KeyTable.h) или двоичное хранилище
+ * (KeyStore.h), которое отображается в память без разбора. С -c
+ * текстовый файл компилируется в хранилище, и программа завершается.
+ *
+ * Демон работает до получения SIGINT или SIGTERM; SIGHUP перечитывает
+ * файл ключей.
+ */
+
+#include "Daemon.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+/// Демон, которому обработчик сигнала передаёт остановку
+CipherDaemon* running = nullptr;
+
+/**
+ * @brief Обработчик SIGINT/SIGTERM
+ */
+void onSignal(int)
+{
+    if (running)
+        running->stop();
+}
+
+/**
+ * @brief Обработчик SIGHUP
+ */
+void onReload(int)
+{
+    if (running)
+        running->reloadKeys();
+}
+
+} // namespace
+
+/**
+ * @brief Главная функция демона
+ * @return 0 при штатной остановке, 2 при ошибке
+ */
+int main(int argc, char** argv)
+{
+    DaemonOptions options;
+    std::string keyFile;
+    std::string compileTo;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:k:t:q:c:")) != -1) {
+        switch (opt) {
+        case 's':
+            options.socketPath = optarg;
+            break;
+        case 'k':
+            keyFile = optarg;
+            break;
+        case 't':
+            options.workers = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+            break;
+        case 'q':
+            options.queueDepth = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'c':
+            compileTo = optarg;
+            break;
+        default:
+            std::cerr << "Использование: " << argv[0]
+                      << " -s СОКЕТ -k ФАЙЛ_КЛЮЧЕЙ [-t ПОТОКИ] [-q ГЛУБИНА]\n"
+                      << "       " << argv[0] << " -k ФАЙЛ_КЛЮЧЕЙ -c ХРАНИЛИЩЕ\n";
+            return 2;
+        }
+    }
+
+    try {
+        if (!compileTo.empty()) {
+            KeyTable table = loadKeyTable(keyFile);
+            writeKeyStore(table, compileTo);
+            std::cerr << "Хранилище записано: " << compileTo << ", ключей: " << table.size() << std::endl;
+            return 0;
+        }
+
+        KeyStore keys(keyFile);
+        CipherDaemon daemon(keys, options);
+
+        running = &daemon;
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        std::signal(SIGHUP, onReload);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        std::cerr << "Демон запущен: " << options.socketPath << ", ключей: " << keys.size() << std::endl;
+        daemon.run();
+        running = nullptr;
+        std::cerr << "Демон остановлен" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "[ОШИБКА] " << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
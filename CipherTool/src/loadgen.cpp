@@ -0,0 +1,241 @@
+/**
+ * @file loadgen.cpp
+ * @brief Генератор нагрузки для демона шифрования
+ *
+ * Использование:
+ * ```
+ * cipher_loadgen -s СОКЕТ -k ID_КЛЮЧА [-c СОЕДИНЕНИЙ] [-n ЗАПРОСОВ] [-w ОКНО] [-l ДЛИНА] [-r] [-d]
+ * ```
+ * - `-c` - число соединений (каждое в своём потоке)
+ * - `-n` - запросов на соединение
+ * - `-w` - запросов в полёте на соединение
+ * - `-l` - длина текста запроса, символов
+ * - `-r` - латинский текст (для шифра route) вместо русского
+ * - `-d` - запросы на дешифрование
+ *
+ * Выводит число запросов в секунду и задержки p50/p99/p999.
+ */
+
+#include "Protocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @struct LoadOptions
+ * @brief Параметры нагрузки
+ */
+struct LoadOptions {
+    std::string socketPath;     ///< Путь к сокету демона
+    uint32_t keyId = 1;         ///< Идентификатор ключа
+    unsigned connections = 4;   ///< Число соединений
+    size_t requests = 10000;    ///< Запросов на соединение
+    size_t window = 1;          ///< Запросов в полёте на соединение
+    size_t length = 64;         ///< Длина текста
+    bool latin = false;         ///< Латинский текст
+    bool decrypt = false;       ///< Дешифрование
+};
+
+/**
+ * @struct ConnectionResult
+ * @brief Итоги одного соединения
+ */
+struct ConnectionResult {
+    std::vector<double> latencies;  ///< Задержки, мкс
+    size_t errors = 0;              ///< Ответы с ошибкой
+    std::string failure;            ///< Ошибка соединения
+};
+
+/**
+ * @brief Создаёт текст запроса
+ */
+std::string makeText(const LoadOptions& options)
+{
+    const char* russian = "ПРИВЕТМИРШИФРОВАНИЕ";
+    std::string text;
+    for (size_t i = 0; i < options.length; i++) {
+        if (options.latin) {
+            text += static_cast<char>('A' + i % 26);
+        } else {
+            // Двухбайтовые символы UTF-8
+            size_t k = (i % 19) * 2;
+            text.append(russian + k, 2);
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief Отправляет буфер целиком
+ */
+void sendAll(int fd, const std::string& data)
+{
+    size_t pos = 0;
+    while (pos < data.size()) {
+        ssize_t n = ::send(fd, data.data() + pos, data.size() - pos, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+        pos += static_cast<size_t>(n);
+    }
+}
+
+/**
+ * @brief Нагрузка через одно соединение
+ */
+void runConnection(const LoadOptions& options, const std::string& text, ConnectionResult& result)
+{
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, options.socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        result.failure = std::string("connect: ") + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        return;
+    }
+
+    std::vector<Clock::time_point> sent(options.requests);
+    result.latencies.reserve(options.requests);
+    protocol::Request request;
+    request.op = options.decrypt ? protocol::Op::Decrypt : protocol::Op::Encrypt;
+    request.keyId = options.keyId;
+    request.text = text;
+
+    try {
+        size_t next = 0;
+        auto sendUpTo = [&](size_t limit) {
+            std::string batch;
+            for (; next < limit && next < options.requests; next++) {
+                request.id = static_cast<uint32_t>(next);
+                protocol::encodeRequest(batch, request);
+                sent[next] = Clock::now();
+            }
+            if (!batch.empty())
+                sendAll(fd, batch);
+        };
+        sendUpTo(options.window);
+
+        std::string in;
+        char buffer[64 * 1024];
+        size_t received = 0;
+        while (received < options.requests) {
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                throw std::runtime_error("соединение закрыто демоном");
+            in.append(buffer, static_cast<size_t>(n));
+
+            size_t pos = 0, frame = 0;
+            while (protocol::frameLength(in.data() + pos, in.size() - pos, frame) == 1) {
+                protocol::Response response;
+                protocol::decodeResponse(in.data() + pos + 4, frame - 4, response);
+                auto now = Clock::now();
+                if (response.id < sent.size())
+                    result.latencies.push_back(
+                        std::chrono::duration<double, std::micro>(now - sent[response.id]).count());
+                if (response.status != protocol::Status::Ok)
+                    result.errors++;
+                received++;
+                pos += frame;
+            }
+            in.erase(0, pos);
+            sendUpTo(received + options.window);
+        }
+    } catch (const std::exception& e) {
+        result.failure = e.what();
+    }
+    ::close(fd);
+}
+
+/**
+ * @brief Перцентиль отсортированной выборки
+ */
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace
+
+/**
+ * @brief Главная функция генератора нагрузки
+ * @return 0 при успехе, 1 если были ошибки, 2 при ошибке параметров
+ */
+int main(int argc, char** argv)
+{
+    LoadOptions options;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:k:c:n:w:l:rd")) != -1) {
+        switch (opt) {
+        case 's': options.socketPath = optarg; break;
+        case 'k': options.keyId = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'c': options.connections = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'n': options.requests = std::strtoul(optarg, nullptr, 10); break;
+        case 'w': options.window = std::max<size_t>(1, std::strtoul(optarg, nullptr, 10)); break;
+        case 'l': options.length = std::strtoul(optarg, nullptr, 10); break;
+        case 'r': options.latin = true; break;
+        case 'd': options.decrypt = true; break;
+        default:
+            std::cerr << "Использование: " << argv[0]
+                      << " -s СОКЕТ -k ID_КЛЮЧА [-c СОЕДИНЕНИЙ] [-n ЗАПРОСОВ] [-w ОКНО] [-l ДЛИНА] [-r] [-d]\n";
+            return 2;
+        }
+    }
+    if (options.socketPath.empty() || options.connections == 0) {
+        std::cerr << "Не задан сокет или число соединений\n";
+        return 2;
+    }
+
+    const std::string text = makeText(options);
+    std::vector<ConnectionResult> results(options.connections);
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (unsigned i = 0; i < options.connections; i++)
+        threads.emplace_back(runConnection, std::cref(options), std::cref(text), std::ref(results[i]));
+    for (auto& t : threads)
+        t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    bool failed = false;
+    for (const auto& r : results) {
+        latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+        errors += r.errors;
+        if (!r.failure.empty()) {
+            std::cerr << "[ОШИБКА] " << r.failure << "\n";
+            failed = true;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "Запросов: " << latencies.size() << ", ошибок: " << errors
+              << ", время: " << seconds << " с\n";
+    std::cout << "Запросов/с: " << (seconds > 0 ? latencies.size() / seconds : 0) << "\n";
+    std::cout << "Задержка, мкс: p50 " << percentile(latencies, 0.50)
+              << ", p99 " << percentile(latencies, 0.99)
+              << ", p999 " << percentile(latencies, 0.999) << "\n";
+    return failed || errors ? 1 : 0;
+}
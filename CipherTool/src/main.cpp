@@ -0,0 +1,439 @@
+/**
+ * @file main.cpp
+ * @brief Консольная утилита потокового шифрования
+ *
+ * @mainpage Cipher Tool
+ *
+ * ## Описание
+ *
+ * Утилита шифрует и дешифрует файлы и каналы (stdin/stdout) одним
+ * из двух шифров проекта: модифицированным алфавитным (alpha) или
+ * табличным маршрутным (route). Текст обрабатывается построчно:
+ * каждая строка - независимое сообщение, как в интерактивном режиме
+ * TableRoute, но через многопоточный конвейер.
+ *
+ * ## Использование
+ * ```
+ * cipher_tool -e|-d -c alpha|route -k КЛЮЧ [-p] [-C] [-E КОДИРОВКА] [-t ПОТОКИ] [-b БАЙТ] [-v] [вход [выход]]
+ * ```
+ * - `-e` / `-d` - шифрование / дешифрование
+ * - `-c` - шифр из реестра (LineCipher.h): `alpha` (ключ - слово) или
+ *   `route` (ключ - число столбцов); справка выводит все зарегистрированные
+ * - `-p` - режим Passthrough для alpha (небуквенные символы сохраняются)
+ * - `-C` - сохранение регистра для alpha (в обоих режимах)
+ * - `-E` - кодировка текста для alpha: `utf8` (по умолчанию), `cp1251`
+ *   или `koi8r`; ключ всегда задаётся в UTF-8
+ * - `-t` - число рабочих потоков
+ * - `-b` - размер блока чтения, байт
+ * - `-v` - вывести статистику в stderr (со счётчиками стадий шифров при сборке make STATS=1)
+ * - вход и выход по умолчанию - stdin и stdout (`-` - тоже stdin/stdout);
+ *   выход, совпадающий с входным файлом, не открывается (код 2)
+ *
+ * ## Пакетный режим
+ * ```
+ * cipher_tool -e|-d -c alpha|route -k КЛЮЧ -o КАТАЛОГ [-B auto|uring|threads|stdio] [-q ФАЙЛОВ] файл...
+ * ```
+ * Каждый файл шифруется в файл с тем же именем в каталоге `-o`; если
+ * выходной файл совпадает с входным или у двух входов одно имя, пакет
+ * не запускается (код 2).
+ * `-B` выбирает подсистему ввода-вывода (см. BatchIo.h): по умолчанию
+ * io_uring, а если он недоступен - пул потоков с pread/pwrite.
+ * `-q` задаёт число файлов в обработке на поток для io_uring, `-b` -
+ * размер буфера чтения на файл (он же предел длины строки).
+ *
+ * ## Контейнер
+ * ```
+ * cipher_tool -e -X -c alpha|route -k КЛЮЧ [-p] [-C] [-E КОДИРОВКА] [-b БАЙТ] [-v] вход выход
+ * cipher_tool -d -X -k КЛЮЧ [-R НАЧАЛО:ДЛИНА] [-t ПОТОКИ] [-v] вход [выход]
+ * ```
+ * `-X` шифрует вход целиком, как один поток, в контейнер с таблицей
+ * блоков (формат - в Container.h); `-b` - минимальный размер блока,
+ * вход `-` - stdin. Контейнер пишется во временный файл рядом с выходом
+ * и переименовывается в него; выход не может совпадать со входом
+ * (и при шифровании, и при дешифровании).
+ * Шифр, режим и кодировка записываются в заголовок, поэтому при
+ * дешифровании нужен только ключ. Контейнер дешифруется параллельно
+ * по блокам; `-R` выводит только блоки, содержащие байты
+ * [НАЧАЛО, НАЧАЛО + ДЛИНА) открытого текста.
+ *
+ * ## Коды возврата
+ * - 0 - успешно
+ * - 1 - в некоторых строках были ошибки (строки выведены пустыми)
+ * - 2 - ошибка параметров или ввода-вывода (в пакетном режиме - хотя бы одного файла)
+ *
+ * ## Демон шифрования
+ *
+ * `cipher_daemon` обслуживает запросы локальных процессов через
+ * Unix-сокет (протокол описан в Protocol.h, формат файла ключей -
+ * в KeyTable.h). `cipher_loadgen` измеряет его пропускную способность
+ * и задержки:
+ * ```
+ * cipher_daemon -s /tmp/cipher.sock -k keys.txt &
+ * cipher_loadgen -s /tmp/cipher.sock -k 1 -c 4 -n 10000 -w 16
+ * ```
+ */
+
+#include "BatchIo.h"
+#include "CipherStats.h"
+#include "Container.h"
+#include "LineCipher.h"
+#include "Pipeline.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Выводит справку по использованию
+ */
+void usage(const char* program)
+{
+    std::string ciphers;
+    for (const std::string& name : lineCipherNames())
+        ciphers += (ciphers.empty() ? "" : "|") + name;
+    std::cerr << "Использование: " << program
+              << " -e|-d -c " << ciphers << " -k КЛЮЧ [-p] [-C] [-E utf8|cp1251|koi8r] [-t ПОТОКИ] [-b БАЙТ] [-v]"
+                 " [вход [выход]]\n"
+              << "       " << program
+              << " -e|-d -c " << ciphers << " -k КЛЮЧ -o КАТАЛОГ [-B auto|uring|threads|stdio] [-q ФАЙЛОВ]"
+                 " [-p] [-C] [-E КОДИРОВКА] [-t ПОТОКИ] [-b БАЙТ] [-v] файл...\n"
+              << "       " << program
+              << " -e -X -c " << ciphers << " -k КЛЮЧ [-p] [-C] [-E КОДИРОВКА] [-b БАЙТ] [-v] вход выход\n"
+              << "       " << program << " -d -X -k КЛЮЧ [-R НАЧАЛО:ДЛИНА] [-t ПОТОКИ] [-v] вход [выход]\n";
+}
+
+/**
+ * @brief Разбирает диапазон открытого текста НАЧАЛО:ДЛИНА
+ * @return false, если строка не является диапазоном
+ */
+bool parseRange(const char* text, uint64_t& start, uint64_t& length)
+{
+    char* end = nullptr;
+    errno = 0;
+    start = std::strtoull(text, &end, 10);
+    if (end == text || *end != ':' || errno == ERANGE)
+        return false;
+    const char* second = end + 1;
+    length = std::strtoull(second, &end, 10);
+    return end != second && *end == '\0' && errno != ERANGE;
+}
+
+/**
+ * @brief Открывает файл или возвращает стандартный дескриптор для "-"
+ * @param input Для выхода - идентичность входного файла (openOutput)
+ * @throw std::runtime_error если файл не открывается или выход совпадает с входом
+ */
+int openFile(const char* path, bool output, const FileId& input = FileId())
+{
+    if (path == nullptr || std::strcmp(path, "-") == 0)
+        return output ? STDOUT_FILENO : STDIN_FILENO;
+    if (output)
+        return openOutput(path, input);
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string(path) + ": " + std::strerror(errno));
+    return fd;
+}
+
+/**
+ * @brief Ключ записи каталога: идентичность каталога и имя файла
+ *
+ * Каталог сравнивается по FileId, поэтому разные пути к одному каталогу
+ * (символические ссылки, "./", "..") дают один ключ - и для файла,
+ * которого ещё нет. Если каталога нет, ключом служит сам путь.
+ */
+std::pair<FileId, std::string> entryId(const std::string& path)
+{
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    FileId id = fileId(dir);
+    if (!id.valid())
+        return {id, path};
+    return {id, path.substr(slash == std::string::npos ? 0 : slash + 1)};
+}
+
+/**
+ * @brief Проверяет, что выходные файлы пакета не совпадают с входными и между собой
+ * @throw std::runtime_error если выход - один из входов или в один выход пишутся два входа
+ *
+ * Выход открывается с O_TRUNC, поэтому выход, совпавший с входом, был бы
+ * обнулён до чтения, а входы с одним именем из разных каталогов молча
+ * перезаписали бы друг друга. Файлы сравниваются по каталогу и имени
+ * (entryId), а существующие - ещё и по FileId (жёсткие ссылки).
+ */
+void checkBatchJobs(const std::vector<BatchJob>& jobs)
+{
+    std::set<FileId> inputs;
+    std::set<std::pair<FileId, std::string>> inputEntries, outputs;
+    for (const BatchJob& job : jobs) {
+        FileId id = fileId(job.input);
+        if (id.valid())
+            inputs.insert(id);
+        inputEntries.insert(entryId(job.input));
+    }
+    for (const BatchJob& job : jobs) {
+        std::pair<FileId, std::string> entry = entryId(job.output);
+        if (!outputs.insert(entry).second)
+            throw std::runtime_error(job.output + ": в один выходной файл пишутся несколько входов");
+        if (inputEntries.count(entry) || inputs.count(fileId(job.output)))
+            throw std::runtime_error(job.output + ": выходной файл совпадает с входным");
+    }
+}
+
+/**
+ * @brief Пакетный режим: шифрует файлы в каталог
+ * @return Код возврата
+ * @throw std::runtime_error если выходные файлы пересекаются с входными (checkBatchJobs)
+ */
+int runBatchMode(char** files, int count, const std::string& outDir, const CipherOptions& cipherOptions,
+                 const BatchOptions& options, bool verbose)
+{
+    std::vector<BatchJob> jobs;
+    jobs.reserve(count);
+    for (int i = 0; i < count; i++) {
+        std::string input = files[i];
+        size_t slash = input.rfind('/');
+        jobs.push_back(BatchJob{input, outDir + "/" + input.substr(slash == std::string::npos ? 0 : slash + 1)});
+    }
+    checkBatchJobs(jobs);
+
+    BatchStats stats = runBatch(jobs, [&] { return makeLineCipher(cipherOptions); }, options, std::cerr);
+    if (verbose) {
+        std::cerr << "Подсистема: " << backendName(stats.backend) << ", файлов: " << stats.files
+                  << ", с ошибками: " << stats.failed << "\n";
+        std::cerr << "Прочитано: " << stats.bytesIn << " байт, записано: " << stats.bytesOut
+                  << " байт, строк: " << stats.lines << ", ошибок: " << stats.errors << "\n";
+        std::cerr << "Время: " << stats.seconds << " с, "
+                  << (stats.seconds > 0 ? stats.files / stats.seconds : 0) << " файлов/с\n";
+        if (cipher_stats::enabled())
+            cipher_stats::report(std::cerr, cipher_stats::snapshot());
+    }
+    return stats.failed ? 2 : stats.errors ? 1 : 0;
+}
+
+/**
+ * @brief Выводит статистику контейнера
+ */
+void reportContainer(const PipelineStats& stats)
+{
+    std::cerr << "Прочитано: " << stats.bytesIn << " байт, записано: " << stats.bytesOut
+              << " байт, блоков: " << stats.chunks << ", с ошибками: " << stats.errors << "\n";
+    std::cerr << "Время: " << stats.seconds << " с, "
+              << (stats.seconds > 0 ? stats.bytesIn / stats.seconds / 1e6 : 0) << " МБ/с\n";
+    if (cipher_stats::enabled())
+        cipher_stats::report(std::cerr, cipher_stats::snapshot());
+}
+
+/**
+ * @brief Режим контейнера: шифрование в контейнер или дешифрование блоков
+ * @param input Входной файл (nullptr - stdin, только для шифрования)
+ * @param output Выходной файл (nullptr - stdout, только для дешифрования)
+ * @param range Диапазон открытого текста или nullptr - весь текст
+ * @return Код возврата
+ * @throw std::exception при ошибке параметров или ввода-вывода
+ */
+int runContainerMode(const char* input, const char* output, const char* range, CipherOptions cipherOptions,
+                     const PipelineOptions& options, bool verbose)
+{
+    if (!options.decrypt) {
+        if (output == nullptr || std::strcmp(output, "-") == 0)
+            throw std::runtime_error("Контейнер записывается только в файл");
+        std::unique_ptr<LineCipher> cipher = makeLineCipher(cipherOptions);
+        int in = openFile(input, false);
+        FileId inputId = fileId(in);
+        if (inputId.valid() && inputId == fileId(std::string(output))) {
+            if (in != STDIN_FILENO) ::close(in);
+            throw std::runtime_error(std::string(output) + ": контейнер нельзя записать во входной файл");
+        }
+
+        // Запись во временный файл рядом с выходом и rename: прежний
+        // выход остаётся целым до конца записи
+        std::string temporary = std::string(output) + ".XXXXXX";
+        int out = ::mkstemp(&temporary[0]);
+        if (out < 0) {
+            std::runtime_error e(temporary + ": " + std::strerror(errno));
+            if (in != STDIN_FILENO) ::close(in);
+            throw e;
+        }
+        // Права, как у файла из openFile (mkstemp создаёт 0600)
+        mode_t mask = ::umask(0);
+        ::umask(mask);
+        ::fchmod(out, 0644 & ~mask);
+        PipelineStats stats;
+        try {
+            stats = writeContainer(in, out, cipherOptions, *cipher, options, std::cerr);
+        } catch (...) {
+            ::close(out);
+            ::unlink(temporary.c_str());
+            if (in != STDIN_FILENO) ::close(in);
+            throw;
+        }
+        if (in != STDIN_FILENO) ::close(in);
+        bool written = ::fsync(out) == 0;
+        written = ::close(out) == 0 && written;
+        if (!written || ::rename(temporary.c_str(), output) != 0) {
+            std::runtime_error e(std::string("Ошибка записи: ") + std::strerror(errno));
+            ::unlink(temporary.c_str());
+            throw e;
+        }
+        if (verbose)
+            reportContainer(stats);
+        return stats.errors ? 1 : 0;
+    }
+
+    if (input == nullptr || std::strcmp(input, "-") == 0)
+        throw std::runtime_error("Контейнер читается только из файла");
+    ContainerReader reader(input);
+    std::string key = cipherOptions.key;
+    cipherOptions = reader.cipherOptions();
+    cipherOptions.key = key;
+    makeLineCipher(cipherOptions);
+
+    size_t first = 0, count = reader.chunks();
+    uint64_t start = 0, length = 0;
+    if (range) {
+        if (!parseRange(range, start, length))
+            throw std::runtime_error(std::string("Неверный диапазон: ") + range);
+        first = reader.findChunk(start);
+        count = length == 0 || first == reader.chunks() ? 0
+              : reader.findChunk(start + std::min(length, reader.sourceSize() - start) - 1) - first + 1;
+    }
+
+    // Контейнер отображён в память: обрезка его как выхода дала бы SIGBUS
+    int out = openFile(output, true, fileId(std::string(input)));
+    PipelineStats stats = readContainer(reader, first, count, out, [&] { return makeLineCipher(cipherOptions); },
+                                        options, std::cerr);
+    if (verbose)
+        reportContainer(stats);
+    if (out != STDOUT_FILENO && ::close(out) != 0)
+        throw std::runtime_error(std::string("Ошибка записи: ") + std::strerror(errno));
+    return stats.errors ? 1 : 0;
+}
+
+} // namespace
+
+/**
+ * @brief Главная функция программы
+ * @return Код возврата (см. описание утилиты)
+ */
+int main(int argc, char** argv)
+{
+    CipherOptions cipherOptions;
+    PipelineOptions pipelineOptions;
+    BatchOptions batchOptions;
+    std::string outDir;
+    const char* range = nullptr;
+    bool container = false;
+    bool modeSet = false;
+    bool verbose = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "edc:k:pCE:t:b:vo:B:q:XR:")) != -1) {
+        switch (opt) {
+        case 'e':
+        case 'd':
+            pipelineOptions.decrypt = opt == 'd';
+            modeSet = true;
+            break;
+        case 'c':
+            cipherOptions.cipher = optarg;
+            break;
+        case 'k':
+            cipherOptions.key = optarg;
+            break;
+        case 'p':
+            cipherOptions.passthrough = true;
+            break;
+        case 'C':
+            cipherOptions.preserveCase = true;
+            break;
+        case 'E':
+            cipherOptions.encoding = optarg;
+            break;
+        case 't':
+            pipelineOptions.workers = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+            batchOptions.workers = pipelineOptions.workers;
+            break;
+        case 'b':
+            pipelineOptions.chunkSize = std::strtoul(optarg, nullptr, 10);
+            batchOptions.bufferSize = pipelineOptions.chunkSize;
+            break;
+        case 'o':
+            outDir = optarg;
+            break;
+        case 'B':
+            if (!parseBackend(optarg, batchOptions.backend)) {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'q':
+            batchOptions.depth = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+            break;
+        case 'X':
+            container = true;
+            break;
+        case 'R':
+            range = optarg;
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!modeSet || (outDir.empty() ? argc - optind > 2 : optind == argc) || (container && !outDir.empty())
+        || (range && !container)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    try {
+        if (container)
+            return runContainerMode(optind < argc ? argv[optind] : nullptr,
+                                    optind + 1 < argc ? argv[optind + 1] : nullptr, range, cipherOptions,
+                                    pipelineOptions, verbose);
+
+        // Проверка ключа до запуска конвейера
+        makeLineCipher(cipherOptions);
+
+        if (!outDir.empty()) {
+            batchOptions.decrypt = pipelineOptions.decrypt;
+            return runBatchMode(argv + optind, argc - optind, outDir, cipherOptions, batchOptions, verbose);
+        }
+
+        int in = openFile(optind < argc ? argv[optind] : nullptr, false);
+        int out = openFile(optind + 1 < argc ? argv[optind + 1] : nullptr, true, fileId(in));
+
+        PipelineStats stats = runPipeline(in, out, [&] { return makeLineCipher(cipherOptions); },
+                                          pipelineOptions, std::cerr);
+        if (verbose) {
+            std::cerr << "Прочитано: " << stats.bytesIn << " байт, записано: " << stats.bytesOut
+                      << " байт, строк: " << stats.lines << ", блоков: " << stats.chunks
+                      << ", ошибок: " << stats.errors << "\n";
+            std::cerr << "Время: " << stats.seconds << " с, "
+                      << (stats.seconds > 0 ? stats.bytesIn / stats.seconds / 1e6 : 0) << " МБ/с\n";
+            if (cipher_stats::enabled())
+                cipher_stats::report(std::cerr, cipher_stats::snapshot());
+        }
+        if (in != STDIN_FILENO) ::close(in);
+        if (out != STDOUT_FILENO && ::close(out) != 0)
+            throw std::runtime_error(std::string("Ошибка записи: ") + std::strerror(errno));
+        return stats.errors ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "[ОШИБКА] " << e.what() << std::endl;
+        return 2;
+    }
+}
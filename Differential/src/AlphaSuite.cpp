@@ -0,0 +1,424 @@
+/**
+ * @file AlphaSuite.cpp
+ * @brief Сравнение modAlphaCipher с эталонной реализацией
+ *
+ * @details
+ * Проверяются конструктор (включая тексты исключений), tryEncrypt/tryDecrypt,
+ * бросающие encrypt/decrypt и преобразования на месте в обоих режимах,
+ * с сохранением регистра и без, для std::wstring и для байтовых
+ * кодировок CP1251, KOI8-R и UTF-8 (эталон получает декодированный текст). Дешифруются корректные шифротексты,
+ * шифротексты с испорченным символом и произвольные строки.
+ *
+ * Дешифрование окна (tryDecryptRange) сравнивается с частью полного
+ * эталонного дешифрования; случайный индекс передаётся в половине случаев.
+ * Окно UTF-8, разрезающее букву, - ошибка InvalidRange. Произвольные
+ * байты (и неверный UTF-8) в режиме Passthrough проверяются круговым путём.
+ */
+
+#include "Harness.h"
+#include "reference/AlphaReference.h"
+#include "modAlphaCipher.h"
+#include <algorithm>
+#include <codecvt>
+#include <locale>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace harness {
+
+namespace {
+
+const wchar_t UPPER[] = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+const wchar_t LOWER[] = L"абвгдеёжзийклмнопрстуфхцчшщъыьэюя";
+const wchar_t ASCII[] = L"ABCXYZabcxyz0123456789 .,;:!?-\t\r\"'()";
+
+/// Коды на границах диапазонов, проверяемых быстрыми путями
+const wchar_t BOUNDARY[] = {
+    L'А' - 1, L'А', L'Я', L'Я' + 1, L'а' - 1, L'а', L'я', L'я' + 1,
+    L'Ё' - 1, L'Ё', L'Ё' + 1, L'ё' - 1, L'ё', L'ё' + 1, 0x400, 0x40F, 0x45F, 0x460,
+    0x0, 0x7F, 0x80, 0xFF, 0x100, 0x7FF, 0x800, 0xFFFD, 0xFFFF, 0x10000, 0x10FFFF
+};
+
+/// Коды вне Unicode (суррогаты, за 0x10FFFF, отрицательные wchar_t)
+const uint32_t NON_UNICODE[] = {
+    0xD800, 0xDBFF, 0xDC00, 0xDFFF, 0x110000, 0x7FFFFFFF, 0x80000410, 0x80000401, 0xFFFFFFFF
+};
+
+wchar_t pick(Rng& rng, const wchar_t* set, size_t count)
+{
+    return set[uniform(rng, 0, static_cast<long long>(count) - 1)];
+}
+
+/**
+ * @brief Случайный символ из выбранного "алфавита"
+ */
+wchar_t randomChar(Rng& rng, int alphabet, bool unicode)
+{
+    switch (alphabet) {
+    case 0: return pick(rng, UPPER, 33);
+    case 1: return pick(rng, LOWER, 33);
+    case 2: return pick(rng, ASCII, sizeof(ASCII) / sizeof(wchar_t) - 1);
+    case 3: return pick(rng, BOUNDARY, sizeof(BOUNDARY) / sizeof(wchar_t));
+    case 4: {
+        wchar_t c = static_cast<wchar_t>(uniform(rng, 1, 0xFFFF));
+        return (c >= 0xD800 && c <= 0xDFFF) ? L'?' : c;
+    }
+    default:
+        if (unicode)
+            return static_cast<wchar_t>(uniform(rng, 0x10000, 0x10FFFF));
+        return static_cast<wchar_t>(NON_UNICODE[uniform(rng, 0, sizeof(NON_UNICODE) / sizeof(uint32_t) - 1)]);
+    }
+}
+
+/**
+ * @brief Сравнивает преобразование на месте с эталоном
+ */
+template <class Text, class Want>
+bool sameInPlace(modAlphaCipher::Error got, const Text& text, bool passthrough,
+                 const Want& want, const char* what, std::string& mismatch)
+{
+    std::string expected = passthrough ? want.error : "Unsupported text mode";
+    std::string error = got == modAlphaCipher::Error::None ? "" : modAlphaCipher::errorMessage(got);
+    if (error != expected || (error.empty() && text != want.text)) {
+        mismatch = std::string(what) + ": got {" + quote(error) + ", " + escape(text) + "}, want {"
+                   + quote(expected) + ", " + escape(want.text) + "}";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Сравнивает дешифрование случайного окна с частью полного дешифрования
+ * @param closed Шифротекст
+ * @param want Эталонное дешифрование всего шифротекста
+ * @param tryRange Вызов tryDecryptRange(closed, offset, length, index)
+ * @param build Вызов buildSeekIndex(closed, stride)
+ * @param inside Смещения, разрезающие букву UTF-8 (размер closed.size() + 1), или nullptr
+ *
+ * Окно из корректного шифротекста - часть эталонного результата; окно,
+ * содержащее первый недопустимый символ, даёт ту же ошибку и позицию.
+ * Окно после первого недопустимого символа не проверяется: эталон не
+ * знает, есть ли в нём другие.
+ */
+template <class Text, class Want, class TryRange, class Build>
+bool sameRange(Rng& rng, const Text& closed, const Want& want, TryRange tryRange, Build build,
+               std::string& mismatch, const std::vector<bool>* inside = nullptr)
+{
+    size_t offset = static_cast<size_t>(uniform(rng, 0, static_cast<long long>(closed.size())));
+    size_t length = oneIn(rng, 16) ? static_cast<size_t>(-1) : static_cast<size_t>(uniform(rng, 0, 300));
+    bool indexed = oneIn(rng, 2);
+    modAlphaCipher::SeekIndex index;
+    if (indexed)
+        index = build(static_cast<size_t>(oneIn(rng, 4) ? uniform(rng, 1, 8) : uniform(rng, 1, 4096)));
+
+    Want expected = want;
+    size_t end = offset + std::min(length, closed.size() - offset);
+    if (closed.empty()) {
+        expected.error = "Empty cipher text";
+    } else if (offset == closed.size() || length == 0 || (inside && ((*inside)[offset] || (*inside)[end]))) {
+        expected.error = "Invalid range";
+        expected.position = decltype(want.position)(-1);
+    } else if (!want.error.empty()) {
+        if (want.position < offset || want.position >= end)
+            return true;
+    } else {
+        expected.text = want.text.substr(offset, end - offset);
+    }
+    if (!expected.error.empty())
+        expected.text.clear();
+
+    if (!sameOutcome(tryRange(offset, length, indexed ? &index : nullptr), expected, modAlphaCipher::errorMessage,
+                     "tryDecryptRange", mismatch)) {
+        std::ostringstream out;
+        out << "offset " << offset << " length " << static_cast<long long>(length);
+        if (indexed)
+            out << " stride " << index.stride;
+        mismatch = out.str() + " " + mismatch;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Сравнивает байтовые методы с эталоном на декодированном тексте
+ */
+bool sameBytes(Rng& rng, modAlphaCipher& cipher, const reference::AlphaReference& ref, bool passthrough,
+               std::string& mismatch)
+{
+    bool koi8r = oneIn(rng, 2);
+    modAlphaCipher::Encoding encoding = koi8r ? modAlphaCipher::Encoding::KOI8R
+                                              : modAlphaCipher::Encoding::CP1251;
+    const char* name = koi8r ? "koi8r " : "cp1251 ";
+
+    std::string open = randomSingleByteText(rng, randomLength(rng, 4096));
+    reference::ByteOutcome want(ref.encrypt(reference::decodeSingleByte(open, koi8r)), koi8r);
+    std::string inPlace = open;
+    if (!sameOutcome(cipher.tryEncrypt(open, encoding), want, modAlphaCipher::errorMessage,
+                     "tryEncrypt(bytes)", mismatch)
+        || !sameThrowing([&] { return cipher.encrypt(open, encoding); }, want, "encrypt(bytes)", mismatch)
+        || !sameInPlace(cipher.encryptInPlace(inPlace, encoding), inPlace, passthrough, want,
+                        "encryptInPlace(bytes)", mismatch)) {
+        mismatch = name + escape(open) + ": " + mismatch;
+        return false;
+    }
+
+    std::string closed = pickCipherText(rng, want.text, want.error.empty(),
+        [&] { return static_cast<char>(uniform(rng, 0, 255)); },
+        [&] { return randomSingleByteText(rng, randomLength(rng, 4096)); });
+    reference::ByteOutcome plain(ref.decrypt(reference::decodeSingleByte(closed, koi8r)), koi8r);
+    inPlace = closed;
+    if (!sameOutcome(cipher.tryDecrypt(closed, encoding), plain, modAlphaCipher::errorMessage,
+                     "tryDecrypt(bytes)", mismatch)
+        || !sameThrowing([&] { return cipher.decrypt(closed, encoding); }, plain, "decrypt(bytes)", mismatch)
+        || !sameInPlace(cipher.decryptInPlace(inPlace, encoding), inPlace, passthrough, plain,
+                        "decryptInPlace(bytes)", mismatch)
+        || !sameRange(rng, closed, plain,
+                      [&](size_t offset, size_t length, const modAlphaCipher::SeekIndex* index) {
+                          return cipher.tryDecryptRange(closed, encoding, offset, length, index);
+                      },
+                      [&](size_t stride) { return modAlphaCipher::buildSeekIndex(closed, encoding, stride); },
+                      mismatch)) {
+        mismatch = name + escape(closed) + ": " + mismatch;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @struct Utf8Outcome
+ * @brief Эталонный результат в UTF-8: позиция недопустимого символа - в байтах
+ */
+struct Utf8Outcome {
+    std::string text;
+    std::string error;
+    size_t position;
+
+    Utf8Outcome(const reference::AlphaOutcome& r, const std::wstring& input) :
+        text(r.error.empty() ? toUtf8(r.text) : std::string()), error(r.error),
+        position(r.position == std::wstring::npos ? std::string::npos : toUtf8(input.substr(0, r.position)).size()) {}
+};
+
+/**
+ * @brief Сравнивает методы UTF-8 с эталоном на широком тексте
+ */
+bool sameUtf8(Rng& rng, modAlphaCipher& cipher, const reference::AlphaReference& ref, bool passthrough,
+              bool preserveCase, std::string& mismatch)
+{
+    const modAlphaCipher::Encoding encoding = modAlphaCipher::Encoding::UTF8;
+    std::wstring wide = randomWideText(rng, randomLength(rng, 4096), true);
+    std::string open = toUtf8(wide);
+    reference::AlphaOutcome encrypted = ref.encrypt(wide);
+    Utf8Outcome want(encrypted, wide);
+    std::string inPlace = open;
+    if (!sameOutcome(cipher.tryEncrypt(open, encoding), want, modAlphaCipher::errorMessage,
+                     "tryEncrypt(utf8)", mismatch)
+        || !sameThrowing([&] { return cipher.encrypt(open, encoding); }, want, "encrypt(utf8)", mismatch)
+        || !sameInPlace(cipher.encryptInPlace(inPlace, encoding), inPlace, passthrough, want,
+                        "encryptInPlace(utf8)", mismatch)) {
+        mismatch = "utf8 " + escape(open) + ": " + mismatch;
+        return false;
+    }
+
+    std::wstring closedWide = pickCipherText(rng, encrypted.text, encrypted.error.empty(),
+        [&] { return randomChar(rng, 3, true); },
+        [&] { return randomWideText(rng, randomLength(rng, 4096), true); });
+    std::string closed = toUtf8(closedWide);
+    Utf8Outcome plain(ref.decrypt(closedWide), closedWide);
+    // Смещения вторых байтов букв
+    std::vector<bool> inside(closed.size() + 1);
+    for (size_t i = 0, at = 0; i < closedWide.size(); at += toUtf8(closedWide.substr(i, 1)).size(), i++) {
+        wchar_t c = closedWide[i];
+        if ((c >= L'А' && c <= L'я') || c == L'Ё' || c == L'ё')
+            inside[at + 1] = true;
+    }
+    inPlace = closed;
+    if (!sameOutcome(cipher.tryDecrypt(closed, encoding), plain, modAlphaCipher::errorMessage,
+                     "tryDecrypt(utf8)", mismatch)
+        || !sameThrowing([&] { return cipher.decrypt(closed, encoding); }, plain, "decrypt(utf8)", mismatch)
+        || !sameInPlace(cipher.decryptInPlace(inPlace, encoding), inPlace, passthrough, plain,
+                        "decryptInPlace(utf8)", mismatch)
+        || !sameRange(rng, closed, plain,
+                      [&](size_t offset, size_t length, const modAlphaCipher::SeekIndex* index) {
+                          return cipher.tryDecryptRange(closed, encoding, offset, length, index);
+                      },
+                      [&](size_t stride) { return modAlphaCipher::buildSeekIndex(closed, encoding, stride); },
+                      mismatch, &inside)) {
+        mismatch = "utf8 " + escape(closed) + ": " + mismatch;
+        return false;
+    }
+
+    // Произвольные байты: Passthrough с сохранением регистра не меняет
+    // длину, а дешифрование возвращает их
+    if (passthrough && preserveCase && !open.empty()) {
+        std::string bytes = open;
+        for (long long i = uniform(rng, 1, 8); i > 0; i--)
+            bytes[uniform(rng, 0, static_cast<long long>(bytes.size()) - 1)] =
+                static_cast<char>(uniform(rng, 0, 255));
+        std::string round = bytes;
+        cipher.encryptInPlace(round, encoding);
+        std::string once = round;
+        cipher.decryptInPlace(round, encoding);
+        if (round != bytes || once.size() != bytes.size()) {
+            mismatch = "utf8 bytes " + escape(bytes) + ": round trip got " + escape(round);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::string toUtf8(const std::wstring& text)
+{
+    return std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(text);
+}
+
+std::wstring randomKey(Rng& rng)
+{
+    std::wstring key;
+    switch (uniform(rng, 0, 15)) {
+    case 0:
+        return key;
+    case 1: {
+        wchar_t c = randomChar(rng, static_cast<int>(uniform(rng, 0, 1)), true);
+        return std::wstring(static_cast<size_t>(uniform(rng, 1, 6)), c);
+    }
+    case 2:
+        key = randomWideText(rng, static_cast<size_t>(uniform(rng, 1, 8)), true);
+        break;
+    default: {
+        // 1..16, 32 и 64 - ядра с фиксированной длиной ключа, остальные - обобщённые
+        size_t length = static_cast<size_t>(oneIn(rng, 8) ? uniform(rng, 1, 300)
+                                            : oneIn(rng, 8) ? 32 << uniform(rng, 0, 1) : uniform(rng, 1, 16));
+        for (size_t i = 0; i < length; i++)
+            key += randomChar(rng, static_cast<int>(uniform(rng, 0, 1)), true);
+    }
+    }
+    return key;
+}
+
+std::string randomSingleByteText(Rng& rng, size_t length)
+{
+    const unsigned char yo[] = {0xA8, 0xB8, 0xB3, 0xA3};
+    std::string text;
+    long long letters = uniform(rng, 0, 100);
+    for (size_t i = 0; i < length; i++) {
+        long long r = uniform(rng, 0, 99);
+        unsigned char b;
+        if (r < letters)
+            b = static_cast<unsigned char>(uniform(rng, 0xC0, 0xFF));
+        else if (r % 3 == 0)
+            b = yo[uniform(rng, 0, 3)];
+        else if (r % 3 == 1)
+            b = static_cast<unsigned char>(uniform(rng, 0x00, 0x7F));
+        else
+            b = static_cast<unsigned char>(uniform(rng, 0x80, 0xFF));
+        text += static_cast<char>(b);
+    }
+    return text;
+}
+
+std::wstring randomWideText(Rng& rng, size_t length, bool unicode)
+{
+    std::wstring text;
+    text.reserve(length);
+    // Половина текстов из одного алфавита, остальные - смесь
+    int single = oneIn(rng, 2) ? static_cast<int>(uniform(rng, 0, 5)) : -1;
+    for (size_t i = 0; i < length; i++) {
+        int alphabet = single;
+        if (alphabet < 0) {
+            long long r = uniform(rng, 0, 99);
+            alphabet = r < 35 ? 0 : r < 60 ? 1 : r < 80 ? 2 : r < 90 ? 3 : r < 97 ? 4 : 5;
+        }
+        text += randomChar(rng, alphabet, unicode);
+    }
+    return text;
+}
+
+bool alphaCase(Rng& rng, std::string& mismatch)
+{
+    std::wstring key = randomKey(rng);
+    bool passthrough = oneIn(rng, 2);
+    bool preserveCase = oneIn(rng, 2);
+    modAlphaCipher::TextMode mode = passthrough ? modAlphaCipher::TextMode::Passthrough
+                                                : modAlphaCipher::TextMode::Filter;
+
+    std::unique_ptr<reference::AlphaReference> ref;
+    std::unique_ptr<modAlphaCipher> cipher;
+    std::string refError, error;
+    try {
+        ref.reset(new reference::AlphaReference(key, passthrough, preserveCase));
+    } catch (const std::invalid_argument& e) {
+        refError = e.what();
+    }
+    try {
+        cipher.reset(new modAlphaCipher(key, mode, preserveCase));
+    } catch (const cipher_error& e) {
+        error = e.what();
+    }
+    std::string context = "key " + escape(key) + (passthrough ? " passthrough" : " filter")
+                          + (preserveCase ? " preserveCase" : "");
+    if (error != refError) {
+        mismatch = context + ": constructor got " + quote(error) + ", want " + quote(refError);
+        return false;
+    }
+    if (!ref)
+        return true;
+
+    // Шифрование
+    std::wstring open = randomWideText(rng, randomLength(rng, 4096), false);
+    reference::AlphaOutcome want = ref->encrypt(open);
+    std::wstring inPlace = open;
+    if (!sameOutcome(cipher->tryEncrypt(open), want, modAlphaCipher::errorMessage, "tryEncrypt", mismatch)
+        || !sameThrowing([&] { return cipher->encrypt(open); }, want, "encrypt", mismatch)
+        || !sameInPlace(cipher->encryptInPlace(inPlace), inPlace, passthrough, want, "encryptInPlace", mismatch)) {
+        mismatch = context + " text " + escape(open) + ": " + mismatch;
+        return false;
+    }
+
+    // Дешифрование: корректный шифротекст, испорченный шифротекст или произвольная строка
+    std::wstring closed;
+    long long kind = uniform(rng, 0, 3);
+    bool valid = kind == 0 && want.error.empty();
+    if (kind < 2 && want.error.empty()) {
+        closed = want.text;
+        if (kind == 1 && !closed.empty())
+            closed[uniform(rng, 0, static_cast<long long>(closed.size()) - 1)] = randomChar(rng, 3, false);
+    } else {
+        closed = randomWideText(rng, randomLength(rng, 4096), false);
+    }
+    want = ref->decrypt(closed);
+    inPlace = closed;
+    if (!sameOutcome(cipher->tryDecrypt(closed), want, modAlphaCipher::errorMessage, "tryDecrypt", mismatch)
+        || !sameThrowing([&] { return cipher->decrypt(closed); }, want, "decrypt", mismatch)
+        || !sameInPlace(cipher->decryptInPlace(inPlace), inPlace, passthrough, want, "decryptInPlace", mismatch)
+        || !sameRange(rng, closed, want,
+                      [&](size_t offset, size_t length, const modAlphaCipher::SeekIndex* index) {
+                          return cipher->tryDecryptRange(closed, offset, length, index);
+                      },
+                      [&](size_t stride) { return modAlphaCipher::buildSeekIndex(closed, stride); },
+                      mismatch)) {
+        mismatch = context + " text " + escape(closed) + ": " + mismatch;
+        return false;
+    }
+
+    // Однобайтовые кодировки и UTF-8
+    if (!sameBytes(rng, *cipher, *ref, passthrough, mismatch)
+        || !sameUtf8(rng, *cipher, *ref, passthrough, preserveCase, mismatch)) {
+        mismatch = context + " " + mismatch;
+        return false;
+    }
+
+    // Круговой путь для корректного шифротекста
+    if (valid) {
+        reference::AlphaOutcome open2 = ref->encrypt(want.text);
+        if (open2.text != closed) {
+            mismatch = context + " text " + escape(open) + ": reference round trip broken";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace harness
@@ -0,0 +1,208 @@
+/**
+ * @file Harness.h
+ * @brief Общие средства дифференциального тестирования
+ *
+ * @details
+ * Каждый набор (suite) проверяет один случай за вызов: генерирует
+ * случайные ключ и текст, прогоняет их через эталон и через рабочую
+ * реализацию и сравнивает результаты, тексты ошибок и позиции.
+ * Генератор случая создаётся из (seed, набор, номер итерации), поэтому
+ * любое расхождение воспроизводится по одной итерации.
+ */
+
+#pragma once
+#include "CipherError.h"
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace harness {
+
+/// Генератор случайных чисел одного случая
+typedef std::mt19937_64 Rng;
+
+/**
+ * @brief Равномерное целое в [lo, hi]
+ */
+inline long long uniform(Rng& rng, long long lo, long long hi)
+{
+    return std::uniform_int_distribution<long long>(lo, hi)(rng);
+}
+
+/**
+ * @brief Истина с вероятностью 1/n
+ */
+inline bool oneIn(Rng& rng, unsigned n)
+{
+    return uniform(rng, 0, n - 1) == 0;
+}
+
+/**
+ * @brief Длина текста: обычно короткая, изредка до max
+ */
+inline size_t randomLength(Rng& rng, size_t max)
+{
+    if (oneIn(rng, 16))
+        return static_cast<size_t>(uniform(rng, 0, static_cast<long long>(max)));
+    return static_cast<size_t>(uniform(rng, 0, 64));
+}
+
+/**
+ * @brief Печатное представление строки для отчёта о расхождении
+ *
+ * ASCII выводится как есть, остальные символы - как \\u{XXXX}.
+ * Вывод ограничен limit символами.
+ */
+template <class String>
+std::string escape(const String& s, size_t limit = 80)
+{
+    std::ostringstream out;
+    out << '"';
+    for (size_t i = 0; i < s.size() && i < limit; i++) {
+        uint32_t c = static_cast<uint32_t>(s[i]);
+        if (sizeof(s[i]) == 1)
+            c &= 0xFF;
+        if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\')
+            out << static_cast<char>(c);
+        else
+            out << "\\u{" << std::hex << c << std::dec << '}';
+    }
+    if (s.size() > limit)
+        out << "...(" << s.size() << ")";
+    out << '"';
+    return out.str();
+}
+
+/**
+ * @brief Сообщение об ошибке в кавычках (UTF-8 выводится как есть)
+ */
+inline std::string quote(const std::string& s)
+{
+    return '"' + s + '"';
+}
+
+/**
+ * @brief Сравнивает результат try-метода с эталоном
+ * @param got Result рабочей реализации (error, position, text)
+ * @param want Эталонный исход (error - текст ошибки, position, text)
+ * @param errorMessage Текст ошибки по коду got.error (Cipher::errorMessage)
+ * @param what Имя метода для отчёта
+ */
+template <class Got, class Want, class Message>
+bool sameOutcome(const Got& got, const Want& want, Message errorMessage, const char* what, std::string& mismatch)
+{
+    std::string error = got ? "" : errorMessage(got.error);
+    if (error != want.error || got.position != want.position || (error.empty() && got.text != want.text)) {
+        std::ostringstream out;
+        out << what << ": got {" << quote(error) << ", pos " << static_cast<long long>(got.position)
+            << ", " << escape(got.text) << "}, want {" << quote(want.error) << ", pos "
+            << static_cast<long long>(want.position) << ", " << escape(want.text) << "}";
+        mismatch = out.str();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Сравнивает бросающий метод с эталоном
+ * @param call Вызов метода; cipher_error перехватывается как текст ошибки
+ */
+template <class Call, class Want>
+bool sameThrowing(Call call, const Want& want, const char* what, std::string& mismatch)
+{
+    decltype(want.text) text;
+    std::string error;
+    try {
+        text = call();
+    } catch (const cipher_error& e) {
+        error = e.what();
+    }
+    if (error != want.error || (error.empty() && text != want.text)) {
+        mismatch = std::string(what) + ": got {" + quote(error) + ", " + escape(text) + "}, want {"
+                   + quote(want.error) + ", " + escape(want.text) + "}";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Шифротекст для проверки: корректный, испорченный или произвольный
+ * @param valid Шифротекст корректного шифрования
+ * @param validOk Шифрование прошло без ошибки (иначе valid не используется)
+ * @param corrupt Случайный символ для порчи одной позиции
+ * @param random Произвольный текст
+ */
+template <class Text, class Corrupt, class Random>
+Text pickCipherText(Rng& rng, const Text& valid, bool validOk, Corrupt corrupt, Random random)
+{
+    long long kind = uniform(rng, 0, 3);
+    if (kind < 2 && validOk) {
+        Text closed = valid;
+        if (kind == 1 && !closed.empty())
+            closed[uniform(rng, 0, static_cast<long long>(closed.size()) - 1)] = corrupt();
+        return closed;
+    }
+    return random();
+}
+
+/**
+ * @brief Случайный текст для modAlphaCipher
+ * @param length Длина в символах
+ * @param unicode Только скалярные значения Unicode (для UTF-8)
+ *
+ * Символы берутся из нескольких "алфавитов": прописные и строчные
+ * русские буквы, латиница, цифры и знаки, граничные коды вокруг
+ * диапазонов А-Я, а-я, Ё, ё и произвольные коды.
+ */
+std::wstring randomWideText(Rng& rng, size_t length, bool unicode);
+
+/**
+ * @brief Текст в UTF-8
+ */
+std::string toUtf8(const std::wstring& text);
+
+/**
+ * @brief Случайный однобайтовый текст для TableRouteCipher
+ * @param length Длина в байтах
+ * @param newlines Допускать символ '\\n'
+ */
+std::string randomByteText(Rng& rng, size_t length, bool newlines);
+
+/**
+ * @brief Случайный ключ modAlphaCipher: корректный, с недопустимым
+ *        символом, пустой или слабый
+ */
+std::wstring randomKey(Rng& rng);
+
+/**
+ * @brief Случайный текст CP1251/KOI8-R: в основном буквы 0xC0-0xFF, Ё, ё и ASCII
+ * @param length Длина в байтах
+ */
+std::string randomSingleByteText(Rng& rng, size_t length);
+
+/**
+ * @brief Временный каталог процесса для файлов случаев
+ *
+ * Создаётся при первом вызове и удаляется при выходе; случаи удаляют
+ * свои файлы сами.
+ */
+const std::string& workDir();
+
+/**
+ * @brief Проверка одного случая
+ * @param rng Генератор случая
+ * @param mismatch Описание расхождения (заполняется при ошибке)
+ * @return true, если реализации совпали
+ */
+typedef bool (*CaseFunction)(Rng& rng, std::string& mismatch);
+
+bool alphaCase(Rng& rng, std::string& mismatch);     ///< modAlphaCipher против эталона
+bool routeCase(Rng& rng, std::string& mismatch);     ///< TableRouteCipher против эталона
+bool pipelineCase(Rng& rng, std::string& mismatch);  ///< runPipeline против построчного эталона
+bool batchCase(Rng& rng, std::string& mismatch);     ///< runBatch против построчного эталона
+bool productCase(Rng& rng, std::string& mismatch);   ///< ProductCipher против композиции эталонов
+bool sharedCase(Rng& rng, std::string& mismatch);    ///< Общие экземпляры шифров из многих потоков
+bool keyStoreCase(Rng& rng, std::string& mismatch);  ///< KeyStore против шифров из параметров ключа
+
+} // namespace harness
@@ -0,0 +1,264 @@
+/**
+ * @file KeyStoreSuite.cpp
+ * @brief Сравнение шифров из KeyStore с шифрами из параметров ключа
+ *
+ * @details
+ * Случай строит случайную таблицу ключей alpha и route со случайными
+ * id, записывает хранилище (writeKeyStore) и сравнивает адаптеры
+ * makeLineCipher(TenantCipher) с makeLineCipher(CipherOptions) на
+ * случайных строках UTF-8; отсутствующие id не должны находиться.
+ * Затем хранилище перезаписывается другой таблицей: reload() загружает
+ * её один раз, а шифры, полученные до перезагрузки, продолжают работать
+ * со старыми ключами. Текстовый файл ключей открывается тем же классом.
+ * Наконец, испорченный или обрезанный образ должен давать исключение,
+ * а не чтение за границей отображения (проверяется под make sanitize).
+ */
+
+#include "Harness.h"
+#include "KeyStore.h"
+#include <algorithm>
+#include <cstdint>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <unistd.h>
+#include <vector>
+
+namespace harness {
+
+namespace {
+
+/**
+ * @brief Случайная таблица ключей
+ *
+ * id - из узкого диапазона (больше коллизий хеша) или произвольные.
+ */
+KeyTable randomTable(Rng& rng)
+{
+    KeyTable table;
+    size_t count = static_cast<size_t>(oneIn(rng, 8) ? uniform(rng, 0, 2) : uniform(rng, 1, 64));
+    bool dense = oneIn(rng, 2);
+    while (table.size() < count) {
+        uint32_t id = static_cast<uint32_t>(dense ? uniform(rng, 0, 200) : uniform(rng, 0, UINT32_MAX));
+        CipherOptions options;
+        options.passthrough = oneIn(rng, 2);
+        options.preserveCase = oneIn(rng, 2);
+        if (oneIn(rng, 3)) {
+            options.cipher = "route";
+            options.key = std::to_string(uniform(rng, 1, 64));
+        } else {
+            std::wstring key = randomKey(rng);
+            try {
+                modAlphaCipher check(key);
+            } catch (const cipher_error&) {
+                continue;
+            }
+            options.cipher = "alpha";
+            options.key = toUtf8(key);
+        }
+        table[id] = options;
+    }
+    return table;
+}
+
+/**
+ * @brief Записывает таблицу текстовым файлом ключей (KeyTable.h)
+ */
+void writeKeyTable(const KeyTable& table, const std::string& path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    file << "# id шифр ключ [флаги]\n";
+    for (const auto& entry : table)
+        file << entry.first << ' ' << entry.second.cipher << ' ' << entry.second.key
+             << (entry.second.passthrough ? " passthrough" : "") << (entry.second.preserveCase ? " case" : "") << '\n';
+    if (!file)
+        throw std::runtime_error("cannot write " + path);
+}
+
+/**
+ * @brief Записывает байты в файл как есть
+ */
+void writeBytes(const std::string& bytes, const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!file)
+        throw std::runtime_error("cannot write " + path);
+}
+
+/**
+ * @brief Результат encrypt или decrypt одной строкой
+ */
+std::string transform(LineCipher& cipher, const std::string& line, bool decrypt)
+{
+    std::string out, error;
+    bool ok = decrypt ? cipher.decrypt(line, out, error) : cipher.encrypt(line, out, error);
+    return ok ? "+" + out : "!" + error;
+}
+
+/**
+ * @brief Сравнивает шифр из хранилища с шифром из параметров ключа
+ * @param lines Строк на каждое направление
+ */
+bool sameCipher(Rng& rng, const TenantCipher& tenant, const CipherOptions& options, size_t lines,
+                std::string& mismatch)
+{
+    std::unique_ptr<LineCipher> stored = makeLineCipher(tenant);
+    std::unique_ptr<LineCipher> expected = makeLineCipher(options);
+    for (size_t i = 0; i < lines; i++) {
+        std::string open = toUtf8(randomWideText(rng, randomLength(rng, 256), true));
+        std::string closed = transform(*expected, open, false);
+        // Шифротекст корректного шифрования или произвольная строка
+        std::string input = closed[0] == '+' && !oneIn(rng, 4) ? closed.substr(1) : open;
+        for (bool decrypt : {false, true}) {
+            const std::string& line = decrypt ? input : open;
+            std::string got = transform(*stored, line, decrypt);
+            std::string want = transform(*expected, line, decrypt);
+            if (got != want) {
+                mismatch = options.cipher + " key " + escape(options.key, 40)
+                           + (options.passthrough ? " passthrough" : "") + (options.preserveCase ? " case" : "")
+                           + (decrypt ? " decrypt " : " encrypt ") + escape(line) + ": got " + escape(got)
+                           + ", want " + escape(want);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Все ключи таблицы находятся и совпадают, отсутствующие id - нет
+ */
+bool sameTable(Rng& rng, const KeyStore& store, const KeyTable& table, std::string& mismatch)
+{
+    if (store.size() != table.size()) {
+        mismatch = "size " + std::to_string(store.size()) + ", want " + std::to_string(table.size());
+        return false;
+    }
+    TenantCipher tenant;
+    for (const auto& entry : table) {
+        if (!store.lookup(entry.first, tenant) || tenant.cipher != entry.second.cipher) {
+            mismatch = "id " + std::to_string(entry.first) + " not found as " + entry.second.cipher;
+            return false;
+        }
+        if (!sameCipher(rng, tenant, entry.second, 2, mismatch)) {
+            mismatch = "id " + std::to_string(entry.first) + ": " + mismatch;
+            return false;
+        }
+    }
+    for (int i = 0; i < 16; i++) {
+        uint32_t id = static_cast<uint32_t>(oneIn(rng, 2) ? uniform(rng, 0, 200) : uniform(rng, 0, UINT32_MAX));
+        if (!table.count(id) && store.lookup(id, tenant)) {
+            mismatch = "missing id " + std::to_string(id) + " found";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Испорченный образ: исключение или корректные ответы, но не сбой
+ */
+void corruptImage(Rng& rng, std::string image, const KeyTable& table, const std::string& path)
+{
+    if (oneIn(rng, 2)) {
+        image.resize(static_cast<size_t>(uniform(rng, 0, static_cast<long long>(image.size()))));
+    } else {
+        size_t flips = static_cast<size_t>(uniform(rng, 1, 8));
+        for (size_t i = 0; i < flips; i++) {
+            // Чаще портится заголовок и таблица ячеек, а не индексы ключей
+            size_t limit = oneIn(rng, 2) ? std::min<size_t>(image.size(), 16 + 12 * 8) : image.size();
+            image[static_cast<size_t>(uniform(rng, 0, static_cast<long long>(limit) - 1))] ^=
+                static_cast<char>(uniform(rng, 1, 255));
+        }
+    }
+    writeBytes(image, path);
+    try {
+        KeyStore store(path);
+        TenantCipher tenant;
+        std::vector<uint32_t> ids;
+        for (const auto& entry : table)
+            ids.push_back(entry.first);
+        for (int i = 0; i < 8; i++)
+            ids.push_back(static_cast<uint32_t>(uniform(rng, 0, UINT32_MAX)));
+        for (uint32_t id : ids) {
+            try {
+                if (!store.lookup(id, tenant))
+                    continue;
+                std::unique_ptr<LineCipher> cipher = makeLineCipher(tenant);
+                transform(*cipher, toUtf8(randomWideText(rng, randomLength(rng, 64), true)), oneIn(rng, 2));
+            } catch (const std::runtime_error&) {
+            }
+        }
+    } catch (const std::runtime_error&) {
+    } catch (const std::invalid_argument&) {
+    }
+}
+
+} // namespace
+
+bool keyStoreCase(Rng& rng, std::string& mismatch)
+{
+    const std::string dir = workDir();
+    const std::string binary = dir + "/keys.bin";
+    const std::string text = dir + "/keys.txt";
+    const std::string corrupt = dir + "/corrupt.bin";
+
+    KeyTable first = randomTable(rng);
+    writeKeyStore(first, binary);
+    bool ok = true;
+    {
+        KeyStore store(binary);
+        ok = sameTable(rng, store, first, mismatch);
+
+        // Шифр, полученный до перезагрузки
+        TenantCipher before;
+        const CipherOptions* beforeOptions = nullptr;
+        if (ok && !first.empty()) {
+            auto it = first.begin();
+            std::advance(it, static_cast<long>(uniform(rng, 0, static_cast<long long>(first.size()) - 1)));
+            store.lookup(it->first, before);
+            beforeOptions = &it->second;
+        }
+
+        KeyTable second = randomTable(rng);
+        writeKeyStore(second, binary);
+        if (ok && (!store.reload() || store.generation() != 1)) {
+            mismatch = "reload: new file not loaded, generation " + std::to_string(store.generation());
+            ok = false;
+        }
+        if (ok && store.reload()) {
+            mismatch = "reload: unchanged file loaded again";
+            ok = false;
+        }
+        if (ok && !sameTable(rng, store, second, mismatch)) {
+            mismatch = "after reload: " + mismatch;
+            ok = false;
+        }
+        if (ok && beforeOptions && !sameCipher(rng, before, *beforeOptions, 4, mismatch)) {
+            mismatch = "cipher from previous version: " + mismatch;
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        writeKeyTable(first, text);
+        KeyStore store(text);
+        if (!sameTable(rng, store, first, mismatch)) {
+            mismatch = "text key file: " + mismatch;
+            ok = false;
+        }
+    }
+
+    if (ok)
+        corruptImage(rng, buildKeyStore(first), first, corrupt);
+
+    ::unlink(binary.c_str());
+    ::unlink(text.c_str());
+    ::unlink(corrupt.c_str());
+    return ok;
+}
+
+} // namespace harness
@@ -0,0 +1,462 @@
+/**
+ * @file PipelineSuite.cpp
+ * @brief Сравнение конвейера и пакетного режима с построчным эталоном
+ *
+ * @details
+ * Случайный многострочный ввод шифруется или дешифруется через
+ * runPipeline (случайные размер блока, число потоков и глубина очереди)
+ * и через runBatch (случайные подсистема ввода-вывода, размер буфера
+ * и число файлов в обработке). Ожидаемый вывод строится эталоном
+ * строка за строкой: пустые строки остаются пустыми, строки с ошибкой
+ * становятся пустыми, наличие завершающего '\\n' сохраняется.
+ * Пакетный случай также проверяет, что openOutput отказывается открыть
+ * входной файл под другим путём (через "./" или символическую ссылку),
+ * а конвейерный - что он не обрезает отображённый в память контейнер.
+ */
+
+#include "Harness.h"
+#include "reference/AlphaReference.h"
+#include "reference/RouteReference.h"
+#include "BatchIo.h"
+#include "Container.h"
+#include "Pipeline.h"
+#include "Uring.h"
+#include <algorithm>
+#include <codecvt>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <locale>
+#include <memory>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace harness {
+
+namespace {
+
+/**
+ * @class LineReference
+ * @brief Построчный эталон: то же, что LineCipher, поверх эталонных шифров
+ */
+class LineReference
+{
+private:
+    std::unique_ptr<reference::AlphaReference> alpha;   ///< Эталон alpha (или пусто)
+    std::unique_ptr<reference::RouteReference> route;   ///< Эталон route (или пусто)
+    std::wstring_convert<std::codecvt_utf8<wchar_t>> utf8;
+
+public:
+    CipherOptions options;  ///< Параметры для рабочей реализации
+
+    /**
+     * @brief Случайный корректный ключ и режим
+     */
+    explicit LineReference(Rng& rng)
+    {
+        if (oneIn(rng, 2)) {
+            options.cipher = "route";
+            int columns = static_cast<int>(uniform(rng, 1, 12));
+            options.key = std::to_string(columns);
+            route.reset(new reference::RouteReference(columns));
+            return;
+        }
+        options.cipher = "alpha";
+        options.passthrough = oneIn(rng, 2);
+        options.preserveCase = oneIn(rng, 2);
+        const std::wstring letters = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯабвгдеёжзийклмнопрстуфхцчшщъыьэюя";
+        while (!alpha) {
+            std::wstring key;
+            for (long long i = uniform(rng, 2, 10); i > 0; i--)
+                key += letters[uniform(rng, 0, static_cast<long long>(letters.size()) - 1)];
+            try {
+                alpha.reset(new reference::AlphaReference(key, options.passthrough, options.preserveCase));
+                options.key = utf8.to_bytes(key);
+            } catch (const std::invalid_argument&) {
+                // слабый ключ, выбираем другой
+            }
+        }
+    }
+
+    /**
+     * @brief Эталонная обработка одной непустой строки
+     * @return false, если строка даёт ошибку
+     */
+    bool line(const std::string& in, bool decrypt, std::string& out)
+    {
+        if (route) {
+            reference::RouteOutcome r = decrypt ? route->decrypt(in) : route->encrypt(in);
+            out = r.text;
+            return r.error.empty();
+        }
+        std::wstring text;
+        try {
+            text = utf8.from_bytes(in);
+            // codecvt молча отбрасывает незавершённую последовательность в
+            // конце строки, а адаптер считает её ошибкой
+            if (utf8.to_bytes(text) != in)
+                return false;
+        } catch (const std::range_error&) {
+            return false;
+        }
+        reference::AlphaOutcome r = decrypt ? alpha->decrypt(text) : alpha->encrypt(text);
+        if (!r.error.empty())
+            return false;
+        out = utf8.to_bytes(r.text);
+        return true;
+    }
+
+    /**
+     * @brief Случайная строка без '\\n'; для дешифрования чаще шифротекст
+     */
+    std::string randomLine(Rng& rng, bool decrypt)
+    {
+        if (oneIn(rng, 8))
+            return std::string();
+        size_t length = static_cast<size_t>(oneIn(rng, 32) ? uniform(rng, 0, 2000) : uniform(rng, 0, 80));
+        std::string s;
+        if (route) {
+            s = randomByteText(rng, length, false);
+        } else {
+            std::wstring text = randomWideText(rng, length, true);
+            std::replace(text.begin(), text.end(), L'\n', L' ');
+            s = utf8.to_bytes(text);
+        }
+        // Изредка недопустимый UTF-8
+        if (alpha && oneIn(rng, 20))
+            s.insert(static_cast<size_t>(uniform(rng, 0, static_cast<long long>(s.size()))),
+                     oneIn(rng, 2) ? "\xFF" : "\xD0");
+        std::string closed;
+        if (decrypt && !oneIn(rng, 4) && !s.empty() && line(s, false, closed))
+            return closed;
+        return s;
+    }
+};
+
+/**
+ * @struct Expected
+ * @brief Ожидаемый результат обработки ввода
+ */
+struct Expected {
+    std::string output;     ///< Вывод
+    size_t lines = 0;       ///< Число строк
+    size_t errors = 0;      ///< Строк с ошибкой
+    size_t longest = 0;     ///< Самая длинная строка, байт
+};
+
+/**
+ * @brief Случайный многострочный ввод и ожидаемый вывод для него
+ */
+std::string randomInput(Rng& rng, LineReference& ref, bool decrypt, Expected& expected)
+{
+    std::string input, out;
+    long long lines = oneIn(rng, 16) ? 0 : uniform(rng, 1, 200);
+    for (long long i = 0; i < lines; i++) {
+        std::string line = ref.randomLine(rng, decrypt);
+        bool last = i + 1 == lines;
+        bool newline = !last || !oneIn(rng, 2);
+        input += line;
+        if (!line.empty()) {
+            if (ref.line(line, decrypt, out))
+                expected.output += out;
+            else
+                expected.errors++;
+        }
+        if (newline) {
+            input += '\n';
+            expected.output += '\n';
+        }
+        // Пустая последняя строка без '\n' строкой не считается
+        if (newline || !line.empty())
+            expected.lines++;
+        expected.longest = std::max(expected.longest, line.size());
+    }
+    return input;
+}
+
+/**
+ * @brief Записывает строку в дескриптор целиком
+ */
+void writeAll(int fd, const std::string& data)
+{
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0)
+            throw std::runtime_error("write failed");
+        done += static_cast<size_t>(n);
+    }
+}
+
+/**
+ * @brief Читает дескриптор с начала до конца
+ */
+std::string readAll(int fd)
+{
+    std::string data;
+    char buffer[65536];
+    ::lseek(fd, 0, SEEK_SET);
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0)
+        data.append(buffer, static_cast<size_t>(n));
+    return data;
+}
+
+/**
+ * @brief Сравнивает вывод и счётчики с ожидаемыми
+ */
+bool sameResult(const std::string& output, size_t lines, size_t errors, const Expected& expected,
+                std::string& mismatch)
+{
+    if (output == expected.output && lines == expected.lines && errors == expected.errors)
+        return true;
+    size_t at = 0;
+    while (at < output.size() && at < expected.output.size() && output[at] == expected.output[at])
+        at++;
+    std::ostringstream out;
+    out << "lines " << lines << "/" << expected.lines << ", errors " << errors << "/" << expected.errors
+        << ", output differs at byte " << at << ": got " << escape(output.substr(at, 40))
+        << ", want " << escape(expected.output.substr(at, 40));
+    mismatch = out.str();
+    return false;
+}
+
+/**
+ * @brief openOutput не открывает входной файл под другим путём и не меняет его
+ * @param path Существующий входной файл в workDir()
+ */
+bool outputGuard(Rng& rng, const std::string& path, std::string& mismatch)
+{
+    size_t slash = path.rfind('/');
+    std::string alias = path, link = path.substr(0, slash) + "/alias";
+    switch (uniform(rng, 0, 2)) {
+    case 1:
+        alias = path.substr(0, slash) + "/." + path.substr(slash);
+        break;
+    case 2:
+        if (::symlink(path.c_str(), link.c_str()) != 0)
+            throw std::runtime_error("cannot create " + link);
+        alias = link;
+        break;
+    }
+    int in = ::open(path.c_str(), O_RDONLY);
+    if (in < 0)
+        throw std::runtime_error("cannot open " + path);
+    std::string before = readAll(in);
+    bool refused = false;
+    try {
+        ::close(openOutput(alias, fileId(in)));
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    std::string after = readAll(in);
+    ::close(in);
+    ::unlink(link.c_str());
+    if (!refused || after != before) {
+        mismatch = "openOutput(" + alias + ") over input: " + (refused ? "input changed" : "not refused");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Дешифрование контейнера в него же: выход не открывается, контейнер цел
+ *
+ * Повторяет порядок cipher_tool -d -X: контейнер уже отображён
+ * ContainerReader, затем открывается выход. Обрезка отображённого
+ * файла дала бы SIGBUS при чтении блоков и пустой контейнер.
+ */
+bool containerGuard(Rng& rng, int inFd, const CipherOptions& cipherOptions, std::string& mismatch)
+{
+    const std::string path = workDir() + "/container";
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        throw std::runtime_error("cannot create " + path);
+    PipelineOptions options;
+    options.chunkSize = static_cast<size_t>(uniform(rng, 1, 4096));
+    std::ostringstream log;
+    ::lseek(inFd, 0, SEEK_SET);
+    writeContainer(inFd, fd, cipherOptions, *makeLineCipher(cipherOptions), options, log);
+    std::string before = readAll(fd);
+    ::close(fd);
+
+    bool refused = false;
+    {
+        ContainerReader reader(path);
+        try {
+            ::close(openOutput(path, fileId(path)));
+        } catch (const std::runtime_error&) {
+            refused = true;
+        }
+        std::unique_ptr<LineCipher> cipher = makeLineCipher(cipherOptions);
+        std::string text, error;
+        for (size_t i = 0; i < reader.chunks(); i++)
+            reader.decryptChunk(i, *cipher, text, error);
+    }
+    fd = ::open(path.c_str(), O_RDONLY);
+    std::string after = fd >= 0 ? readAll(fd) : std::string();
+    if (fd >= 0)
+        ::close(fd);
+    ::unlink(path.c_str());
+    if (!refused || after != before) {
+        mismatch = std::string("openOutput over mapped container: ") + (refused ? "container changed" : "not refused");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Параметры случая для отчёта
+ */
+std::string describe(const LineReference& ref, bool decrypt)
+{
+    return ref.options.cipher + " key " + escape(ref.options.key, 40)
+           + (ref.options.passthrough ? " passthrough" : "") + (ref.options.preserveCase ? " preserveCase" : "")
+           + (decrypt ? " decrypt" : " encrypt");
+}
+
+} // namespace
+
+/**
+ * @brief Каталог для файлов пакетного режима и хранилища ключей (удаляется при выходе)
+ */
+const std::string& workDir()
+{
+    struct Dir {
+        std::string path;
+        Dir()
+        {
+            const char* base = std::getenv("TMPDIR");
+            std::string pattern = std::string(base && *base ? base : "/tmp") + "/differential.XXXXXX";
+            if (!::mkdtemp(&pattern[0]))
+                throw std::runtime_error("mkdtemp failed: " + pattern);
+            path = pattern;
+        }
+        ~Dir() { ::rmdir(path.c_str()); }
+    };
+    static Dir dir;
+    return dir.path;
+}
+
+bool pipelineCase(Rng& rng, std::string& mismatch)
+{
+    LineReference ref(rng);
+    bool decrypt = oneIn(rng, 2);
+    Expected expected;
+    std::string input = randomInput(rng, ref, decrypt, expected);
+
+    PipelineOptions options;
+    options.decrypt = decrypt;
+    options.chunkSize = static_cast<size_t>(oneIn(rng, 4) ? uniform(rng, 1, 16) : uniform(rng, 1, 8192));
+    options.workers = static_cast<unsigned>(uniform(rng, 1, 4));
+    options.queueDepth = static_cast<size_t>(uniform(rng, 0, 4));
+
+    std::unique_ptr<FILE, int (*)(FILE*)> in(std::tmpfile(), std::fclose), out(std::tmpfile(), std::fclose);
+    if (!in || !out)
+        throw std::runtime_error("tmpfile failed");
+    writeAll(fileno(in.get()), input);
+    ::lseek(fileno(in.get()), 0, SEEK_SET);
+
+    CipherOptions cipherOptions = ref.options;
+    std::ostringstream log;
+    PipelineStats stats = runPipeline(fileno(in.get()), fileno(out.get()),
+                                      [&] { return makeLineCipher(cipherOptions); }, options, log);
+    if (!sameResult(readAll(fileno(out.get())), stats.lines, stats.errors, expected, mismatch)) {
+        std::ostringstream context;
+        context << describe(ref, decrypt) << " chunk " << options.chunkSize << " workers " << options.workers
+                << " depth " << options.queueDepth << ": ";
+        mismatch = context.str() + mismatch;
+        return false;
+    }
+    if (oneIn(rng, 4) && !containerGuard(rng, fileno(in.get()), cipherOptions, mismatch)) {
+        mismatch = describe(ref, decrypt) + ": " + mismatch;
+        return false;
+    }
+    return true;
+}
+
+bool batchCase(Rng& rng, std::string& mismatch)
+{
+    LineReference ref(rng);
+    bool decrypt = oneIn(rng, 2);
+
+    std::vector<IoBackend> backends = {IoBackend::Auto, IoBackend::Threads, IoBackend::Stdio};
+#ifdef CIPHER_HAVE_URING
+    if (IoUring::available())
+        backends.push_back(IoBackend::Uring);
+#endif
+    BatchOptions options;
+    options.decrypt = decrypt;
+    options.backend = backends[uniform(rng, 0, static_cast<long long>(backends.size()) - 1)];
+    options.workers = static_cast<unsigned>(uniform(rng, 1, 3));
+    options.depth = static_cast<unsigned>(uniform(rng, 1, 4));
+
+    const std::string& dir = workDir();
+    std::vector<BatchJob> jobs;
+    std::vector<Expected> expected(static_cast<size_t>(uniform(rng, 1, 6)));
+    size_t longest = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        BatchJob job;
+        job.input = dir + "/in" + std::to_string(i);
+        job.output = dir + "/out" + std::to_string(i);
+        std::string input = randomInput(rng, ref, decrypt, expected[i]);
+        int fd = ::open(job.input.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0)
+            throw std::runtime_error("cannot create " + job.input);
+        writeAll(fd, input);
+        ::close(fd);
+        longest = std::max(longest, expected[i].longest);
+        jobs.push_back(job);
+    }
+    if (!outputGuard(rng, jobs[uniform(rng, 0, static_cast<long long>(jobs.size()) - 1)].input, mismatch)) {
+        for (const BatchJob& job : jobs)
+            ::unlink(job.input.c_str());
+        return false;
+    }
+    // Буфер должен вмещать самую длинную строку вместе с '\n'
+    options.bufferSize = longest + 1 + static_cast<size_t>(oneIn(rng, 2) ? uniform(rng, 0, 16) : uniform(rng, 0, 8192));
+
+    CipherOptions cipherOptions = ref.options;
+    std::ostringstream log;
+    BatchStats stats = runBatch(jobs, [&] { return makeLineCipher(cipherOptions); }, options, log);
+
+    std::ostringstream context;
+    context << describe(ref, decrypt) << " backend " << backendName(stats.backend) << " buffer "
+            << options.bufferSize << " workers " << options.workers << " depth " << options.depth << ": ";
+    bool ok = true;
+    if (stats.failed != 0 || stats.files != jobs.size()) {
+        mismatch = context.str() + "files " + std::to_string(stats.files) + ", failed "
+                   + std::to_string(stats.failed) + ": " + log.str();
+        ok = false;
+    }
+    for (size_t i = 0; i < jobs.size() && ok; i++) {
+        int fd = ::open(jobs[i].output.c_str(), O_RDONLY);
+        std::string output = fd >= 0 ? readAll(fd) : std::string();
+        if (fd >= 0)
+            ::close(fd);
+        // Счётчики строк в пакетном режиме общие, сравниваются только файлы
+        Expected file;
+        file.output = expected[i].output;
+        if (!sameResult(output, 0, 0, file, mismatch)) {
+            mismatch = context.str() + "file " + std::to_string(i) + ": " + mismatch;
+            ok = false;
+        }
+    }
+    size_t lines = 0, errors = 0;
+    for (const Expected& e : expected) {
+        lines += e.lines;
+        errors += e.errors;
+    }
+    if (ok && (stats.lines != lines || stats.errors != errors)) {
+        mismatch = context.str() + "lines " + std::to_string(stats.lines) + "/" + std::to_string(lines)
+                   + ", errors " + std::to_string(stats.errors) + "/" + std::to_string(errors);
+        ok = false;
+    }
+    for (const BatchJob& job : jobs) {
+        ::unlink(job.input.c_str());
+        ::unlink(job.output.c_str());
+    }
+    return ok;
+}
+
+} // namespace harness
@@ -0,0 +1,232 @@
+/**
+ * @file ProductSuite.cpp
+ * @brief Сравнение ProductCipher с последовательным применением эталонов
+ *
+ * @details
+ * Эталон продукционного шифра - композиция: AlphaReference в режиме
+ * Filter, затем перестановка по таблице, построенной явно (строки
+ * записываются слева направо, столбцы читаются справа налево и снизу
+ * вверх, как в RouteReference). Ошибки шифротекста определяет
+ * AlphaReference на входе до перестановки, поэтому позиция
+ * недопустимого символа - позиция во входе (в UTF-8 - смещение в байтах).
+ */
+
+#include "Harness.h"
+#include "reference/AlphaReference.h"
+#include "ProductCipher.h"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace harness {
+
+namespace {
+
+const char TOO_SHORT[] = "Длина текста должна быть больше ключа (количества столбцов)";
+
+/**
+ * @brief Перестановка через явную таблицу
+ * @param text Текст
+ * @param columns Число столбцов
+ * @param decrypt true - обратная перестановка
+ */
+std::wstring tableRoute(const std::wstring& text, size_t columns, bool decrypt)
+{
+    size_t rows = (text.size() + columns - 1) / columns;
+    std::vector<std::vector<size_t>> table(rows, std::vector<size_t>(columns, std::wstring::npos));
+    for (size_t k = 0; k < text.size(); k++)
+        table[k / columns][k % columns] = k;
+    std::wstring result(text.size(), L'\0');
+    size_t k = 0;
+    for (size_t j = columns; j-- > 0;) {
+        for (size_t i = rows; i-- > 0;) {
+            size_t cell = table[i][j];
+            if (cell == std::wstring::npos)
+                continue;
+            if (decrypt)
+                result[cell] = text[k++];
+            else
+                result[k++] = text[cell];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Эталон: замена, затем перестановка
+ */
+reference::AlphaOutcome referenceEncrypt(const reference::AlphaReference& alpha, size_t columns,
+                                         const std::wstring& open)
+{
+    reference::AlphaOutcome r = alpha.encrypt(open);
+    if (!r.error.empty())
+        return r;
+    if (r.text.size() <= columns) {
+        r.error = TOO_SHORT;
+        r.position = r.text.size();
+        r.text.clear();
+        return r;
+    }
+    r.text = tableRoute(r.text, columns, false);
+    return r;
+}
+
+/**
+ * @brief Эталон: обратная перестановка, затем обратная замена
+ */
+reference::AlphaOutcome referenceDecrypt(const reference::AlphaReference& alpha, size_t columns,
+                                         const std::wstring& closed)
+{
+    reference::AlphaOutcome r = alpha.decrypt(closed);
+    if (!r.error.empty())
+        return r;
+    if (closed.size() <= columns) {
+        r.error = TOO_SHORT;
+        r.position = closed.size();
+        r.text.clear();
+        return r;
+    }
+    return alpha.decrypt(tableRoute(closed, columns, true));
+}
+
+/**
+ * @brief Сравнивает байтовые методы с эталоном на декодированном тексте
+ */
+bool sameBytes(Rng& rng, ProductCipher& cipher, const reference::AlphaReference& alpha, size_t columns,
+               std::string& mismatch)
+{
+    bool koi8r = oneIn(rng, 2);
+    modAlphaCipher::Encoding encoding = koi8r ? modAlphaCipher::Encoding::KOI8R
+                                              : modAlphaCipher::Encoding::CP1251;
+    const char* name = koi8r ? "koi8r " : "cp1251 ";
+
+    std::string open = randomSingleByteText(rng, randomLength(rng, 4096));
+    reference::ByteOutcome want(referenceEncrypt(alpha, columns, reference::decodeSingleByte(open, koi8r)), koi8r);
+    if (!sameOutcome(cipher.tryEncrypt(open, encoding), want, ProductCipher::errorMessage,
+                     "tryEncrypt(bytes)", mismatch)
+        || !sameThrowing([&] { return cipher.encrypt(open, encoding); }, want, "encrypt(bytes)", mismatch)) {
+        mismatch = name + escape(open) + ": " + mismatch;
+        return false;
+    }
+
+    std::string closed = pickCipherText(rng, want.text, want.error.empty(),
+        [&] { return static_cast<char>(uniform(rng, 0, 255)); },
+        [&] { return randomSingleByteText(rng, randomLength(rng, 4096)); });
+    reference::ByteOutcome plain(referenceDecrypt(alpha, columns, reference::decodeSingleByte(closed, koi8r)), koi8r);
+    if (!sameOutcome(cipher.tryDecrypt(closed, encoding), plain, ProductCipher::errorMessage,
+                     "tryDecrypt(bytes)", mismatch)
+        || !sameThrowing([&] { return cipher.decrypt(closed, encoding); }, plain, "decrypt(bytes)", mismatch)) {
+        mismatch = name + escape(closed) + ": " + mismatch;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @struct Utf8Outcome
+ * @brief Эталонный результат в UTF-8: позиция недопустимого символа - в байтах
+ */
+struct Utf8Outcome {
+    std::string text;
+    std::string error;
+    size_t position;
+
+    Utf8Outcome(const reference::AlphaOutcome& r, const std::wstring& input) :
+        text(r.error.empty() ? toUtf8(r.text) : std::string()), error(r.error),
+        position(r.error == "Invalid cipher text" ? toUtf8(input.substr(0, r.position)).size() : r.position) {}
+};
+
+/**
+ * @brief Сравнивает методы UTF-8 с эталоном на широком тексте
+ */
+bool sameUtf8(Rng& rng, ProductCipher& cipher, const reference::AlphaReference& alpha, size_t columns,
+              std::string& mismatch)
+{
+    const modAlphaCipher::Encoding encoding = modAlphaCipher::Encoding::UTF8;
+    std::wstring wide = randomWideText(rng, randomLength(rng, 4096), true);
+    std::string open = toUtf8(wide);
+    reference::AlphaOutcome encrypted = referenceEncrypt(alpha, columns, wide);
+    Utf8Outcome want(encrypted, wide);
+    if (!sameOutcome(cipher.tryEncrypt(open, encoding), want, ProductCipher::errorMessage, "tryEncrypt(utf8)", mismatch)
+        || !sameThrowing([&] { return cipher.encrypt(open, encoding); }, want, "encrypt(utf8)", mismatch)) {
+        mismatch = "utf8 " + escape(open) + ": " + mismatch;
+        return false;
+    }
+
+    std::wstring closedWide = pickCipherText(rng, encrypted.text, encrypted.error.empty(),
+        [&] { return static_cast<wchar_t>(uniform(rng, 0x3FF, 0x460)); },
+        [&] { return randomWideText(rng, randomLength(rng, 4096), true); });
+    std::string closed = toUtf8(closedWide);
+    Utf8Outcome plain(referenceDecrypt(alpha, columns, closedWide), closedWide);
+    if (!sameOutcome(cipher.tryDecrypt(closed, encoding), plain, ProductCipher::errorMessage,
+                     "tryDecrypt(utf8)", mismatch)
+        || !sameThrowing([&] { return cipher.decrypt(closed, encoding); }, plain, "decrypt(utf8)", mismatch)) {
+        mismatch = "utf8 " + escape(closed) + ": " + mismatch;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool productCase(Rng& rng, std::string& mismatch)
+{
+    std::wstring key = randomKey(rng);
+    int columns = static_cast<int>(oneIn(rng, 16) ? uniform(rng, -2, 0)
+                                   : oneIn(rng, 8) ? uniform(rng, 1, 300) : uniform(rng, 1, 12));
+    bool preserveCase = oneIn(rng, 2);
+
+    std::unique_ptr<reference::AlphaReference> alpha;
+    std::unique_ptr<ProductCipher> cipher;
+    std::string refError, error;
+    try {
+        alpha.reset(new reference::AlphaReference(key, false, preserveCase));
+        if (columns <= 0)
+            refError = "Ключ должен быть положительным";
+    } catch (const std::invalid_argument& e) {
+        refError = e.what();
+    }
+    try {
+        cipher.reset(new ProductCipher(key, columns, preserveCase));
+    } catch (const cipher_error& e) {
+        error = e.what();
+    }
+    std::string context = "key " + escape(key) + " columns " + std::to_string(columns)
+                          + (preserveCase ? " preserveCase" : "");
+    if (error != refError) {
+        mismatch = context + ": constructor got " + quote(error) + ", want " + quote(refError);
+        return false;
+    }
+    if (!refError.empty())
+        return true;
+    size_t width = static_cast<size_t>(columns);
+
+    // Шифрование
+    std::wstring open = randomWideText(rng, randomLength(rng, 4096), false);
+    reference::AlphaOutcome want = referenceEncrypt(*alpha, width, open);
+    if (!sameOutcome(cipher->tryEncrypt(open), want, ProductCipher::errorMessage, "tryEncrypt", mismatch)
+        || !sameThrowing([&] { return cipher->encrypt(open); }, want, "encrypt", mismatch)) {
+        mismatch = context + " text " + escape(open) + ": " + mismatch;
+        return false;
+    }
+
+    // Дешифрование
+    std::wstring closed = pickCipherText(rng, want.text, want.error.empty(),
+        [&] { return static_cast<wchar_t>(uniform(rng, 0x3FF, 0x460)); },
+        [&] { return randomWideText(rng, randomLength(rng, 4096), false); });
+    reference::AlphaOutcome plain = referenceDecrypt(*alpha, width, closed);
+    if (!sameOutcome(cipher->tryDecrypt(closed), plain, ProductCipher::errorMessage, "tryDecrypt", mismatch)
+        || !sameThrowing([&] { return cipher->decrypt(closed); }, plain, "decrypt", mismatch)) {
+        mismatch = context + " text " + escape(closed) + ": " + mismatch;
+        return false;
+    }
+
+    // Однобайтовые кодировки и UTF-8
+    if (!sameBytes(rng, *cipher, *alpha, width, mismatch) || !sameUtf8(rng, *cipher, *alpha, width, mismatch)) {
+        mismatch = context + " " + mismatch;
+        return false;
+    }
+    return true;
+}
+
+} // namespace harness
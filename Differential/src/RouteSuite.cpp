@@ -0,0 +1,116 @@
+/**
+ * @file RouteSuite.cpp
+ * @brief Сравнение TableRouteCipher с эталонной реализацией
+ *
+ * @details
+ * Число столбцов выбирается случайно, включая неположительные и
+ * предельные значения; тексты состоят из букв, цифр, знаков и байтов
+ * 0x80-0xFF. Дешифруются шифротексты эталона и произвольные строки.
+ */
+
+#include "Harness.h"
+#include "reference/RouteReference.h"
+#include "TableRouteCipher.h"
+#include <climits>
+#include <memory>
+#include <stdexcept>
+
+namespace harness {
+
+namespace {
+
+const char LETTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+const char OTHERS[] = "0123456789 .,;:!?-\t\r\"'()@[`{\x7F";
+
+/**
+ * @brief Случайное число столбцов
+ */
+int randomColumns(Rng& rng)
+{
+    switch (uniform(rng, 0, 31)) {
+    case 0: return INT_MIN;
+    case 1: return INT_MAX;
+    case 2: return static_cast<int>(uniform(rng, -5, 0));
+    case 3: return static_cast<int>(uniform(rng, 65, 4096));
+    default: return static_cast<int>(uniform(rng, 1, 64));
+    }
+}
+
+} // namespace
+
+std::string randomByteText(Rng& rng, size_t length, bool newlines)
+{
+    std::string text;
+    text.reserve(length);
+    // Доля букв меняется от текста к тексту: от почти пустых до сплошных
+    long long letters = uniform(rng, 0, 100);
+    for (size_t i = 0; i < length; i++) {
+        long long r = uniform(rng, 0, 99);
+        char c;
+        if (r < letters)
+            c = LETTERS[uniform(rng, 0, sizeof(LETTERS) - 2)];
+        else if (r % 4 == 0)
+            c = static_cast<char>(uniform(rng, 0x80, 0xFF));
+        else if (r % 4 == 1)
+            c = static_cast<char>(uniform(rng, 0x00, 0x1F));
+        else
+            c = OTHERS[uniform(rng, 0, sizeof(OTHERS) - 2)];
+        if (c == '\n' && !newlines)
+            c = ' ';
+        text += c;
+    }
+    return text;
+}
+
+bool routeCase(Rng& rng, std::string& mismatch)
+{
+    int columns = randomColumns(rng);
+    std::unique_ptr<reference::RouteReference> ref;
+    std::unique_ptr<TableRouteCipher> cipher;
+    std::string refError, error;
+    try {
+        ref.reset(new reference::RouteReference(columns));
+    } catch (const std::invalid_argument& e) {
+        refError = e.what();
+    }
+    try {
+        cipher.reset(new TableRouteCipher(columns));
+    } catch (const cipher_error& e) {
+        error = e.what();
+    }
+    std::string context = "columns " + std::to_string(columns);
+    if (error != refError) {
+        mismatch = context + ": constructor got " + quote(error) + ", want " + quote(refError);
+        return false;
+    }
+    if (!ref)
+        return true;
+
+    // Шифрование
+    std::string open = randomByteText(rng, randomLength(rng, 4096), true);
+    reference::RouteOutcome want = ref->encrypt(open);
+    if (!sameOutcome(cipher->tryEncrypt(open), want, TableRouteCipher::errorMessage, "tryEncrypt", mismatch)
+        || !sameThrowing([&] { return cipher->encrypt(open); }, want, "encrypt", mismatch)) {
+        mismatch = context + " text " + escape(open) + ": " + mismatch;
+        return false;
+    }
+
+    // Дешифрование: шифротекст эталона или произвольная строка
+    std::string closed = want.error.empty() && !oneIn(rng, 4)
+                         ? want.text : randomByteText(rng, randomLength(rng, 4096), true);
+    reference::RouteOutcome plain = ref->decrypt(closed);
+    if (!sameOutcome(cipher->tryDecrypt(closed), plain, TableRouteCipher::errorMessage, "tryDecrypt", mismatch)
+        || !sameThrowing([&] { return cipher->decrypt(closed); }, plain, "decrypt", mismatch)) {
+        mismatch = context + " text " + escape(closed) + ": " + mismatch;
+        return false;
+    }
+
+    // Круговой путь эталона: буквы открытого текста в верхнем регистре
+    if (closed == want.text && want.error.empty() && ref->encrypt(plain.text).text != closed) {
+        mismatch = context + " text " + escape(open) + ": reference round trip broken";
+        return false;
+    }
+    return true;
+}
+
+} // namespace harness
@@ -0,0 +1,229 @@
+/**
+ * @file SharedSuite.cpp
+ * @brief Один экземпляр шифра из многих потоков
+ *
+ * @details
+ * Случай создаёт по одному modAlphaCipher, TableRouteCipher и
+ * ProductCipher и набор операций над ними: try- и бросающие методы,
+ * байтовые кодировки, окно с общим индексом, преобразование на месте
+ * (над копией текста). Ожидаемые результаты вычисляются одним потоком,
+ * затем SHARED_THREADS потоков одновременно выполняют все операции над
+ * общими константными экземплярами, каждый со своего места в списке, и
+ * сравнивают результаты с ожидаемыми. Под ThreadSanitizer (make tsan)
+ * набор проверяет и отсутствие гонок данных.
+ */
+
+#include "Harness.h"
+#include "modAlphaCipher.h"
+#include "ProductCipher.h"
+#include "TableRouteCipher.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace harness {
+
+namespace {
+
+/// Потоков на один экземпляр
+const size_t SHARED_THREADS = 64;
+
+/// Проходов каждого потока по списку операций
+const size_t SHARED_ROUNDS = 2;
+
+/**
+ * @struct Operation
+ * @brief Вызов метода общего экземпляра; результат сведён к строке
+ */
+struct Operation {
+    std::string name;                       ///< Метод и входные данные для отчёта
+    std::function<std::string()> run;       ///< Вызов
+};
+
+/**
+ * @brief Байты текста, код ошибки и позиция одной строкой
+ */
+template <class String>
+std::string flatten(const String& text, int error, size_t position)
+{
+    return std::string(reinterpret_cast<const char*>(text.data()), text.size() * sizeof(text[0]))
+           + '|' + std::to_string(error) + '|' + std::to_string(position);
+}
+
+template <class Result>
+std::string flatten(const Result& r)
+{
+    return flatten(r.text, static_cast<int>(r.error), r.position);
+}
+
+/**
+ * @brief Результат бросающего метода: текст или сообщение исключения
+ */
+template <class Call>
+std::string flattenThrowing(Call call)
+{
+    try {
+        return flatten(call(), 0, 0);
+    } catch (const cipher_error& e) {
+        return std::string("!") + e.what();
+    }
+}
+
+/**
+ * @brief Шифр modAlphaCipher со случайным корректным ключом
+ */
+std::unique_ptr<modAlphaCipher> randomAlpha(Rng& rng, modAlphaCipher::TextMode mode, bool preserveCase)
+{
+    for (;;) {
+        try {
+            return std::unique_ptr<modAlphaCipher>(new modAlphaCipher(randomKey(rng), mode, preserveCase));
+        } catch (const cipher_error&) {
+        }
+    }
+}
+
+/**
+ * @brief Операции modAlphaCipher над широким текстом и байтовыми кодировками
+ */
+void alphaOperations(Rng& rng, const modAlphaCipher& cipher, bool passthrough, std::vector<Operation>& ops)
+{
+    typedef modAlphaCipher::Encoding Encoding;
+    std::wstring open = randomWideText(rng, randomLength(rng, 4096), true);
+    std::wstring closed = cipher.tryEncrypt(open).text;
+    std::string utf8 = toUtf8(open);
+    std::string closedUtf8 = toUtf8(closed);
+    std::string single = randomSingleByteText(rng, randomLength(rng, 4096));
+    size_t position = static_cast<size_t>(uniform(rng, 0, 100));
+    size_t offset = static_cast<size_t>(uniform(rng, 0, static_cast<long long>(closed.size())));
+    size_t length = static_cast<size_t>(uniform(rng, 0, static_cast<long long>(closed.size() - offset)));
+    // Индекс окна (только Passthrough) - тоже общий для всех потоков
+    std::shared_ptr<const modAlphaCipher::SeekIndex> index;
+    if (passthrough)
+        index = std::make_shared<const modAlphaCipher::SeekIndex>(
+            modAlphaCipher::buildSeekIndex(closed, static_cast<size_t>(uniform(rng, 1, 64))));
+
+    ops.push_back({"alpha tryEncrypt " + escape(open), [&cipher, open, position] {
+        return flatten(cipher.tryEncrypt(open, position));
+    }});
+    ops.push_back({"alpha tryDecrypt " + escape(closed), [&cipher, closed, position] {
+        return flatten(cipher.tryDecrypt(closed, position));
+    }});
+    ops.push_back({"alpha encrypt " + escape(open), [&cipher, open] {
+        return flattenThrowing([&] { return cipher.encrypt(open); });
+    }});
+    ops.push_back({"alpha decrypt " + escape(closed), [&cipher, closed] {
+        return flattenThrowing([&] { return cipher.decrypt(closed); });
+    }});
+    ops.push_back({"alpha tryDecryptRange " + escape(closed), [&cipher, closed, offset, length, index] {
+        return flatten(cipher.tryDecryptRange(closed, offset, length, index.get()));
+    }});
+    ops.push_back({"alpha utf8 tryEncrypt " + escape(utf8), [&cipher, utf8, position] {
+        return flatten(cipher.tryEncrypt(utf8, Encoding::UTF8, position));
+    }});
+    ops.push_back({"alpha utf8 decrypt " + escape(closedUtf8), [&cipher, closedUtf8] {
+        return flattenThrowing([&] { return cipher.decrypt(closedUtf8, Encoding::UTF8); });
+    }});
+    ops.push_back({"alpha cp1251 tryDecrypt " + escape(single), [&cipher, single, position] {
+        return flatten(cipher.tryDecrypt(single, Encoding::CP1251, position));
+    }});
+    ops.push_back({"alpha koi8r tryEncrypt " + escape(single), [&cipher, single] {
+        return flatten(cipher.tryEncrypt(single, Encoding::KOI8R));
+    }});
+    ops.push_back({"alpha encryptInPlace " + escape(open), [&cipher, open] {
+        std::wstring text = open;
+        modAlphaCipher::Error error = cipher.encryptInPlace(text);
+        return flatten(text, static_cast<int>(error), 0);
+    }});
+}
+
+/**
+ * @brief Операции TableRouteCipher
+ */
+void routeOperations(Rng& rng, const TableRouteCipher& cipher, std::vector<Operation>& ops)
+{
+    std::string open = randomByteText(rng, randomLength(rng, 4096), true);
+    std::string closed = cipher.tryEncrypt(open).text;
+    ops.push_back({"route tryEncrypt " + escape(open), [&cipher, open] {
+        return flatten(cipher.tryEncrypt(open));
+    }});
+    ops.push_back({"route tryDecrypt " + escape(closed), [&cipher, closed] {
+        return flatten(cipher.tryDecrypt(closed));
+    }});
+    ops.push_back({"route decrypt " + escape(open), [&cipher, open] {
+        return flattenThrowing([&] { return cipher.decrypt(open); });
+    }});
+}
+
+/**
+ * @brief Операции ProductCipher
+ */
+void productOperations(Rng& rng, const ProductCipher& cipher, std::vector<Operation>& ops)
+{
+    std::wstring open = randomWideText(rng, randomLength(rng, 4096), true);
+    std::wstring closed = cipher.tryEncrypt(open).text;
+    std::string closedUtf8 = toUtf8(closed);
+    ops.push_back({"product tryEncrypt " + escape(open), [&cipher, open] {
+        return flatten(cipher.tryEncrypt(open));
+    }});
+    ops.push_back({"product tryDecrypt " + escape(closed), [&cipher, closed] {
+        return flatten(cipher.tryDecrypt(closed));
+    }});
+    ops.push_back({"product utf8 decrypt " + escape(closedUtf8), [&cipher, closedUtf8] {
+        return flattenThrowing([&] { return cipher.decrypt(closedUtf8, modAlphaCipher::Encoding::UTF8); });
+    }});
+}
+
+} // namespace
+
+bool sharedCase(Rng& rng, std::string& mismatch)
+{
+    bool passthrough = oneIn(rng, 2);
+    std::unique_ptr<modAlphaCipher> alpha = randomAlpha(
+        rng, passthrough ? modAlphaCipher::TextMode::Passthrough : modAlphaCipher::TextMode::Filter, oneIn(rng, 2));
+    TableRouteCipher route(static_cast<int>(uniform(rng, 1, 64)));
+    std::unique_ptr<ProductCipher> product;
+    while (!product) {
+        try {
+            product.reset(new ProductCipher(randomKey(rng), static_cast<int>(uniform(rng, 1, 64)), oneIn(rng, 2)));
+        } catch (const cipher_error&) {
+        }
+    }
+
+    std::vector<Operation> ops;
+    alphaOperations(rng, *alpha, passthrough, ops);
+    routeOperations(rng, route, ops);
+    productOperations(rng, *product, ops);
+    std::vector<std::string> expected;
+    for (const Operation& op : ops)
+        expected.push_back(op.run());
+
+    // Все потоки стартуют одновременно, первое расхождение сохраняется
+    std::atomic<size_t> ready(0);
+    std::atomic<bool> failed(false);
+    std::mutex lock;
+    auto worker = [&](size_t thread) {
+        ready++;
+        while (ready.load() < SHARED_THREADS)
+            std::this_thread::yield();
+        for (size_t i = 0; i < SHARED_ROUNDS * ops.size() && !failed.load(); i++) {
+            size_t k = (thread + i) % ops.size();
+            if (ops[k].run() == expected[k])
+                continue;
+            std::lock_guard<std::mutex> guard(lock);
+            if (!failed.exchange(true))
+                mismatch = "thread " + std::to_string(thread) + ": " + ops[k].name + ": result differs from "
+                           + "single-threaded run";
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < SHARED_THREADS; t++)
+        threads.emplace_back(worker, t);
+    for (std::thread& t : threads)
+        t.join();
+    return !failed.load();
+}
+
+} // namespace harness
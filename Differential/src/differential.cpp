@@ -0,0 +1,134 @@
+/**
+ * @file differential.cpp
+ * @brief Дифференциальное тестирование шифров против эталонных реализаций
+ *
+ * Использование:
+ * ```
+ * differential [-n ИТЕРАЦИЙ] [-s SEED] [-S НАБОР] [-f ПЕРВАЯ]
+ * ```
+ * - `-n` - число итераций (по умолчанию 200000); без `-S` наборы
+ *   pipeline, batch, shared и keystore получают n/200, n/1000, n/1000 и
+ *   n/1000 итераций
+ * - `-s` - начальное значение генератора (по умолчанию 1)
+ * - `-S` - только один набор: alpha, route, pipeline, batch, product, shared
+ *   или keystore
+ * - `-f` - номер первой итерации (для воспроизведения)
+ *
+ * Генератор каждой итерации зависит только от (seed, набор, номер),
+ * поэтому расхождение воспроизводится командой, которую программа
+ * печатает вместе с ним. Код возврата 1, если найдено расхождение.
+ */
+
+#include "Harness.h"
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @struct Suite
+ * @brief Набор случаев
+ */
+struct Suite {
+    const char* name;               ///< Имя набора
+    harness::CaseFunction run;      ///< Проверка одного случая
+    unsigned divisor;               ///< Доля итераций при запуске всех наборов
+};
+
+const Suite SUITES[] = {
+    {"alpha", harness::alphaCase, 1},
+    {"route", harness::routeCase, 1},
+    {"pipeline", harness::pipelineCase, 200},
+    {"batch", harness::batchCase, 1000},
+    {"product", harness::productCase, 1},
+    {"shared", harness::sharedCase, 1000},
+    {"keystore", harness::keyStoreCase, 1000},
+};
+
+/// Больше расхождений одного набора не печатается
+const size_t MAX_REPORTED = 10;
+
+/**
+ * @brief Перемешивание splitmix64
+ */
+uint64_t mix(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Прогоняет итерации одного набора
+ * @return Число расхождений
+ */
+size_t runSuite(const Suite& suite, size_t index, uint64_t seed, uint64_t first, uint64_t count,
+                const char* program)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t mismatches = 0;
+    for (uint64_t i = first; i < first + count; i++) {
+        harness::Rng rng(mix(seed ^ mix(index * 0x100000000ull + i)));
+        std::string mismatch;
+        bool ok;
+        try {
+            ok = suite.run(rng, mismatch);
+        } catch (const std::exception& e) {
+            ok = false;
+            mismatch = std::string("exception: ") + e.what();
+        }
+        if (ok)
+            continue;
+        if (++mismatches <= MAX_REPORTED) {
+            std::cout << "MISMATCH " << suite.name << " #" << i << ": " << mismatch << "\n"
+                      << "  replay: " << program << " -S " << suite.name << " -s " << seed
+                      << " -f " << i << " -n 1\n";
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << suite.name << ": " << count << " cases, " << mismatches << " mismatches, "
+              << elapsed.count() << " s" << std::endl;
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    uint64_t iterations = 200000, seed = 1, first = 0;
+    std::string only;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:S:f:")) != -1) {
+        switch (opt) {
+        case 'n': iterations = std::strtoull(optarg, nullptr, 10); break;
+        case 's': seed = std::strtoull(optarg, nullptr, 10); break;
+        case 'S': only = optarg; break;
+        case 'f': first = std::strtoull(optarg, nullptr, 10); break;
+        default:
+            std::cerr << "Использование: " << argv[0] << " [-n ИТЕРАЦИЙ] [-s SEED] [-S НАБОР] [-f ПЕРВАЯ]\n";
+            return 2;
+        }
+    }
+
+    size_t mismatches = 0;
+    bool found = false;
+    for (size_t i = 0; i < sizeof(SUITES) / sizeof(SUITES[0]); i++) {
+        const Suite& suite = SUITES[i];
+        if (!only.empty() && only != suite.name)
+            continue;
+        found = true;
+        uint64_t count = only.empty() ? std::max<uint64_t>(iterations / suite.divisor, 1) : iterations;
+        mismatches += runSuite(suite, i, seed, first, count, argv[0]);
+    }
+    if (!found) {
+        std::cerr << "Неизвестный набор: " << only << "\n";
+        return 2;
+    }
+    std::cout << (mismatches ? "FAILED: " : "OK: ") << mismatches << " mismatches (seed " << seed << ")\n";
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file AlphaReference.cpp
+ * @brief Эталонная реализация модифицированного алфавитного шифра
+ */
+
+#include "AlphaReference.h"
+#include <stdexcept>
+
+namespace reference {
+
+bool AlphaReference::isLetter(wchar_t c)
+{
+    return (c >= L'А' && c <= L'Я') || (c >= L'а' && c <= L'я') || c == L'Ё' || c == L'ё';
+}
+
+bool AlphaReference::isUpper(wchar_t c)
+{
+    return (c >= L'А' && c <= L'Я') || c == L'Ё';
+}
+
+wchar_t AlphaReference::toUpper(wchar_t c)
+{
+    if (c >= L'а' && c <= L'я') return c - L'а' + L'А';
+    if (c == L'ё') return L'Ё';
+    return c;
+}
+
+wchar_t AlphaReference::toLower(wchar_t c)
+{
+    if (c >= L'А' && c <= L'Я') return c - L'А' + L'а';
+    if (c == L'Ё') return L'ё';
+    return c;
+}
+
+AlphaReference::AlphaReference(const std::wstring& skey, bool passthrough, bool preserveCase) :
+    alphabet(L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ"), passthrough(passthrough), preserveCase(preserveCase)
+{
+    for (size_t i = 0; i < alphabet.size(); i++)
+        index[alphabet[i]] = static_cast<int>(i);
+
+    if (skey.empty())
+        throw std::invalid_argument("Empty key");
+    std::wstring upper;
+    for (wchar_t c : skey) {
+        if (!isLetter(c))
+            throw std::invalid_argument("Invalid key");
+        upper += toUpper(c);
+    }
+    // Слабый ключ: все буквы одинаковые (в том числе ключ из одной буквы)
+    if (upper.find_first_not_of(upper[0]) == std::wstring::npos)
+        throw std::invalid_argument("Weak key");
+    for (wchar_t c : upper)
+        key.push_back(index[c]);
+}
+
+AlphaOutcome AlphaReference::run(const std::wstring& text, bool decrypt) const
+{
+    const int n = static_cast<int>(alphabet.size());
+    AlphaOutcome out;
+
+    if (passthrough) {
+        if (text.empty()) {
+            out.error = decrypt ? "Empty cipher text" : "Empty open text";
+            return out;
+        }
+        size_t k = 0;
+        for (wchar_t c : text) {
+            if (!isLetter(c)) {
+                out.text += c;
+                continue;
+            }
+            int v = index.at(toUpper(c));
+            int shifted = decrypt ? (v - key[k % key.size()] + n) % n : (v + key[k % key.size()]) % n;
+            wchar_t r = alphabet[shifted];
+            out.text += (preserveCase && !isUpper(c)) ? toLower(r) : r;
+            k++;
+        }
+        return out;
+    }
+
+    std::vector<int> work;
+    std::vector<bool> lower;
+    if (decrypt) {
+        if (text.empty()) {
+            out.error = "Empty cipher text";
+            return out;
+        }
+        for (size_t i = 0; i < text.size(); i++) {
+            if (preserveCase ? !isLetter(text[i]) : !isUpper(text[i])) {
+                out.error = "Invalid cipher text";
+                out.position = i;
+                return out;
+            }
+            work.push_back(index.at(toUpper(text[i])));
+            lower.push_back(!isUpper(text[i]));
+        }
+    } else {
+        for (wchar_t c : text) {
+            if (isLetter(c)) {
+                work.push_back(index.at(toUpper(c)));
+                lower.push_back(!isUpper(c));
+            }
+        }
+        if (work.empty()) {
+            out.error = "Empty open text";
+            return out;
+        }
+    }
+
+    for (size_t i = 0; i < work.size(); i++) {
+        int k = key[i % key.size()];
+        wchar_t r = alphabet[decrypt ? (work[i] - k + n) % n : (work[i] + k) % n];
+        out.text += (preserveCase && lower[i]) ? toLower(r) : r;
+    }
+    return out;
+}
+
+namespace {
+
+/// Байты 0xC0-0xFF каждой кодировки и позиции Ё/ё
+const wchar_t CP1251_HIGH[] = L"АБВГДЕЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯабвгдежзийклмнопрстуфхцчшщъыьэюя";
+const wchar_t KOI8R_HIGH[] = L"юабцдефгхийклмнопярстужвьызшэщчъЮАБЦДЕФГХИЙКЛМНОПЯРСТУЖВЬЫЗШЭЩЧЪ";
+
+wchar_t decodeByte(unsigned char b, bool koi8r)
+{
+    if (b >= 0xC0)
+        return (koi8r ? KOI8R_HIGH : CP1251_HIGH)[b - 0xC0];
+    if (b == (koi8r ? 0xB3 : 0xA8))
+        return L'Ё';
+    if (b == (koi8r ? 0xA3 : 0xB8))
+        return L'ё';
+    return static_cast<wchar_t>(0xF700 + b);
+}
+
+} // namespace
+
+std::wstring decodeSingleByte(const std::string& bytes, bool koi8r)
+{
+    std::wstring text;
+    for (char c : bytes)
+        text += decodeByte(static_cast<unsigned char>(c), koi8r);
+    return text;
+}
+
+std::string encodeSingleByte(const std::wstring& text, bool koi8r)
+{
+    std::map<wchar_t, char> table;
+    for (unsigned b = 0; b < 256; b++)
+        table[decodeByte(static_cast<unsigned char>(b), koi8r)] = static_cast<char>(b);
+    std::string bytes;
+    for (wchar_t c : text)
+        bytes += table.at(c);
+    return bytes;
+}
+
+} // namespace reference
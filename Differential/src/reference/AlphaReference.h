@@ -0,0 +1,100 @@
+/**
+ * @file AlphaReference.h
+ * @brief Эталонная реализация модифицированного алфавитного шифра
+ *
+ * @details
+ * Простая скалярная реализация, сохранённая как образец поведения
+ * modAlphaCipher: отображение через std::map, сдвиг через взятие
+ * по модулю, без оптимизаций. Оптимизированная реализация обязана
+ * совпадать с ней на любых входных данных, включая тексты ошибок
+ * и позиции недопустимых символов. Эталон не меняют при оптимизации
+ * шифра, только при намеренном изменении поведения.
+ *
+ * Сохранение регистра действует в обоих режимах: в режиме Filter
+ * строчная буква шифруется в строчную, и шифротекст может содержать
+ * буквы обоих регистров.
+ */
+
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+namespace reference {
+
+/**
+ * @struct AlphaOutcome
+ * @brief Результат эталонного шифрования или дешифрования
+ */
+struct AlphaOutcome {
+    std::wstring text;                          ///< Результат (если ошибки нет)
+    std::string error;                          ///< Текст ошибки (пусто, если ошибки нет)
+    size_t position = std::wstring::npos;       ///< Позиция недопустимого символа
+};
+
+/**
+ * @class AlphaReference
+ * @brief Эталон modAlphaCipher
+ */
+class AlphaReference
+{
+private:
+    std::wstring alphabet;              ///< Прописные буквы по порядку
+    std::map<wchar_t, int> index;       ///< Буква -> индекс
+    std::vector<int> key;               ///< Индексы ключа
+    bool passthrough;                   ///< Режим Passthrough
+    bool preserveCase;                  ///< Сохранение регистра
+
+    static bool isLetter(wchar_t c);
+    static bool isUpper(wchar_t c);
+    static wchar_t toUpper(wchar_t c);
+    static wchar_t toLower(wchar_t c);
+    AlphaOutcome run(const std::wstring& text, bool decrypt) const;
+
+public:
+    /**
+     * @brief Конструктор
+     * @param key Ключ
+     * @param passthrough Режим Passthrough
+     * @param preserveCase Сохранение регистра
+     * @throw std::invalid_argument с тем же текстом, что и cipher_error
+     */
+    AlphaReference(const std::wstring& key, bool passthrough, bool preserveCase);
+
+    /// Шифрование
+    AlphaOutcome encrypt(const std::wstring& text) const { return run(text, false); }
+
+    /// Дешифрование
+    AlphaOutcome decrypt(const std::wstring& text) const { return run(text, true); }
+};
+
+/**
+ * @brief Декодирует однобайтовый текст (CP1251 или KOI8-R)
+ * @param bytes Текст
+ * @param koi8r true - KOI8-R, false - CP1251
+ * @return Широкая строка: буквы - кириллица, остальные байты - коды U+F700+байт
+ */
+std::wstring decodeSingleByte(const std::string& bytes, bool koi8r);
+
+/**
+ * @brief Кодирует результат decodeSingleByte обратно
+ */
+std::string encodeSingleByte(const std::wstring& text, bool koi8r);
+
+/**
+ * @struct ByteOutcome
+ * @brief Эталонный результат, перекодированный в однобайтовую кодировку
+ *
+ * Сравнивается с Result байтовых методов (sameOutcome в Harness.h).
+ */
+struct ByteOutcome {
+    std::string text;
+    std::string error;
+    size_t position;
+
+    ByteOutcome(const AlphaOutcome& r, bool koi8r) :
+        text(r.error.empty() ? encodeSingleByte(r.text, koi8r) : std::string()),
+        error(r.error), position(r.position) {}
+};
+
+} // namespace reference
@@ -0,0 +1,82 @@
+/**
+ * @file RouteReference.cpp
+ * @brief Эталонная реализация табличного маршрутного шифра
+ */
+
+#include "RouteReference.h"
+#include <cctype>
+#include <stdexcept>
+#include <vector>
+
+namespace reference {
+
+RouteReference::RouteReference(int key)
+{
+    if (key <= 0)
+        throw std::invalid_argument("Ключ должен быть положительным");
+    columns = static_cast<size_t>(key);
+}
+
+bool RouteReference::prepare(const std::string& text, std::string& letters, RouteOutcome& out) const
+{
+    if (text.empty()) {
+        out.error = "Текст пуст";
+        return false;
+    }
+    for (char c : text)
+        if (isalpha(c))
+            letters += static_cast<char>(toupper(c));
+    if (letters.empty()) {
+        out.error = "Текст не содержит букв";
+        return false;
+    }
+    if (letters.size() <= columns) {
+        out.error = "Длина текста должна быть больше ключа (количества столбцов)";
+        out.position = letters.size();
+        return false;
+    }
+    return true;
+}
+
+RouteOutcome RouteReference::encrypt(const std::string& text) const
+{
+    RouteOutcome out;
+    std::string letters;
+    if (!prepare(text, letters, out))
+        return out;
+
+    size_t rows = (letters.size() + columns - 1) / columns;
+    std::vector<std::vector<int>> table(rows, std::vector<int>(columns, -1));
+    for (size_t i = 0; i < letters.size(); i++)
+        table[i / columns][i % columns] = static_cast<unsigned char>(letters[i]);
+
+    for (size_t j = columns; j-- > 0;)
+        for (size_t i = rows; i-- > 0;)
+            if (table[i][j] >= 0)
+                out.text += static_cast<char>(table[i][j]);
+    return out;
+}
+
+RouteOutcome RouteReference::decrypt(const std::string& text) const
+{
+    RouteOutcome out;
+    std::string letters;
+    if (!prepare(text, letters, out))
+        return out;
+
+    size_t rows = (letters.size() + columns - 1) / columns;
+    std::vector<std::vector<int>> table(rows, std::vector<int>(columns, -1));
+    size_t next = 0;
+    for (size_t j = columns; j-- > 0;)
+        for (size_t i = rows; i-- > 0;)
+            if (i * columns + j < letters.size())
+                table[i][j] = static_cast<unsigned char>(letters[next++]);
+
+    for (size_t i = 0; i < rows; i++)
+        for (size_t j = 0; j < columns; j++)
+            if (table[i][j] >= 0)
+                out.text += static_cast<char>(table[i][j]);
+    return out;
+}
+
+} // namespace reference
@@ -0,0 +1,53 @@
+/**
+ * @file RouteReference.h
+ * @brief Эталонная реализация табличного маршрутного шифра
+ *
+ * @details
+ * Построчная запись в таблицу и чтение по столбцам справа налево
+ * снизу вверх через явную двумерную таблицу, как в исходной
+ * реализации TableRouteCipher. Оптимизированная реализация обязана
+ * совпадать с эталоном на любых входных данных.
+ */
+
+#pragma once
+#include <string>
+
+namespace reference {
+
+/**
+ * @struct RouteOutcome
+ * @brief Результат эталонного шифрования или дешифрования
+ */
+struct RouteOutcome {
+    std::string text;                       ///< Результат (если ошибки нет)
+    std::string error;                      ///< Текст ошибки (пусто, если ошибки нет)
+    size_t position = std::string::npos;    ///< Число букв для ошибки "текст короче ключа"
+};
+
+/**
+ * @class RouteReference
+ * @brief Эталон TableRouteCipher
+ */
+class RouteReference
+{
+private:
+    size_t columns;     ///< Число столбцов
+
+    bool prepare(const std::string& text, std::string& letters, RouteOutcome& out) const;
+
+public:
+    /**
+     * @brief Конструктор
+     * @param key Число столбцов
+     * @throw std::invalid_argument с тем же текстом, что и cipher_error
+     */
+    explicit RouteReference(int key);
+
+    /// Шифрование
+    RouteOutcome encrypt(const std::string& text) const;
+
+    /// Дешифрование
+    RouteOutcome decrypt(const std::string& text) const;
+};
+
+} // namespace reference
@@ -0,0 +1,232 @@
+/**
+ * @file ProductCipher.cpp
+ * @brief Реализация методов класса ProductCipher
+ *
+ * Нешаблонная обёртка над ядром ProductCore.h: проверка ключей и текста,
+ * коды ошибок и исключения.
+ */
+
+#include "ProductCipher.h"
+
+/**
+ * @brief Конструктор
+ * @param alphaKey Ключ замены
+ * @param columns Число столбцов
+ * @param preserveCase Сохранять регистр букв
+ * @throw cipher_error если ключ замены или число столбцов невалидны
+ */
+ProductCipher::ProductCipher(const std::wstring& alphaKey, int columns, bool preserveCase) :
+    key(alphaKey.size()), columns(0), preserveCase(preserveCase)
+{
+    alpha_core::KeyError error = alpha_core::keyIndices(alphaKey.data(), alphaKey.size(), key.data());
+    if (error != alpha_core::KeyError::None)
+        throw cipher_error(alpha_core::keyErrorMessage(error));
+    if (columns <= 0)
+        throw cipher_error("Ключ должен быть положительным");
+    this->columns = static_cast<size_t>(columns);
+}
+
+/**
+ * @brief Шифрует или дешифрует текст алфавитом Alphabet
+ * @param text Входной текст
+ * @param decrypt true - дешифрование
+ * @return Результат или код ошибки
+ *
+ * Шифрование: подсчёт букв (длина таблицы), затем один проход
+ * product_core::encrypt. Дешифрование: проверка шифротекста без
+ * копирования, затем один проход product_core::decrypt.
+ */
+template <class Alphabet, class ResultT>
+ResultT ProductCipher::transform(const std::basic_string<typename Alphabet::char_type>& text, bool decrypt) const
+{
+    using CharT = typename Alphabet::char_type;
+    ResultT result;
+    size_t letters;
+    {
+        CIPHER_STAGE(ProductValidate, cipher_stats::encodedBytes(text.data(), text.size()));
+        if (decrypt) {
+            if (text.empty()) {
+                result.error = Error::EmptyCipherText;
+                return result;
+            }
+            size_t invalid = Alphabet::findInvalid(text.data(), text.size(), preserveCase);
+            if (invalid != std::basic_string<CharT>::npos) {
+                result.error = Error::InvalidCipherText;
+                result.position = invalid;
+                return result;
+            }
+            letters = text.size();
+        } else {
+            letters = Alphabet::countLetters(text.data(), text.size());
+            if (letters == 0) {
+                result.error = Error::EmptyOpenText;
+                return result;
+            }
+        }
+    }
+    if (letters <= columns) {
+        result.error = Error::TextTooShort;
+        result.position = letters;
+        return result;
+    }
+
+    CIPHER_STAGE(ProductTransform, cipher_stats::encodedBytes(text.data(), text.size()));
+    result.text.resize(letters);
+    if (decrypt)
+        product_core::decrypt<Alphabet>(text.data(), letters, &result.text[0], key.data(), key.size(), columns);
+    else
+        product_core::encrypt<Alphabet>(text.data(), text.size(), letters, &result.text[0], key.data(), key.size(),
+                                        columns, preserveCase);
+    return result;
+}
+
+/**
+ * @brief Шифрует или дешифрует текст в UTF-8
+ * @param text Входной текст
+ * @param decrypt true - дешифрование
+ * @return Результат или код ошибки
+ *
+ * Шифротекст проверяется в UTF-8, чтобы позиция ошибки была смещением
+ * в байтах; после проверки каждая пара байтов - буква.
+ */
+ProductCipher::ByteResult ProductCipher::transformUtf8(const std::string& text, bool decrypt) const
+{
+    using alpha_core::Utf8Alphabet;
+    ByteResult result;
+    if (decrypt && !text.empty()) {
+        CIPHER_STAGE(ProductValidate, text.size());
+        size_t invalid = Utf8Alphabet::findInvalid(text.data(), text.size(), preserveCase);
+        if (invalid != std::string::npos) {
+            result.error = Error::InvalidCipherText;
+            result.position = invalid;
+            return result;
+        }
+    }
+    std::string codes(text.size() / 2, '\0');
+    codes.resize(Utf8Alphabet::letterCodes(text.data(), text.size(), &codes[0]));
+    result = transform<alpha_core::CodeAlphabet, ByteResult>(codes, decrypt);
+    if (!result)
+        return result;
+    std::string out(2 * result.text.size(), '\0');
+    Utf8Alphabet::encodeLetters(result.text.data(), result.text.size(), &out[0]);
+    result.text.swap(out);
+    return result;
+}
+
+/**
+ * @brief Шифрует текст
+ * @throw cipher_error при ошибке
+ */
+std::wstring ProductCipher::encrypt(const std::wstring& open_text) const
+{
+    Result result = tryEncrypt(open_text);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Дешифрует текст
+ * @throw cipher_error при ошибке
+ */
+std::wstring ProductCipher::decrypt(const std::wstring& cipher_text) const
+{
+    Result result = tryDecrypt(cipher_text);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Шифрует текст без исключений
+ */
+ProductCipher::Result ProductCipher::tryEncrypt(const std::wstring& open_text) const
+{
+    return transform<alpha_core::WideAlphabet, Result>(open_text, false);
+}
+
+/**
+ * @brief Дешифрует текст без исключений
+ */
+ProductCipher::Result ProductCipher::tryDecrypt(const std::wstring& cipher_text) const
+{
+    return transform<alpha_core::WideAlphabet, Result>(cipher_text, true);
+}
+
+/**
+ * @brief Шифрует текст в байтовой кодировке
+ * @throw cipher_error при ошибке
+ */
+std::string ProductCipher::encrypt(const std::string& open_text, modAlphaCipher::Encoding encoding) const
+{
+    ByteResult result = tryEncrypt(open_text, encoding);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Дешифрует текст в байтовой кодировке
+ * @throw cipher_error при ошибке
+ */
+std::string ProductCipher::decrypt(const std::string& cipher_text, modAlphaCipher::Encoding encoding) const
+{
+    ByteResult result = tryDecrypt(cipher_text, encoding);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Шифрует текст в байтовой кодировке без исключений
+ */
+ProductCipher::ByteResult ProductCipher::tryEncrypt(const std::string& open_text, modAlphaCipher::Encoding encoding) const
+{
+    switch (encoding) {
+    case modAlphaCipher::Encoding::KOI8R:
+        return transform<alpha_core::Koi8rAlphabet, ByteResult>(open_text, false);
+    case modAlphaCipher::Encoding::UTF8:
+        return transformUtf8(open_text, false);
+    case modAlphaCipher::Encoding::CP1251:
+        break;
+    }
+    return transform<alpha_core::Cp1251Alphabet, ByteResult>(open_text, false);
+}
+
+/**
+ * @brief Дешифрует текст в байтовой кодировке без исключений
+ */
+ProductCipher::ByteResult ProductCipher::tryDecrypt(const std::string& cipher_text, modAlphaCipher::Encoding encoding) const
+{
+    switch (encoding) {
+    case modAlphaCipher::Encoding::KOI8R:
+        return transform<alpha_core::Koi8rAlphabet, ByteResult>(cipher_text, true);
+    case modAlphaCipher::Encoding::UTF8:
+        return transformUtf8(cipher_text, true);
+    case modAlphaCipher::Encoding::CP1251:
+        break;
+    }
+    return transform<alpha_core::Cp1251Alphabet, ByteResult>(cipher_text, true);
+}
+
+/**
+ * @brief Возвращает текст сообщения об ошибке
+ * @param error Код ошибки
+ * @return Сообщение modAlphaCipher или TableRouteCipher для той же ошибки
+ */
+const char* ProductCipher::errorMessage(Error error)
+{
+    switch (error) {
+    case Error::None:
+        return "No error";
+    case Error::EmptyOpenText:
+        return "Empty open text";
+    case Error::EmptyCipherText:
+        return "Empty cipher text";
+    case Error::InvalidCipherText:
+        return "Invalid cipher text";
+    case Error::TextTooShort:
+        return "Длина текста должна быть больше ключа (количества столбцов)";
+    }
+    return "Unknown error";
+}
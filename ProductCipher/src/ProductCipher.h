@@ -0,0 +1,157 @@
+/**
+ * @file ProductCipher.h
+ * @brief Продукционный шифр: modAlphaCipher, затем маршрутная перестановка
+ *
+ * @details
+ * Результат совпадает с последовательным применением modAlphaCipher
+ * (режим Filter) и перестановки TableRouteCipher к буквам шифротекста,
+ * но вычисляется за один проход без промежуточных строк (ProductCore.h).
+ * TableRouteCipher сам по себе оставляет только латинские буквы, поэтому
+ * "последовательное применение" - это modAlphaCipher и перестановка
+ * route_core::encryptRoute над его шифротекстом: маршрут тот же, алфавит -
+ * русский.
+ */
+
+#pragma once
+#include "modAlphaCipher.h"
+#include "ProductCore.h"
+#include <string>
+#include <vector>
+
+/**
+ * @class ProductCipher
+ * @brief Замена с ключом-словом и маршрутная перестановка с ключом-числом
+ *
+ * Методы const и потокобезопасны, как у modAlphaCipher.
+ */
+class ProductCipher
+{
+public:
+    /**
+     * @enum Error
+     * @brief Коды ошибок обработки текста
+     */
+    enum class Error {
+        None,               ///< Ошибки нет
+        EmptyOpenText,      ///< Открытый текст не содержит букв
+        EmptyCipherText,    ///< Пустой шифротекст
+        InvalidCipherText,  ///< Недопустимый символ в шифротексте
+        TextTooShort        ///< Число букв не больше числа столбцов
+    };
+
+    /**
+     * @struct Result
+     * @brief Результат шифрования или дешифрования без исключений
+     */
+    struct Result {
+        std::wstring text;                       ///< Результат (если ошибки нет)
+        Error error = Error::None;               ///< Код ошибки
+        size_t position = std::wstring::npos;    ///< Позиция недопустимого символа
+                                                 ///< (для TextTooShort - число букв)
+
+        /// Истина, если ошибки нет
+        explicit operator bool() const { return error == Error::None; }
+    };
+
+    /**
+     * @struct ByteResult
+     * @brief Результат для байтовых кодировок
+     */
+    struct ByteResult {
+        std::string text;                        ///< Результат в той же кодировке
+        Error error = Error::None;               ///< Код ошибки
+        size_t position = std::string::npos;     ///< Позиция недопустимого байта (начала буквы UTF-8)
+                                                 ///< (для TextTooShort - число букв)
+
+        /// Истина, если ошибки нет
+        explicit operator bool() const { return error == Error::None; }
+    };
+
+    /**
+     * @brief Возвращает текст сообщения об ошибке
+     * @param error Код ошибки
+     * @return Сообщение, совпадающее с сообщением соответствующего шифра
+     */
+    static const char* errorMessage(Error error);
+
+    ProductCipher() = delete;
+
+    /**
+     * @brief Конструктор
+     * @param alphaKey Ключ замены (как у modAlphaCipher)
+     * @param columns Ключ перестановки - число столбцов (как у TableRouteCipher)
+     * @param preserveCase Сохранять регистр букв
+     * @throw cipher_error если ключ замены пустой, недопустимый или слабый,
+     *        или число столбцов не положительно
+     */
+    ProductCipher(const std::wstring& alphaKey, int columns, bool preserveCase = false);
+
+    /**
+     * @brief Шифрует текст
+     * @throw cipher_error если букв нет или их не больше числа столбцов
+     */
+    std::wstring encrypt(const std::wstring& open_text) const;
+
+    /**
+     * @brief Дешифрует текст
+     * @throw cipher_error если текст пуст, содержит недопустимые символы
+     *        или короче числа столбцов
+     */
+    std::wstring decrypt(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Шифрует текст без исключений
+     * @return Результат или EmptyOpenText, TextTooShort
+     */
+    Result tryEncrypt(const std::wstring& open_text) const;
+
+    /**
+     * @brief Дешифрует текст без исключений
+     * @return Результат или EmptyCipherText, InvalidCipherText (с позицией
+     *         во входе), TextTooShort
+     */
+    Result tryDecrypt(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Шифрует текст в байтовой кодировке
+     * @throw cipher_error при ошибке
+     */
+    std::string encrypt(const std::string& open_text, modAlphaCipher::Encoding encoding) const;
+
+    /**
+     * @brief Дешифрует текст в байтовой кодировке
+     * @throw cipher_error при ошибке
+     */
+    std::string decrypt(const std::string& cipher_text, modAlphaCipher::Encoding encoding) const;
+
+    /**
+     * @brief Шифрует текст в байтовой кодировке без исключений
+     */
+    ByteResult tryEncrypt(const std::string& open_text, modAlphaCipher::Encoding encoding) const;
+
+    /**
+     * @brief Дешифрует текст в байтовой кодировке без исключений
+     */
+    ByteResult tryDecrypt(const std::string& cipher_text, modAlphaCipher::Encoding encoding) const;
+
+private:
+    std::vector<uint8_t> key;   ///< Индексы ключа замены
+    size_t columns;             ///< Число столбцов
+    bool preserveCase;          ///< Сохранять регистр букв
+
+    /**
+     * @brief Шифрует или дешифрует текст алфавитом Alphabet
+     * @tparam Alphabet Алфавит alpha_core
+     * @tparam ResultT Result или ByteResult
+     */
+    template <class Alphabet, class ResultT>
+    ResultT transform(const std::basic_string<typename Alphabet::char_type>& text, bool decrypt) const;
+
+    /**
+     * @brief Шифрует или дешифрует текст в UTF-8
+     *
+     * Буквы декодируются в коды (alpha_core::CodeAlphabet), коды
+     * проходят transform, результат кодируется обратно в UTF-8.
+     */
+    ByteResult transformUtf8(const std::string& text, bool decrypt) const;
+};
@@ -0,0 +1,127 @@
+/**
+ * @file ProductCore.h
+ * @brief Заголовочное ядро продукционного шифра: замена + маршрутная перестановка
+ *
+ * @details
+ * Продукционный шифр - модифицированный алфавитный шифр (режим Filter),
+ * после которого буквы шифротекста переставляются табличным маршрутом
+ * TableRouteCipher (route_core::RightToLeftBottomUp: столбцы справа
+ * налево, снизу вверх).
+ *
+ * Оба шага выполняются за один проход: каждая буква сдвигается на ключ
+ * и сразу записывается в свою позицию после перестановки. Позиция
+ * вычисляется по геометрии таблицы (высоте столбцов), поэтому ни
+ * таблица, ни промежуточная строка не нужны. Дешифрование - точная
+ * обратная операция: k-я буква открытого текста читается из позиции
+ * маршрута и сдвигается обратно.
+ */
+
+#pragma once
+#include "modAlphaCore.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace product_core {
+
+/**
+ * @struct RouteColumns
+ * @brief Границы столбцов таблицы маршрута в шифротексте без самой таблицы
+ */
+struct RouteColumns {
+    size_t columns; ///< Число столбцов
+    size_t rows;    ///< Число строк
+    size_t full;    ///< Число столбцов высоты rows (остальные - rows - 1)
+
+    /**
+     * @param length Число букв
+     * @param columns Число столбцов
+     */
+    constexpr RouteColumns(size_t length, size_t columns) :
+        columns(columns),
+        rows((length + columns - 1) / columns),
+        full(length % columns == 0 ? columns : length % columns)
+    {
+    }
+
+    /**
+     * @brief Конец столбца j в шифротексте: сумма высот столбцов j..C-1
+     *
+     * Каждый из C - j столбцов имеет высоту не меньше rows - 1, и ещё
+     * по одной букве добавляют полные столбцы среди них.
+     */
+    constexpr size_t end(size_t j) const { return (columns - j) * (rows - 1) + (j < full ? full - j : 0); }
+};
+
+/**
+ * @brief Шифрует текст: сдвиг и перестановка за один проход
+ * @tparam Alphabet Алфавит alpha_core
+ * @param in Открытый текст
+ * @param n Длина открытого текста
+ * @param letters Число букв в нём (Alphabet::countLetters; больше 0)
+ * @param out Результат (letters символов)
+ * @param key Индексы ключа
+ * @param keySize Длина ключа
+ * @param columns Число столбцов
+ * @param preserveCase true - строчные буквы остаются строчными
+ *
+ * Буква в строке row и столбце column таблицы попадает в позицию
+ * end(column) - 1 - row: столбцы правее читаются раньше, а столбец -
+ * снизу вверх. Позиция вычисляется заново для каждой буквы, поэтому
+ * записи не зависят друг от друга.
+ */
+template <class Alphabet>
+constexpr void encrypt(const typename Alphabet::char_type* in, size_t n, size_t letters,
+                       typename Alphabet::char_type* out, const uint8_t* key, size_t keySize,
+                       size_t columns, bool preserveCase)
+{
+    const RouteColumns geometry(letters, columns);
+    size_t row = 0, column = 0, k = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned c = Alphabet::code(in[i]);
+        if (c == alpha_core::NOT_LETTER)
+            continue;
+        out[geometry.end(column) - 1 - row] =
+            Alphabet::symbol(alpha_core::shift(c & ~alpha_core::LOWER_FLAG, key[k], false),
+                             preserveCase && (c & alpha_core::LOWER_FLAG));
+        if (++k == keySize)
+            k = 0;
+        if (++column == columns) {
+            column = 0;
+            row++;
+        }
+    }
+}
+
+/**
+ * @brief Дешифрует текст: обратная перестановка и сдвиг за один проход
+ * @tparam Alphabet Алфавит alpha_core
+ * @param in Шифротекст (только допустимые буквы, n > 0)
+ * @param n Длина шифротекста
+ * @param out Результат (n символов, не пересекается с in)
+ * @param key Индексы ключа
+ * @param keySize Длина ключа
+ * @param columns Число столбцов
+ *
+ * Регистр сохраняется: строчные буквы допустимы во входе только с
+ * сохранением регистра.
+ */
+template <class Alphabet>
+constexpr void decrypt(const typename Alphabet::char_type* in, size_t n, typename Alphabet::char_type* out,
+                       const uint8_t* key, size_t keySize, size_t columns)
+{
+    const RouteColumns geometry(n, columns);
+    size_t row = 0, column = 0, k = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned c = Alphabet::code(in[geometry.end(column) - 1 - row]);
+        out[i] = Alphabet::symbol(alpha_core::shift(c & ~alpha_core::LOWER_FLAG, key[k], true),
+                                  (c & alpha_core::LOWER_FLAG) != 0);
+        if (++k == keySize)
+            k = 0;
+        if (++column == columns) {
+            column = 0;
+            row++;
+        }
+    }
+}
+
+} // namespace product_core
@@ -0,0 +1,319 @@
+/**
+ * @file main.cpp
+ * @brief Тестирование класса ProductCipher
+ * @author Генералов Л.К.
+ * @version 1.0
+ * @copyright ИБСТ ПГУ
+ * @date 2025
+ *
+ * @mainpage Продукционный шифр
+ *
+ * ## Описание проекта
+ *
+ * Продукционный шифр последовательно применяет два шифра проекта:
+ * модифицированный алфавитный шифр (modAlphaCipher, режим Filter) и
+ * маршрутную перестановку TableRouteCipher к буквам его шифротекста.
+ * Оба шага выполняются за один проход без промежуточных строк.
+ *
+ * ## Особенности
+ * - Результат совпадает с последовательным применением шифров
+ * - Один проход по тексту: сдвиг буквы и запись в позицию маршрута
+ * - Сохранение регистра букв
+ * - Байтовые кодировки CP1251, KOI8-R и UTF-8
+ * - Коды ошибок (tryEncrypt/tryDecrypt) и исключения cipher_error
+ *
+ * ## Структура проекта
+ * - `ProductCore.h` - заголовочное ядро (шаблоны по алфавиту)
+ * - `ProductCipher.h`, `ProductCipher.cpp` - класс шифра
+ * - `main.cpp` - тестирование и сравнение производительности
+ *
+ * ## Пример использования
+ * ```cpp
+ * ProductCipher cipher(L"КЛЮЧ", 3);
+ * wstring encrypted = cipher.encrypt(L"Привет, Мир!");
+ * wstring decrypted = cipher.decrypt(encrypted);  // ПРИВЕТМИР
+ * ```
+ */
+
+#include <chrono>
+#include <codecvt>
+#include <iostream>
+#include <locale>
+#include "ProductCipher.h"
+#include "TableRouteCore.h"
+
+using namespace std;
+
+/**
+ * @brief Текст исключения в широких символах
+ *
+ * Сообщения шифра перестановки - русские строки UTF-8, а вывод идёт в wcout.
+ */
+wstring message(const cipher_error& e)
+{
+    return wstring_convert<codecvt_utf8<wchar_t>>().from_bytes(e.what());
+}
+
+/**
+ * @brief Последовательное шифрование: modAlphaCipher, затем перестановка
+ * @param alpha Шифр замены (режим Filter)
+ * @param columns Число столбцов
+ * @param text Открытый текст
+ * @return Шифротекст
+ * @throw cipher_error если букв не больше числа столбцов
+ */
+wstring sequentialEncrypt(modAlphaCipher& alpha, size_t columns, const wstring& text)
+{
+    wstring letters = alpha.encrypt(text);
+    if (letters.size() <= columns)
+        throw cipher_error("Длина текста должна быть больше ключа (количества столбцов)");
+    wstring result(letters.size(), L'\0');
+    route_core::encryptRoute(letters.data(), letters.size(), columns, &result[0]);
+    return result;
+}
+
+/**
+ * @brief Последовательное дешифрование: перестановка, затем modAlphaCipher
+ */
+wstring sequentialDecrypt(modAlphaCipher& alpha, size_t columns, const wstring& text)
+{
+    wstring letters(text.size(), L'\0');
+    route_core::decryptRoute(text.data(), text.size(), columns, &letters[0]);
+    return alpha.decrypt(letters);
+}
+
+/**
+ * @brief Тестирует шифрование и сравнивает с последовательным применением шифров
+ * @param Text Исходный текст
+ * @param key Ключ замены
+ * @param columns Число столбцов
+ * @param preserveCase Сохранять регистр букв
+ * @param testName Название теста
+ */
+void check(const wstring& Text, const wstring& key, int columns, bool preserveCase, const wstring& testName)
+{
+    try {
+        wcout << L"=== " << testName << L" ===" << endl;
+        ProductCipher cipher(key, columns, preserveCase);
+        modAlphaCipher alpha(key, modAlphaCipher::TextMode::Filter, preserveCase);
+        wstring cipherText = cipher.encrypt(Text);
+        wstring decryptedText = cipher.decrypt(cipherText);
+        wstring sequential = sequentialEncrypt(alpha, columns, Text);
+
+        wcout << L"Ключи: " << key << L", " << columns << endl;
+        wcout << L"Исходный текст: " << Text << endl;
+        wcout << L"Зашифрованный: " << cipherText << endl;
+        wcout << L"Последовательно: " << sequential << endl;
+        wcout << L"Расшифрованный: " << decryptedText << endl;
+
+        if (cipherText == sequential && decryptedText == alpha.decrypt(alpha.encrypt(Text))
+            && sequentialDecrypt(alpha, columns, cipherText) == decryptedText)
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << message(e) << endl;
+    }
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует однобайтовую кодировку
+ * @param Text Исходный текст в кодировке encoding
+ * @param key Ключ замены
+ * @param columns Число столбцов
+ * @param encoding Кодировка
+ * @param testName Название теста
+ */
+void checkBytes(const string& Text, const wstring& key, int columns,
+                modAlphaCipher::Encoding encoding, const wstring& testName)
+{
+    try {
+        wcout << L"=== " << testName << L" ===" << endl;
+        ProductCipher cipher(key, columns);
+        modAlphaCipher alpha(key);
+        string cipherText = cipher.encrypt(Text, encoding);
+        string letters = alpha.encrypt(Text, encoding);
+        string sequential(letters.size(), '\0');
+        route_core::encryptRoute(letters.data(), letters.size(), static_cast<size_t>(columns), &sequential[0]);
+
+        wcout << L"Байт шифротекста: " << cipherText.size() << endl;
+        if (cipherText == sequential && cipher.decrypt(cipherText, encoding) == alpha.decrypt(letters, encoding))
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << message(e) << endl;
+    }
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует UTF-8 против широких строк
+ * @param Text Исходный текст
+ * @param key Ключ замены
+ * @param columns Число столбцов
+ * @param testName Название теста
+ *
+ * Шифротекст UTF-8 - это шифротекст std::wstring, записанный в UTF-8.
+ */
+void checkUtf8(const wstring& Text, const wstring& key, int columns, const wstring& testName)
+{
+    try {
+        wcout << L"=== " << testName << L" ===" << endl;
+        wstring_convert<codecvt_utf8<wchar_t>> utf8;
+        ProductCipher cipher(key, columns, true);
+        string text = utf8.to_bytes(Text);
+        string cipherText = cipher.encrypt(text, modAlphaCipher::Encoding::UTF8);
+        string decryptedText = cipher.decrypt(cipherText, modAlphaCipher::Encoding::UTF8);
+        ProductCipher::ByteResult invalid = cipher.tryDecrypt(cipherText + "!", modAlphaCipher::Encoding::UTF8);
+
+        wcout << L"Зашифрованный: " << utf8.from_bytes(cipherText) << endl;
+        wcout << L"Расшифрованный: " << utf8.from_bytes(decryptedText) << endl;
+        wstring wide = cipher.encrypt(Text);
+        if (cipherText == utf8.to_bytes(wide) && decryptedText == utf8.to_bytes(cipher.decrypt(wide))
+            && invalid.error == ProductCipher::Error::InvalidCipherText && invalid.position == cipherText.size())
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << message(e) << endl;
+    }
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует ошибки ключей и текста
+ * @param testName Название теста
+ *
+ * Каждая ошибка должна совпасть с ошибкой соответствующего шифра.
+ */
+void checkErrors(const wstring& testName)
+{
+    wcout << L"=== " << testName << L" ===" << endl;
+    size_t thrown = 0;
+    const pair<wstring, int> keys[] = {{L"", 3}, {L"ААА", 3}, {L"КЛЮЧ", 0}};
+    for (const auto& k : keys) {
+        try {
+            ProductCipher cipher(k.first, k.second);
+        } catch (const cipher_error& e) {
+            wcout << L"Ключи \"" << k.first << L"\", " << k.second << L": " << message(e) << endl;
+            thrown++;
+        }
+    }
+
+    ProductCipher cipher(L"КЛЮЧ", 4);
+    ProductCipher::Result shortText = cipher.tryEncrypt(L"При, в");
+    ProductCipher::Result noLetters = cipher.tryEncrypt(L"2025");
+    ProductCipher::Result invalid = cipher.tryDecrypt(L"ЪЬЖЩzЮ");
+    wcout << L"\"При, в\": "
+          << wstring_convert<codecvt_utf8<wchar_t>>().from_bytes(ProductCipher::errorMessage(shortText.error)) << endl;
+    wcout << L"\"ЪЬЖЩzЮ\": " << ProductCipher::errorMessage(invalid.error)
+          << L", позиция " << invalid.position << endl;
+
+    if (thrown == 3 && shortText.error == ProductCipher::Error::TextTooShort && shortText.position == 4
+        && noLetters.error == ProductCipher::Error::EmptyOpenText
+        && invalid.error == ProductCipher::Error::InvalidCipherText && invalid.position == 4)
+        wcout << L"[OK] Тест пройден\n";
+    else
+        wcout << L"[ERROR] Ошибка!\n";
+    wcout << endl;
+}
+
+/**
+ * @brief Сравнивает производительность с последовательным применением шифров
+ * @param length Длина сообщения в символах wchar_t
+ * @param rounds Число сообщений
+ * @param testName Название теста
+ *
+ * Шифрование и дешифрование одним проходом против modAlphaCipher и
+ * отдельной перестановки с промежуточными строками. Лучшее из трёх
+ * измерений каждого варианта.
+ */
+void checkThroughput(size_t length, int rounds, const wstring& testName)
+{
+    const int columns = 7;
+    const wstring alphabet = L"Съешь же ещё этих мягких французских булок, да выпей чаю. ";
+    wstring text;
+    for (size_t i = 0; i < length; i++)
+        text += alphabet[i % alphabet.size()];
+
+    ProductCipher cipher(L"КЛЮЧ", columns);
+    modAlphaCipher alpha(L"КЛЮЧ");
+    size_t check = 0;
+    auto measure = [&](auto&& roundTrip) {
+        double best = 0;
+        for (int attempt = 0; attempt < 3; attempt++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < rounds; i++)
+                check += roundTrip().size();
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            best = attempt == 0 || elapsed.count() < best ? elapsed.count() : best;
+        }
+        return best;
+    };
+    double fused = measure([&] { return cipher.decrypt(cipher.encrypt(text)); });
+    double sequential = measure([&] {
+        return sequentialDecrypt(alpha, columns, sequentialEncrypt(alpha, columns, text));
+    });
+    bool same = cipher.encrypt(text) == sequentialEncrypt(alpha, columns, text);
+
+    double megabytes = rounds * 2.0 * length * sizeof(wchar_t) / 1e6;
+    wcout << L"=== " << testName << L" ===" << endl;
+    wcout << L"Один проход: " << megabytes / fused << L" МБ/с" << endl;
+    wcout << L"Последовательно: " << megabytes / sequential << L" МБ/с" << endl;
+    wcout << L"Ускорение: " << sequential / fused << endl;
+    if (same && check > 0)
+        wcout << L"[OK] Тест пройден\n";
+    else
+        wcout << L"[ERROR] Ошибка!\n";
+    wcout << endl;
+}
+
+/**
+ * @brief Главная функция программы
+ * @return 0 при успешном выполнении
+ *
+ * 1. Сравнение с последовательным применением шифров
+ * 2. Сохранение регистра
+ * 3. Однобайтовые кодировки CP1251 и KOI8-R
+ * 4. UTF-8
+ * 5. Ошибки ключей и текста
+ * 6. Сравнение производительности
+ */
+int main()
+{
+    setlocale(LC_ALL, "en_US.UTF-8");
+    locale::global(locale("en_US.UTF-8"));
+    wcout.imbue(locale("en_US.UTF-8"));
+
+    wcout << L"=== ТЕСТИРОВАНИЕ ПРОДУКЦИОННОГО ШИФРА ===\n\n";
+
+    check(L"ПРИВЕТМИР", L"КЛЮЧ", 3, false, L"Русский текст");
+    check(L"Жил старик со своею старухой у самого синего моря", L"ШИФР", 5, false, L"Текст с пробелами");
+    check(L"Привет, Мир! 2025 год.", L"КЛЮЧ", 4, true, L"Сохранение регистра");
+
+    // "Привет, Мир!" в CP1251 и KOI8-R
+    checkBytes("\xCF\xF0\xE8\xE2\xE5\xF2, \xCC\xE8\xF0!", L"КЛЮЧ", 4,
+               modAlphaCipher::Encoding::CP1251, L"Кодировка CP1251");
+    checkBytes("\xF0\xD2\xC9\xD7\xC5\xD4, \xED\xC9\xD2!", L"КЛЮЧ", 4,
+               modAlphaCipher::Encoding::KOI8R, L"Кодировка KOI8-R");
+    checkUtf8(L"Съешь же ещё этих мягких французских булок, да выпей чаю!", L"КЛЮЧ", 4, L"Кодировка UTF-8");
+
+    checkErrors(L"Ошибки ключей и текста");
+    checkThroughput(1024, 2000, L"Производительность (сообщения по 4 КБ)");
+    checkThroughput(1 << 20, 4, L"Производительность (сообщения по 4 МБ)");
+
+    wcout << L"=== ТЕСТИРОВАНИЕ ЗАВЕРШЕНО ===\n";
+
+    // Счётчики стадий шифра (при сборке make STATS=1)
+    if (cipher_stats::enabled()) {
+        wcout.flush();
+        cipher_stats::report(cerr, cipher_stats::snapshot());
+    }
+
+    return 0;
+}
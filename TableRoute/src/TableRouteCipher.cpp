@@ -2,15 +2,12 @@
  * @file TableRouteCipher.cpp
  * @brief Реализация методов класса TableRouteCipher
  * 
- * Содержит реализацию алгоритма табличного маршрутного шифрования.
+ * Нешаблонная обёртка над ядром TableRouteCore.h: проверка ключа и
+ * текста, коды ошибок и исключения.
  */
 
 #include "TableRouteCipher.h"
 #include <stdexcept>
-#include <algorithm>
-#include <iostream>
-#include <vector>
-#include <cctype>
 
 /**
  * @brief Конструктор класса TableRouteCipher
@@ -31,106 +28,84 @@ TableRouteCipher::TableRouteCipher(int key)
  * @return Зашифрованный текст
  * @throw cipher_error Если текст невалиден или слишком короткий
  * 
+ * Обёртка над tryEncrypt, преобразующая код ошибки в исключение.
+ */
+std::string TableRouteCipher::encrypt(const std::string& text) const
+{
+    Result result = tryEncrypt(text);
+    if (!result) {
+        throw cipher_error(errorMessage(result.error));
+    }
+    return std::move(result.text);
+}
+
+/**
+ * @brief Дешифрование текста, зашифрованного методом табличного маршрутного преобразования
+ * @param text Зашифрованный текст
+ * @return Расшифрованный текст
+ * @throw cipher_error Если текст невалиден или слишком короткий
+ * 
+ * Обёртка над tryDecrypt, преобразующая код ошибки в исключение.
+ */
+std::string TableRouteCipher::decrypt(const std::string& text) const
+{
+    Result result = tryDecrypt(text);
+    if (!result) {
+        throw cipher_error(errorMessage(result.error));
+    }
+    return std::move(result.text);
+}
+
+/**
+ * @brief Шифрование текста без исключений
+ * @param text Текст для шифрования
+ * @return Зашифрованный текст или код ошибки
+ * 
  * @details Алгоритм:
  * 1. Валидация и очистка текста
  * 2. Проверка, что длина текста больше ключа
- * 3. Создание таблицы и заполнение построчно
- * 4. Чтение таблицы по столбцам справа налево снизу вверх
+ * 3. Перестановка route_core::encryptRoute: столбцы справа налево
+ *    снизу вверх, без построения таблицы
  */
-std::string TableRouteCipher::encrypt(const std::string& text)
+TableRouteCipher::Result TableRouteCipher::tryEncrypt(const std::string& text) const
 {
-    std::string validText = getValidText(text);
-    
-    // Проверка что текст БОЛЬШЕ ключа (количества столбцов)
-    if (validText.length() <= columns) {
-        throw cipher_error("Длина текста должна быть больше ключа (количества столбцов)");
+    Result result;
+    std::string validText;
+    if (!prepareText(text, validText, result)) {
+        return result;
     }
     
     size_t length = validText.length();
-    size_t rows = (length + columns - 1) / columns;
-
-    // Создаем таблицу и заполняем ее по строкам слева направо
-    std::vector<std::vector<char>> table(rows, std::vector<char>(columns, ' '));
-    size_t index = 0;
-    for (size_t i = 0; i < rows; i++) {
-        for (size_t j = 0; j < columns; j++) {
-            if (index < length) {
-                table[i][j] = validText[index++];
-            }
-        }
-    }
-
-    // Читаем по столбцам СНИЗУ ВВЕРХ, начиная с ПРАВОГО столбца
-    std::string result;
-    for (int j = columns - 1; j >= 0; j--) {
-        for (int i = rows - 1; i >= 0; i--) {
-            if (table[i][j] != ' ') {
-                result += table[i][j];
-            }
-        }
-    }
+    CIPHER_STAGE(RouteTranspose, length);
+    result.text.resize(length);
+    route_core::encryptRoute(validText.data(), length, columns, &result.text[0]);
     
     return result;
 }
 
 /**
- * @brief Дешифрование текста, зашифрованного методом табличного маршрутного преобразования
+ * @brief Дешифрование текста без исключений
  * @param text Зашифрованный текст
- * @return Расшифрованный текст
- * @throw cipher_error Если текст невалиден или слишком короткий
+ * @return Расшифрованный текст или код ошибки
  * 
  * @details Алгоритм:
  * 1. Валидация и очистка текста
  * 2. Проверка, что длина текста больше ключа
- * 3. Создание таблицы и заполнение по столбцам справа налево снизу вверх
- * 4. Чтение таблицы построчно слева направо
+ * 3. Обратная перестановка route_core::decryptRoute: k-я буква
+ *    шифротекста записывается в k-ю ячейку маршрута
  */
-std::string TableRouteCipher::decrypt(const std::string& text)
+TableRouteCipher::Result TableRouteCipher::tryDecrypt(const std::string& text) const
 {
-    std::string validText = getValidText(text);
-    
-    // Проверка что текст БОЛЬШЕ ключа (количества столбцов)
-    if (validText.length() <= columns) {
-        throw cipher_error("Длина текста должна быть больше ключа (количества столбцов)");
+    Result result;
+    std::string validText;
+    if (!prepareText(text, validText, result)) {
+        return result;
     }
     
     size_t length = validText.length();
-    size_t rows = (length + columns - 1) / columns;
-
-    // Создаем таблицу для заполнения
-    std::vector<std::vector<char>> table(rows, std::vector<char>(columns, ' '));
-    
-    // Определяем какие ячейки заполнены
-    std::vector<std::vector<bool>> filled(rows, std::vector<bool>(columns, false));
-    size_t total_filled = 0;
-    for (size_t i = 0; i < rows; i++) {
-        for (size_t j = 0; j < columns; j++) {
-            if (total_filled < length) {
-                filled[i][j] = true;
-                total_filled++;
-            }
-        }
-    }
-
-    // Заполняем таблицу по столбцам справа налево СНИЗУ ВВЕРХ
-    size_t text_index = 0;
-    for (int j = columns - 1; j >= 0; j--) {
-        for (int i = rows - 1; i >= 0; i--) {
-            if (filled[i][j] && text_index < length) {
-                table[i][j] = validText[text_index++];
-            }
-        }
-    }
-
-    // Читаем таблицу по строкам слева направо
-    std::string result;
-    for (size_t i = 0; i < rows; i++) {
-        for (size_t j = 0; j < columns; j++) {
-            if (filled[i][j]) {
-                result += table[i][j];
-            }
-        }
-    }
+    CIPHER_STAGE(RouteTranspose, length);
+    result.text.resize(length);
+    route_core::decryptRoute(validText.data(), length, columns, &result.text[0]);
     
     return result;
 }
@@ -152,26 +127,69 @@ size_t TableRouteCipher::getValidKey(int key)
 }
 
 /**
- * @brief Валидация и очистка входного текста
+ * @brief Очистка входного текста
  * @param text Входной текст для шифрования/дешифрования
- * @return Очищенный текст в верхнем регистре (только буквы)
- * @throw cipher_error Если текст пуст или не содержит букв
+ * @return Очищенный текст в верхнем регистре (только буквы, может быть пустым)
  * 
  * Удаляет все не-буквенные символы и преобразует текст в верхний регистр.
+ * Буквы - латинские A-Z и a-z, как у isalpha в локали "C".
+ * 
+ * Результат выделяется один раз на длину входа и заполняется
+ * route_core::extractLetters (SSE2-блоки по 16 байт).
  */
-std::string TableRouteCipher::getValidText(const std::string& text)
+std::string TableRouteCipher::getValidText(const std::string& text) const
 {
+    std::string result(text.size(), '\0');
+    result.resize(route_core::extractLetters(text.data(), text.size(), &result[0]));
+    return result;
+}
+
+/**
+ * @brief Валидация входного текста без исключений
+ * @param text Входной текст для шифрования/дешифрования
+ * @param validText Очищенный текст (выходной параметр)
+ * @param result Результат, в который записывается код ошибки
+ * @return true, если текст пригоден для шифрования/дешифрования
+ * 
+ * Текст должен быть непустым, содержать буквы, а число букв
+ * должно быть БОЛЬШЕ ключа (количества столбцов).
+ */
+bool TableRouteCipher::prepareText(const std::string& text, std::string& validText, Result& result) const
+{
+    CIPHER_STAGE(RouteValidate, text.size());
     if (text.empty()) {
-        throw cipher_error("Текст пуст");
+        result.error = Error::EmptyText;
+        return false;
     }
-    std::string result;
-    for (char c : text) {
-        if (isalpha(c)) {
-            result += toupper(c);
-        }
+    validText = getValidText(text);
+    if (validText.empty()) {
+        result.error = Error::NoLetters;
+        return false;
     }
-    if (result.empty()) {
-        throw cipher_error("Текст не содержит букв");
+    if (validText.length() <= columns) {
+        result.error = Error::TextTooShort;
+        result.position = validText.length();
+        return false;
     }
-    return result;
+    return true;
+}
+
+/**
+ * @brief Возвращает текст сообщения об ошибке
+ * @param error Код ошибки
+ * @return Сообщение, совпадающее с текстом cipher_error
+ */
+const char* TableRouteCipher::errorMessage(Error error)
+{
+    switch (error) {
+    case Error::None:
+        return "Нет ошибки";
+    case Error::EmptyText:
+        return "Текст пуст";
+    case Error::NoLetters:
+        return "Текст не содержит букв";
+    case Error::TextTooShort:
+        return "Длина текста должна быть больше ключа (количества столбцов)";
+    }
+    return "Неизвестная ошибка";
 }
@@ -2,7 +2,8 @@
  * @file TableRouteCipher.h
  * @brief Заголовочный файл класса TableRouteCipher для табличного маршрутного шифрования
  * 
- * Содержит объявление класса TableRouteCipher и класса исключений cipher_error.
+ * Содержит объявление класса TableRouteCipher; исключения cipher_error -
+ * общие для шифров проекта (CipherError.h).
  * Реализует алгоритм шифрования на основе табличного маршрутного преобразования.
  */
 
@@ -10,30 +11,9 @@
 #include <string>
 #include <vector>
 #include <stdexcept>
-
-/**
- * @class cipher_error
- * @brief Класс исключений для обработки ошибок шифрования
- * 
- * Наследуется от std::invalid_argument. Используется для передачи
- * информации об ошибках, возникающих при шифровании или дешифровании.
- */
-class cipher_error : public std::invalid_argument {
-public:
-    /**
-     * @brief Конструктор с std::string
-     * @param what_arg Сообщение об ошибке
-     */
-    explicit cipher_error(const std::string& what_arg) : 
-        std::invalid_argument(what_arg) {}
-    
-    /**
-     * @brief Конструктор с const char*
-     * @param what_arg Сообщение об ошибке
-     */
-    explicit cipher_error(const char* what_arg) : 
-        std::invalid_argument(what_arg) {}
-};
+#include "CipherError.h"
+#include "CipherStats.h"
+#include "TableRouteCore.h"
 
 /**
  * @class TableRouteCipher
@@ -43,6 +23,9 @@ public:
  * Текст записывается в таблицу построчно, а считывается по столбцам
  * справа налево снизу вверх.
  * 
+ * Методы шифрования const и потокобезопасны: один экземпляр можно
+ * использовать из нескольких потоков одновременно.
+ * 
  * @note Длина текста должна быть БОЛЬШЕ ключа (количества столбцов)
  */
 class TableRouteCipher
@@ -59,14 +42,44 @@ private:
     size_t getValidKey(int key);
     
     /**
-     * @brief Валидация и очистка входного текста
+     * @brief Очистка входного текста
      * @param text Входной текст для шифрования/дешифрования
-     * @return Очищенный текст в верхнем регистре (только буквы)
-     * @throw cipher_error Если текст пуст или не содержит букв
+     * @return Очищенный текст в верхнем регистре (только латинские буквы, может быть пустым)
      */
-    std::string getValidText(const std::string& text);
+    std::string getValidText(const std::string& text) const;
     
 public:
+    /**
+     * @enum Error
+     * @brief Коды ошибок обработки текста
+     */
+    enum class Error {
+        None,           ///< Ошибки нет
+        EmptyText,      ///< Текст пуст
+        NoLetters,      ///< Текст не содержит букв
+        TextTooShort    ///< Длина текста не больше ключа
+    };
+    
+    /**
+     * @struct Result
+     * @brief Результат шифрования или дешифрования без исключений
+     */
+    struct Result {
+        std::string text;                       ///< Результат (если ошибки нет)
+        Error error = Error::None;              ///< Код ошибки
+        size_t position = std::string::npos;    ///< Позиция ошибки (для TextTooShort - число букв в тексте)
+        
+        /// Истина, если ошибки нет
+        explicit operator bool() const { return error == Error::None; }
+    };
+    
+    /**
+     * @brief Возвращает текст сообщения об ошибке
+     * @param error Код ошибки
+     * @return Сообщение, совпадающее с текстом cipher_error
+     */
+    static const char* errorMessage(Error error);
+    
     TableRouteCipher() = delete; ///< Удаленный конструктор по умолчанию
     
     /**
@@ -87,7 +100,7 @@ public:
      * 2. Таблица считывается по столбцам справа налево снизу вверх
      * 3. Результат объединяется в зашифрованную строку
      */
-    std::string encrypt(const std::string& text);
+    std::string encrypt(const std::string& text) const;
     
     /**
      * @brief Дешифрование текста, зашифрованного методом табличного маршрутного преобразования
@@ -100,5 +113,29 @@ public:
      * 2. Таблица считывается построчно (слева направо)
      * 3. Результат объединяется в расшифрованную строку
      */
-    std::string decrypt(const std::string& text);
+    std::string decrypt(const std::string& text) const;
+    
+    /**
+     * @brief Шифрование текста без исключений
+     * @param text Текст для шифрования
+     * @return Зашифрованный текст или код ошибки
+     */
+    Result tryEncrypt(const std::string& text) const;
+    
+    /**
+     * @brief Дешифрование текста без исключений
+     * @param text Зашифрованный текст
+     * @return Расшифрованный текст или код ошибки
+     */
+    Result tryDecrypt(const std::string& text) const;
+    
+private:
+    /**
+     * @brief Валидация входного текста без исключений
+     * @param text Входной текст для шифрования/дешифрования
+     * @param validText Очищенный текст (выходной параметр)
+     * @param result Результат, в который записывается код ошибки
+     * @return true, если текст пригоден для шифрования/дешифрования
+     */
+    bool prepareText(const std::string& text, std::string& validText, Result& result) const;
 };
@@ -0,0 +1,238 @@
+/**
+ * @file TableRouteCore.h
+ * @brief Заголовочное шаблонное ядро табличного маршрутного шифра
+ *
+ * @details
+ * Очистка текста и перестановка по маршруту без построения таблицы.
+ * Перестановка параметризована типом символа и маршрутом (политикой с
+ * функцией forEach); маршрут шифра - RightToLeftBottomUp. Все функции
+ * определены в заголовке, поэтому вызывающий код с известным маршрутом
+ * и числом столбцов получает специализированную встроенную версию без
+ * LTO. Класс TableRouteCipher - нешаблонная обёртка над этими функциями.
+ *
+ * Функции без SIMD - constexpr и шифруют строковые литералы на этапе
+ * компиляции:
+ * ```
+ * constexpr auto secret = route_core::encryptLiteral("HELLOWORLD", 3);
+ * static_assert(secret[0] == 'L', "");
+ * ```
+ * Неположительный ключ, текст без букв или с числом букв не больше
+ * ключа в литерале - ошибка компиляции.
+ */
+
+#pragma once
+#include "CipherLiteral.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace route_core {
+
+/**
+ * @brief Прописная форма латинской буквы или 0 для остальных байтов
+ *
+ * Совпадает с isalpha/toupper в локали "C", но не зависит от
+ * глобальной локали и не вызывает функций на каждый байт.
+ */
+constexpr uint8_t upperLetter(unsigned c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<uint8_t>(c - 'a' + 'A')
+         : (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c) : 0;
+}
+
+#define ROUTE_LETTERS_4(i) upperLetter(i), upperLetter(i + 1), upperLetter(i + 2), upperLetter(i + 3)
+#define ROUTE_LETTERS_16(i) ROUTE_LETTERS_4(i), ROUTE_LETTERS_4(i + 4), ROUTE_LETTERS_4(i + 8), ROUTE_LETTERS_4(i + 12)
+#define ROUTE_LETTERS_64(i) ROUTE_LETTERS_16(i), ROUTE_LETTERS_16(i + 16), ROUTE_LETTERS_16(i + 32), ROUTE_LETTERS_16(i + 48)
+
+/// Байт -> прописная буква или 0, если байт не буква
+inline constexpr uint8_t UPPER_LETTER[256] = {
+    ROUTE_LETTERS_64(0), ROUTE_LETTERS_64(64), ROUTE_LETTERS_64(128), ROUTE_LETTERS_64(192)
+};
+
+#undef ROUTE_LETTERS_4
+#undef ROUTE_LETTERS_16
+#undef ROUTE_LETTERS_64
+
+static_assert(UPPER_LETTER[static_cast<unsigned char>('q')] == 'Q', "таблица букв");
+static_assert(UPPER_LETTER[static_cast<unsigned char>('@')] == 0, "таблица букв");
+
+/**
+ * @brief Копирует буквы в верхнем регистре без ветвлений
+ * @param in Вход
+ * @param n Длина входа
+ * @param out Выход (не меньше n байт)
+ * @param pos Позиция записи
+ * @return Новая позиция записи
+ */
+constexpr size_t compactLetters(const unsigned char* in, size_t n, char* out, size_t pos)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint8_t upper = UPPER_LETTER[in[i]];
+        out[pos] = static_cast<char>(upper);
+        pos += upper != 0;
+    }
+    return pos;
+}
+
+/**
+ * @brief Записывает буквы текста в верхнем регистре, отбрасывая остальное
+ * @param text Вход
+ * @param n Длина входа
+ * @param out Выход (не меньше n байт)
+ * @return Число букв
+ *
+ * Буквы - латинские A-Z и a-z, как у isalpha в локали "C". Блоки по
+ * 16 байт классифицируются SSE2: блок из одних букв копируется целиком
+ * с переводом в верхний регистр, блок без букв пропускается, остальные
+ * уплотняются по таблице без ветвлений.
+ */
+inline size_t extractLetters(const char* text, size_t n, char* out)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(text);
+    size_t pos = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    // Буква, если (c | 0x20) - 'a' < 26 без знака
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i first = _mm_set1_epi8('a');
+    const __m128i span = _mm_set1_epi8(25);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i offset = _mm_sub_epi8(_mm_or_si128(v, caseBit), first);
+        __m128i letters = _mm_cmpeq_epi8(_mm_min_epu8(offset, span), offset);
+        int mask = _mm_movemask_epi8(letters);
+        if (mask == 0xFFFF) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos), _mm_andnot_si128(caseBit, v));
+            pos += 16;
+        } else if (mask != 0) {
+            pos = compactLetters(in + i, 16, out, pos);
+        }
+    }
+#endif
+    return compactLetters(in + i, n - i, out, pos);
+}
+
+/**
+ * @struct RightToLeftBottomUp
+ * @brief Маршрут шифра: столбцы справа налево, в каждом снизу вверх
+ */
+struct RightToLeftBottomUp {
+    /**
+     * @brief Обходит ячейки таблицы в порядке маршрута
+     * @param length Число букв (ячеек таблицы)
+     * @param columns Число столбцов
+     * @param visit Вызывается с номером ячейки при записи по строкам
+     *
+     * Столбец j содержит ячейки i * columns + j < length, поэтому таблица
+     * не нужна: k-й вызов visit(cell) означает, что k-я буква шифротекста -
+     * это буква открытого текста с номером cell.
+     */
+    template <class Visit>
+    static constexpr void forEach(size_t length, size_t columns, Visit&& visit)
+    {
+        for (size_t j = columns < length ? columns : length; j-- > 0;) {
+            for (size_t i = (length - 1 - j) / columns + 1; i-- > 0;)
+                visit(i * columns + j);
+        }
+    }
+};
+
+/**
+ * @brief Переставляет символы по маршруту (шифрование)
+ * @tparam Route Маршрут
+ * @param in Текст, записанный в таблицу по строкам
+ * @param length Длина текста
+ * @param columns Число столбцов
+ * @param out Результат (length символов, не пересекается с in)
+ */
+template <class Route = RightToLeftBottomUp, class CharT>
+constexpr void encryptRoute(const CharT* in, size_t length, size_t columns, CharT* out)
+{
+    size_t k = 0;
+    Route::forEach(length, columns, [&](size_t cell) { out[k++] = in[cell]; });
+}
+
+/**
+ * @brief Обратная перестановка (дешифрование)
+ * @tparam Route Маршрут
+ * @param in Шифротекст
+ * @param length Длина текста
+ * @param columns Число столбцов
+ * @param out Результат (length символов, не пересекается с in)
+ */
+template <class Route = RightToLeftBottomUp, class CharT>
+constexpr void decryptRoute(const CharT* in, size_t length, size_t columns, CharT* out)
+{
+    size_t k = 0;
+    Route::forEach(length, columns, [&](size_t cell) { out[cell] = in[k++]; });
+}
+
+namespace detail {
+
+/**
+ * @brief Шифрует или дешифрует литерал
+ *
+ * Те же функции, что и в TableRouteCipher: небуквы отбрасываются, буквы
+ * переводятся в верхний регистр, число букв должно быть больше ключа.
+ */
+template <size_t N>
+constexpr CipherLiteral<char, N> transform(const char (&text)[N], int key, bool decrypt)
+{
+    if (key <= 0)
+        throw std::invalid_argument("Ключ должен быть положительным");
+    size_t length = 0;
+    while (length + 1 < N && text[length] != 0)
+        length++;
+    if (length == 0)
+        throw std::invalid_argument("Текст пуст");
+    unsigned char bytes[N] = {};
+    for (size_t i = 0; i < length; i++)
+        bytes[i] = static_cast<unsigned char>(text[i]);
+    CipherLiteral<char, N> letters;
+    letters.length = compactLetters(bytes, length, letters.chars, 0);
+    if (letters.size() == 0)
+        throw std::invalid_argument("Текст не содержит букв");
+    if (letters.size() <= static_cast<size_t>(key))
+        throw std::invalid_argument("Длина текста должна быть больше ключа (количества столбцов)");
+
+    CipherLiteral<char, N> result;
+    result.length = letters.size();
+    if (decrypt)
+        decryptRoute(letters.chars, letters.size(), static_cast<size_t>(key), result.chars);
+    else
+        encryptRoute(letters.chars, letters.size(), static_cast<size_t>(key), result.chars);
+    return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Шифрует строковый литерал на этапе компиляции
+ * @param text Открытый текст
+ * @param key Ключ (количество столбцов)
+ * @throw std::invalid_argument при ошибке; в константном выражении -
+ *        ошибка компиляции
+ */
+template <size_t N>
+CIPHER_CONSTEVAL CipherLiteral<char, N> encryptLiteral(const char (&text)[N], int key)
+{
+    return detail::transform(text, key, false);
+}
+
+/**
+ * @brief Дешифрует строковый литерал на этапе компиляции
+ * @param text Шифротекст
+ * @param key Ключ (количество столбцов)
+ * @throw std::invalid_argument при ошибке; в константном выражении -
+ *        ошибка компиляции
+ */
+template <size_t N>
+CIPHER_CONSTEVAL CipherLiteral<char, N> decryptLiteral(const char (&text)[N], int key)
+{
+    return detail::transform(text, key, true);
+}
+
+} // namespace route_core
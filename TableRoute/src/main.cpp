@@ -9,6 +9,16 @@
 #include <iostream>
 #include "TableRouteCipher.h"
 
+/// "Hello, World!", зашифрованный компилятором с ключом 3
+constexpr auto LITERAL_CIPHER = route_core::encryptLiteral("Hello, World!", 3);
+static_assert(LITERAL_CIPHER.size() == 10 && LITERAL_CIPHER[0] == 'L' && LITERAL_CIPHER[9] == 'H',
+              "constexpr encryption");
+
+/// Круговой путь на этапе компиляции
+constexpr auto LITERAL_ROUND_TRIP = route_core::decryptLiteral(LITERAL_CIPHER.chars, 3);
+static_assert(LITERAL_ROUND_TRIP.size() == 10 && LITERAL_ROUND_TRIP[0] == 'H'
+              && LITERAL_ROUND_TRIP[9] == 'D', "constexpr round trip");
+
 /**
  * @brief Функция автоматического тестирования TableRouteCipher
  * 
@@ -93,6 +103,32 @@ void testCipher() {
     } catch (const cipher_error& e) {
         std::cout << "[OK] РЕЗУЛЬТАТ: ТЕСТ ПРОЙДЕН - " << e.what() << std::endl;
     }
+    
+    // ТЕСТ 7: Обработка ошибки без исключения
+    std::cout << "\n--- ТЕСТ 7: Обработка без исключений ---" << std::endl;
+    std::cout << "Проверка: tryEncrypt('HI') с ключом 10" << std::endl;
+    std::cout << "Ожидание: код ошибки TextTooShort, позиция 2" << std::endl;
+    TableRouteCipher cipher7(10);
+    TableRouteCipher::Result result = cipher7.tryEncrypt("HI");
+    if (result.error == TableRouteCipher::Error::TextTooShort && result.position == 2) {
+        std::cout << "[OK] РЕЗУЛЬТАТ: ТЕСТ ПРОЙДЕН - "
+                  << TableRouteCipher::errorMessage(result.error) << std::endl;
+    } else {
+        std::cout << "[FAIL] РЕЗУЛЬТАТ: ТЕСТ ПРОВАЛЕН - Ожидался код ошибки" << std::endl;
+    }
+    
+    // ТЕСТ 8: Литерал, зашифрованный на этапе компиляции
+    std::cout << "\n--- ТЕСТ 8: Шифрование литерала на этапе компиляции ---" << std::endl;
+    std::cout << "Проверка: encryptLiteral('Hello, World!', 3) совпадает с encrypt" << std::endl;
+    std::cout << "Ожидание: одинаковый шифротекст и круговой путь" << std::endl;
+    TableRouteCipher cipher8(3);
+    if (LITERAL_CIPHER.str() == cipher8.encrypt("Hello, World!")
+        && LITERAL_ROUND_TRIP.str() == cipher8.decrypt(LITERAL_CIPHER.str())) {
+        std::cout << "[OK] РЕЗУЛЬТАТ: ТЕСТ ПРОЙДЕН" << std::endl;
+        std::cout << "  Зашифровано компилятором: " << LITERAL_CIPHER.c_str() << std::endl;
+    } else {
+        std::cout << "[FAIL] РЕЗУЛЬТАТ: ТЕСТ ПРОВАЛЕН - Шифротексты различаются" << std::endl;
+    }
 }
 
 /**
@@ -106,6 +142,12 @@ int main()
 {
     // Запускаем автоматические тесты
     testCipher();
+
+    // Счётчики стадий шифра (при сборке make STATS=1)
+    if (cipher_stats::enabled()) {
+        std::cout << "\n--- Счётчики стадий ---" << std::endl;
+        cipher_stats::report(std::cout, cipher_stats::snapshot());
+    }
     
     std::cout << "\n=== ИНТЕРАКТИВНЫЙ РЕЖИМ ===" << std::endl;
     std::cout << "Теперь вы можете протестировать шифрование вручную:" << std::endl;
@@ -0,0 +1,36 @@
+/**
+ * @file CipherError.h
+ * @brief Общий класс исключений шифров проекта
+ *
+ * Один cipher_error для modAlphaCipher, TableRouteCipher и ProductCipher:
+ * заголовки шифров можно подключать в одну единицу трансляции, а
+ * обработчик `catch (const cipher_error&)` ловит ошибки любого шифра.
+ */
+
+#pragma once
+#include <stdexcept>
+#include <string>
+
+/**
+ * @class cipher_error
+ * @brief Класс исключения для ошибок шифрования
+ *
+ * Наследуется от std::invalid_argument. Используется для обработки
+ * ошибок, связанных с валидацией ключа, текста и операциями шифрования.
+ */
+class cipher_error : public std::invalid_argument {
+public:
+    /**
+     * @brief Конструктор с строковым параметром
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit cipher_error(const std::string& what_arg) :
+        std::invalid_argument(what_arg) {}
+
+    /**
+     * @brief Конструктор с C-строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit cipher_error(const char* what_arg) :
+        std::invalid_argument(what_arg) {}
+};
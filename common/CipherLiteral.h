@@ -0,0 +1,52 @@
+/**
+ * @file CipherLiteral.h
+ * @brief Строка фиксированной ёмкости для шифрования на этапе компиляции
+ *
+ * Результат constexpr-шифрования строкового литерала: массив на N
+ * символов (размер исходного литерала с завершающим нулём) и длина.
+ * Пример:
+ * ```
+ * constexpr auto secret = alpha_core::encryptLiteral(L"ПРИВЕТ", L"КЛЮЧ");
+ * std::wstring text = secret.str();
+ * ```
+ * Переменная constexpr гарантирует, что шифротекст вычислен
+ * компилятором; ошибка в ключе или тексте - ошибка компиляции.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+/// consteval, если компилятор его поддерживает (C++20), иначе constexpr
+#if defined(__cpp_consteval)
+#define CIPHER_CONSTEVAL consteval
+#else
+#define CIPHER_CONSTEVAL constexpr
+#endif
+
+/**
+ * @struct CipherLiteral
+ * @brief Строка фиксированной ёмкости N, пригодная для constexpr
+ * @tparam CharT Тип символа
+ * @tparam N Ёмкость вместе с завершающим нулём
+ */
+template <class CharT, size_t N>
+struct CipherLiteral {
+    CharT chars[N] = {};    ///< Символы (всегда завершаются нулём)
+    size_t length = 0;      ///< Длина строки
+
+    /// Длина строки
+    constexpr size_t size() const { return length; }
+
+    /// Строка с завершающим нулём
+    constexpr const CharT* c_str() const { return chars; }
+
+    /// Символ по индексу
+    constexpr CharT operator[](size_t i) const { return chars[i]; }
+
+    /// Добавляет символ в конец
+    constexpr void push_back(CharT c) { chars[length++] = c; }
+
+    /// Копия в std::basic_string
+    std::basic_string<CharT> str() const { return std::basic_string<CharT>(chars, length); }
+};
@@ -0,0 +1,195 @@
+/**
+ * @file CipherStats.cpp
+ * @brief Хранение счётчиков стадий и подсчёт выделений памяти
+ *
+ * Без CIPHER_STATS единица трансляции пуста.
+ */
+
+#include "CipherStats.h"
+
+#ifdef CIPHER_STATS
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace cipher_stats {
+
+namespace detail {
+thread_local uint64_t threadAllocations = 0;
+}
+
+namespace {
+
+/// Поля StageCounters в порядке хранения
+enum Field { Calls, Cycles, Bytes, Allocations, FIELD_COUNT };
+
+struct ThreadCounters;
+
+/**
+ * @struct Registry
+ * @brief Счётчики живых потоков и сумма по завершившимся
+ */
+struct Registry {
+    std::mutex lock;                        ///< Защита полей
+    std::vector<ThreadCounters*> threads;   ///< Живые потоки
+    uint64_t retired[STAGE_COUNT][FIELD_COUNT] = {};  ///< Сумма завершившихся потоков
+};
+
+/**
+ * @brief Реестр (не уничтожается, чтобы пережить потоки при выходе)
+ */
+Registry& registry()
+{
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+/**
+ * @struct ThreadCounters
+ * @brief Счётчики одного потока
+ *
+ * Пишет только поток-владелец (load + store без атомарного сложения),
+ * snapshot() читает из других потоков.
+ */
+struct ThreadCounters {
+    std::atomic<uint64_t> values[STAGE_COUNT][FIELD_COUNT];
+
+    ThreadCounters()
+    {
+        for (auto& stage : values)
+            for (auto& v : stage)
+                v.store(0, std::memory_order_relaxed);
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        r.threads.push_back(this);
+    }
+
+    ~ThreadCounters()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (unsigned s = 0; s < STAGE_COUNT; s++)
+            for (unsigned f = 0; f < FIELD_COUNT; f++)
+                r.retired[s][f] += values[s][f].load(std::memory_order_relaxed);
+        r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+    }
+
+    void add(Stage stage, Field field, uint64_t value)
+    {
+        std::atomic<uint64_t>& v = values[stage][field];
+        v.store(v.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+thread_local ThreadCounters counters;
+
+} // namespace
+
+/**
+ * @brief Добавляет измерение к счётчикам текущего потока
+ */
+void detail::record(Stage stage, uint64_t cycles, uint64_t bytes, uint64_t allocations)
+{
+    counters.add(stage, Calls, 1);
+    counters.add(stage, Cycles, cycles);
+    counters.add(stage, Bytes, bytes);
+    counters.add(stage, Allocations, allocations);
+}
+
+/**
+ * @brief Суммирует счётчики всех потоков, включая завершившиеся
+ */
+Snapshot snapshot()
+{
+    uint64_t sum[STAGE_COUNT][FIELD_COUNT];
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (unsigned s = 0; s < STAGE_COUNT; s++) {
+            for (unsigned f = 0; f < FIELD_COUNT; f++) {
+                sum[s][f] = r.retired[s][f];
+                for (ThreadCounters* t : r.threads)
+                    sum[s][f] += t->values[s][f].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    Snapshot result;
+    for (unsigned s = 0; s < STAGE_COUNT; s++) {
+        result.stages[s].calls = sum[s][Calls];
+        result.stages[s].cycles = sum[s][Cycles];
+        result.stages[s].bytes = sum[s][Bytes];
+        result.stages[s].allocations = sum[s][Allocations];
+    }
+    return result;
+}
+
+/**
+ * @brief Обнуляет счётчики
+ */
+void reset()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    for (unsigned s = 0; s < STAGE_COUNT; s++) {
+        for (unsigned f = 0; f < FIELD_COUNT; f++) {
+            r.retired[s][f] = 0;
+            for (ThreadCounters* t : r.threads)
+                t->values[s][f].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace cipher_stats
+
+// Подсчёт выделений памяти: заменяются обычные формы operator new,
+// формы с выравниванием остаются стандартными и не учитываются
+
+void* operator new(std::size_t size)
+{
+    cipher_stats::detail::threadAllocations++;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    cipher_stats::detail::threadAllocations++;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#endif // CIPHER_STATS
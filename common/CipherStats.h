@@ -0,0 +1,227 @@
+/**
+ * @file CipherStats.h
+ * @brief Счётчики стадий шифрования (включаются при сборке)
+ *
+ * @details
+ * При сборке с -DCIPHER_STATS (`make STATS=1`) каждая отмеченная стадия
+ * шифра записывает в счётчики своего потока число вызовов, такты (rdtsc),
+ * обработанные байты и число выделений памяти. Байты всегда считаются
+ * в кодировке текста: для std::string - размер строки, для широких строк -
+ * длина того же текста в UTF-8 (encodedBytes), поэтому cyc/byte разных
+ * путей сравнимы. Выделения считает
+ * заменённый глобальный operator new (CipherStats.cpp). Счётчики
+ * завершившихся потоков не теряются, snapshot() суммирует все потоки.
+ *
+ * Без CIPHER_STATS макросы CIPHER_STAGE не порождают кода, а snapshot()
+ * возвращает нули.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ios>
+#include <ostream>
+#ifdef CIPHER_STATS
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace cipher_stats {
+
+/**
+ * @enum Stage
+ * @brief Стадии шифров
+ */
+enum Stage : unsigned {
+    AlphaValidate,      ///< modAlphaCipher: проверка шифротекста
+    AlphaShift,         ///< modAlphaCipher: фильтрация и сдвиг на ключ
+    RouteValidate,      ///< TableRouteCipher: очистка текста
+    RouteTranspose,     ///< TableRouteCipher: перестановка по маршруту
+    ProductValidate,    ///< ProductCipher: подсчёт букв, проверка шифротекста
+    ProductTransform,   ///< ProductCipher: сдвиг и перестановка за один проход
+    STAGE_COUNT         ///< Число стадий
+};
+
+/**
+ * @struct StageCounters
+ * @brief Счётчики одной стадии
+ */
+struct StageCounters {
+    uint64_t calls = 0;         ///< Вызовов
+    uint64_t cycles = 0;        ///< Тактов (rdtsc; без x86 - наносекунд)
+    uint64_t bytes = 0;         ///< Обработано байт входа в кодировке текста (encodedBytes)
+    uint64_t allocations = 0;   ///< Выделений памяти
+};
+
+/**
+ * @struct Snapshot
+ * @brief Сумма счётчиков всех потоков
+ */
+struct Snapshot {
+    StageCounters stages[STAGE_COUNT];  ///< Счётчики по стадиям
+};
+
+/**
+ * @brief Имя стадии
+ */
+inline const char* stageName(Stage stage)
+{
+    static const char* const names[STAGE_COUNT] = {
+        "alpha.validate", "alpha.shift",
+        "route.validate", "route.transpose",
+        "product.validate", "product.transform"
+    };
+    return stage < STAGE_COUNT ? names[stage] : "unknown";
+}
+
+/**
+ * @brief Длина текста в байтах кодировки
+ * @param text Текст
+ * @param length Длина в символах
+ * @return length для байтовых строк, длина в UTF-8 для широких
+ */
+template <class CharT>
+inline uint64_t encodedBytes(const CharT* text, size_t length)
+{
+    if constexpr (sizeof(CharT) == 1) {
+        (void)text;
+        return length;
+    } else {
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < length; i++) {
+            uint32_t code = static_cast<uint32_t>(text[i]);
+            bytes += code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+        }
+        return bytes;
+    }
+}
+
+#ifdef CIPHER_STATS
+
+/**
+ * @brief Счётчики включены при сборке
+ */
+constexpr bool enabled() { return true; }
+
+/**
+ * @brief Суммирует счётчики всех потоков, включая завершившиеся
+ */
+Snapshot snapshot();
+
+/**
+ * @brief Обнуляет счётчики
+ *
+ * Вызывать, когда потоки не шифруют: обнуление не синхронизировано
+ * с записью счётчиков.
+ */
+void reset();
+
+namespace detail {
+
+/// Выделений памяти текущим потоком (увеличивает operator new)
+extern thread_local uint64_t threadAllocations;
+
+/**
+ * @brief Добавляет измерение к счётчикам текущего потока
+ */
+void record(Stage stage, uint64_t cycles, uint64_t bytes, uint64_t allocations);
+
+/**
+ * @brief Текущее значение счётчика тактов
+ */
+inline uint64_t cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+} // namespace detail
+
+/**
+ * @class ScopedStage
+ * @brief Измеряет стадию от создания до конца области видимости
+ *
+ * Стадии не должны быть вложенными: выделения памяти вложенной
+ * стадии учитываются в обеих.
+ */
+class ScopedStage
+{
+private:
+    Stage stage;            ///< Стадия
+    uint64_t bytes;         ///< Байт входа
+    uint64_t allocations;   ///< Выделений памяти на входе в стадию
+    uint64_t start;         ///< Такты на входе в стадию
+
+public:
+    ScopedStage(Stage stage, uint64_t bytes) :
+        stage(stage), bytes(bytes), allocations(detail::threadAllocations), start(detail::cycles()) {}
+
+    ~ScopedStage()
+    {
+        uint64_t end = detail::cycles();
+        detail::record(stage, end - start, bytes, detail::threadAllocations - allocations);
+    }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+};
+
+#define CIPHER_STATS_JOIN2(a, b) a##b
+#define CIPHER_STATS_JOIN(a, b) CIPHER_STATS_JOIN2(a, b)
+
+/**
+ * @brief Измеряет стадию до конца текущего блока
+ * @param stage Имя стадии из cipher_stats::Stage
+ * @param bytes Байт входа в кодировке текста (без CIPHER_STATS не вычисляется)
+ */
+#define CIPHER_STAGE(stage, bytes) \
+    ::cipher_stats::ScopedStage CIPHER_STATS_JOIN(cipherStage, __LINE__)(::cipher_stats::stage, (bytes))
+
+#else
+
+constexpr bool enabled() { return false; }
+inline Snapshot snapshot() { return Snapshot(); }
+inline void reset() {}
+
+#define CIPHER_STAGE(stage, bytes) ((void)0)
+
+#endif // CIPHER_STATS
+
+/**
+ * @brief Выводит таблицу счётчиков
+ * @param out Поток вывода
+ * @param s Снимок счётчиков
+ *
+ * Стадии без вызовов пропускаются. Флаги форматирования и точность
+ * потока восстанавливаются.
+ */
+inline void report(std::ostream& out, const Snapshot& s)
+{
+    std::ios state(nullptr);
+    state.copyfmt(out);
+    out << std::left << std::setw(20) << "stage" << std::right
+        << std::setw(10) << "calls" << std::setw(16) << "cycles"
+        << std::setw(14) << "bytes" << std::setw(10) << "cyc/byte"
+        << std::setw(10) << "allocs" << "\n";
+    for (unsigned i = 0; i < STAGE_COUNT; i++) {
+        const StageCounters& c = s.stages[i];
+        if (c.calls == 0)
+            continue;
+        out << std::left << std::setw(20) << stageName(static_cast<Stage>(i)) << std::right
+            << std::setw(10) << c.calls << std::setw(16) << c.cycles
+            << std::setw(14) << c.bytes << std::setw(10) << std::fixed << std::setprecision(2)
+            << (c.bytes ? static_cast<double>(c.cycles) / c.bytes : 0.0)
+            << std::setw(10) << c.allocations << "\n";
+    }
+    out.copyfmt(state);
+}
+
+} // namespace cipher_stats
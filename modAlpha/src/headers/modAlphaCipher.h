@@ -12,36 +12,17 @@
  */
 
 #pragma once
-#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <locale>
 #include <codecvt>
 #include <stdexcept>
-
-/**
- * @class cipher_error
- * @brief Класс исключения для ошибок шифрования
- * 
- * Наследуется от std::invalid_argument. Используется для обработки
- * ошибок, связанных с валидацией ключа, текста и операциями шифрования.
- */
-class cipher_error : public std::invalid_argument {
-public:
-    /**
-     * @brief Конструктор с строковым параметром
-     * @param what_arg Сообщение об ошибке
-     */
-    explicit cipher_error(const std::string& what_arg) : 
-        std::invalid_argument(what_arg) {}
-    
-    /**
-     * @brief Конструктор с C-строкой
-     * @param what_arg Сообщение об ошибке
-     */
-    explicit cipher_error(const char* what_arg) : 
-        std::invalid_argument(what_arg) {}
-};
+#include <cstddef>
+#include <cstdint>
+#include "CipherError.h"
+#include "CipherStats.h"
+#include "modAlphaCore.h"
 
 /**
  * @class modAlphaCipher
@@ -50,73 +31,206 @@ public:
  * Класс реализует модифицированный алфавитный шифр с поддержкой
  * русского алфавита. Шифрование происходит путем сдвига символов
  * на основе ключа.
+ *
+ * Таблицы алфавита - общие constexpr-таблицы alpha_core, поэтому объект
+ * хранит только ключ и режим: ключ до INLINE_KEY букв лежит в самом
+ * объекте (48 байт на x86-64), и конструктор не выделяет память.
+ *
+ * Методы шифрования const и не изменяют общего состояния, поэтому один
+ * экземпляр можно использовать из нескольких потоков одновременно.
+ *
+ * Режим Passthrough, в отличие от Filter, не считает ошибкой непустой
+ * текст без букв и возвращает его без изменений (см. TextMode).
  */
 class modAlphaCipher
 {
 private:
-    /// Русский алфавит в верхнем регистре (33 буквы)
-    std::wstring numAlpha = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    /// Длина ключа, хранимого в объекте без выделения памяти
+    static constexpr size_t INLINE_KEY = 16;
+    
+    /// Ключ до INLINE_KEY букв (индексы 0..32)
+    uint8_t inlineKey[INLINE_KEY];
+    
+    /// Ключ длиннее INLINE_KEY букв; не изменяется, поэтому общий для копий
+    std::shared_ptr<const uint8_t[]> longKey;
+    
+    /// Длина ключа
+    size_t keySize;
+    
+    /// Индексы букв ключа
+    const uint8_t* key() const { return longKey ? longKey.get() : inlineKey; }
     
-    /// Отображение символов в числовые индексы
-    std::map<wchar_t, int> alphaNum;
+    /**
+     * @brief Валидирует ключ шифрования и сохраняет его индексы
+     * @param s Входной ключ
+     * @throw cipher_error если ключ пустой, содержит недопустимые символы
+     *        или слабый
+     */
+    void setValidKey(const std::wstring& s);
     
-    /// Ключ шифрования в числовом представлении
-    std::vector<int> key;
+public:
+    /**
+     * @enum Error
+     * @brief Коды ошибок обработки текста
+     */
+    enum class Error {
+        None,               ///< Ошибки нет
+        EmptyOpenText,      ///< Открытый текст не содержит букв
+        EmptyCipherText,    ///< Пустой шифротекст
+        InvalidCipherText,  ///< Недопустимый символ в шифротексте
+        UnsupportedMode,    ///< Операция недоступна в текущем режиме
+        InvalidRange        ///< Окно пустое или вне текста, индекс от текста другой длины
+    };
     
     /**
-     * @brief Преобразует строку в вектор числовых индексов
-     * @param s Входная строка
-     * @return Вектор индексов символов в алфавите
+     * @enum TextMode
+     * @brief Режим обработки небуквенных символов
+     *
+     * Режимы по-разному обрабатывают непустой текст без букв. Filter
+     * удаляет всё, поэтому шифрование даёт EmptyOpenText, а дешифрование -
+     * InvalidCipherText. Passthrough сохраняет длину текста: такой текст
+     * возвращается без изменений и без ошибки, чтобы строки документа без
+     * букв (пустые абзацы, числа, разметка) проходили на месте. Пустой
+     * текст - ошибка в обоих режимах (EmptyOpenText или EmptyCipherText).
      */
-    std::vector<int> convert(const std::wstring& s);
+    enum class TextMode {
+        Filter,         ///< Небуквенные символы удаляются, результат в верхнем регистре
+                        ///< (или в регистре исходных букв при сохранении регистра)
+        Passthrough     ///< Небуквенные символы остаются на своих местах
+    };
     
     /**
-     * @brief Преобразует вектор числовых индексов в строку
-     * @param v Вектор индексов
-     * @return Строка символов
+     * @struct Result
+     * @brief Результат шифрования или дешифрования без исключений
      */
-    std::wstring convert(const std::vector<int>& v);
+    struct Result {
+        std::wstring text;                       ///< Результат (если ошибки нет)
+        Error error = Error::None;               ///< Код ошибки
+        size_t position = std::wstring::npos;    ///< Позиция ошибочного символа
+        
+        /// Истина, если ошибки нет
+        explicit operator bool() const { return error == Error::None; }
+    };
     
-    // Вспомогательные методы для проверки символов
-    bool isValidChar(wchar_t c);
-    bool isUpperChar(wchar_t c);
-    wchar_t toUpperChar(wchar_t c);
+    /**
+     * @enum Encoding
+     * @brief Кодировка текста для байтовых методов
+     */
+    enum class Encoding {
+        CP1251,         ///< Windows-1251
+        KOI8R,          ///< KOI8-R
+        UTF8            ///< UTF-8: буква - два байта, остальные символы не проверяются
+    };
     
     /**
-     * @brief Валидирует ключ шифрования
-     * @param s Входной ключ
-     * @return Валидный ключ в верхнем регистре
-     * @throw cipher_error если ключ пустой или содержит недопустимые символы
+     * @struct ByteResult
+     * @brief Результат байтового шифрования или дешифрования без исключений
      */
-    inline std::wstring getValidKey(const std::wstring& s);
+    struct ByteResult {
+        std::string text;                        ///< Результат в той же кодировке (если ошибки нет)
+        Error error = Error::None;               ///< Код ошибки
+        size_t position = std::string::npos;     ///< Позиция ошибочного байта (начала буквы UTF-8)
+        
+        /// Истина, если ошибки нет
+        explicit operator bool() const { return error == Error::None; }
+    };
     
     /**
-     * @brief Валидирует открытый текст
-     * @param s Входной текст
-     * @return Валидный текст в верхнем регистре
-     * @throw cipher_error если текст пустой после фильтрации
+     * @struct SeekIndex
+     * @brief Разреженный индекс числа букв для произвольного доступа
+     *
+     * letters[i] - число букв (обоих регистров) в первых i * stride
+     * символах текста. Строится один раз за O(n) (buildSeekIndex) и
+     * занимает size / stride + 1 чисел.
+     *
+     * В режиме Passthrough индекс строится по шифротексту: позиция в
+     * ключе для окна - число букв перед ним, а с индексом оно считается
+     * за O(stride) вместо O(offset).
+     *
+     * В режиме Filter шифротекст состоит из одних букв и индекс для
+     * дешифрования не нужен. Его строят по открытому тексту при
+     * шифровании: letters[i] - смещение в шифротексте, с которого
+     * начинается открытый текст с позиции i * stride, поэтому блоки
+     * открытого текста находятся в шифротексте без самого открытого текста.
      */
-    inline std::wstring getValidOpenText(const std::wstring& s);
+    struct SeekIndex {
+        size_t stride = 0;              ///< Шаг индекса, символов
+        size_t size = 0;                ///< Длина проиндексированного текста
+        std::vector<size_t> letters;    ///< Число букв перед позицией i * stride
+    };
     
     /**
-     * @brief Валидирует зашифрованный текст
-     * @param s Входной зашифрованный текст
-     * @return Валидный зашифрованный текст
-     * @throw cipher_error если текст пустой или содержит строчные буквы
+     * @brief Возвращает текст сообщения об ошибке
+     * @param error Код ошибки
+     * @return Сообщение, совпадающее с текстом cipher_error
      */
-    inline std::wstring getValidCipherText(const std::wstring& s);
+    static const char* errorMessage(Error error);
+    
+    /**
+     * @brief Строит индекс числа букв текста
+     * @param text Текст (шифротекст Passthrough или открытый текст Filter)
+     * @param stride Шаг индекса, символов
+     * @return Индекс
+     * @throw cipher_error если шаг равен нулю
+     */
+    static SeekIndex buildSeekIndex(const std::wstring& text, size_t stride = 4096);
+    
+    /**
+     * @brief Строит индекс числа букв текста в байтовой кодировке
+     * @param text Текст в кодировке encoding
+     * @param encoding Кодировка
+     * @param stride Шаг индекса, байт
+     * @return Индекс
+     * @throw cipher_error если шаг равен нулю
+     *
+     * Буква UTF-8 на границе блоков учитывается в блоке, где она
+     * начинается.
+     */
+    static SeekIndex buildSeekIndex(const std::string& text, Encoding encoding, size_t stride = 4096);
+    
+    /**
+     * @brief Считает буквы текста в байтовой кодировке
+     * @param text Текст в кодировке encoding
+     * @param encoding Кодировка
+     * @return Число букв обоих регистров (длина потока для position)
+     */
+    static size_t countLetters(const std::string& text, Encoding encoding);
     
-public:
     /// Конструктор по умолчанию удален
     modAlphaCipher() = delete;
     
     /**
      * @brief Конструктор с ключом
      * @param skey Ключ шифрования
+     * @param mode Режим обработки небуквенных символов
+     * @param preserveCase Сохранять регистр букв
      * @throw cipher_error если ключ пустой, содержит недопустимые символы
      *        или является слабым (все символы одинаковые)
+     * 
+     * В режиме Passthrough ключ сдвигается только на буквах, а длина
+     * результата совпадает с длиной входного текста. С сохранением
+     * регистра строчная буква шифруется в строчную в обоих режимах,
+     * а в режиме Filter шифротекст может содержать строчные буквы.
      */
-    modAlphaCipher(const std::wstring& skey);
+    modAlphaCipher(const std::wstring& skey, TextMode mode = TextMode::Filter,
+                   bool preserveCase = false);
+    
+    /**
+     * @brief Шифр над готовыми индексами ключа без копирования
+     * @param owner Владелец памяти ключа (например, отображение файла
+     *        ключей); шифр и его копии удерживают его
+     * @param key Индексы букв ключа 0..32
+     * @param size Длина ключа
+     * @param mode Режим обработки небуквенных символов
+     * @param preserveCase Сохранять регистр букв
+     * @return Шифр, ссылающийся на key
+     * @throw cipher_error если ключ пустой, индекс вне алфавита или ключ слабый
+     * 
+     * Ключ не переводится из букв и не копируется: проверка - один проход
+     * по индексам, память не выделяется.
+     */
+    static modAlphaCipher fromIndices(const std::shared_ptr<const void>& owner, const uint8_t* key, size_t size,
+                                      TextMode mode = TextMode::Filter, bool preserveCase = false);
     
     /**
      * @brief Шифрует текст
@@ -124,71 +238,217 @@ public:
      * @return Зашифрованный текст
      * @throw cipher_error если текст пустой после фильтрации
      */
-    std::wstring encrypt(const std::wstring& open_text);
+    std::wstring encrypt(const std::wstring& open_text) const;
     
     /**
      * @brief Дешифрует текст
      * @param cipher_text Зашифрованный текст
      * @return Расшифрованный текст
-     * @throw cipher_error если текст пустой или содержит строчные буквы
+     * @throw cipher_error если текст пустой или содержит небуквенные символы
+     *        (или строчные буквы без сохранения регистра)
      */
-    std::wstring decrypt(const std::wstring& cipher_text);
-};
-
-// Реализация inline методов после объявления класса
-
-inline bool modAlphaCipher::isValidChar(wchar_t c) {
-    // Проверяем только русские буквы
-    return (c >= L'А' && c <= L'Я') || (c >= L'а' && c <= L'я') || c == L'Ё' || c == L'ё';
-}
-
-inline bool modAlphaCipher::isUpperChar(wchar_t c) {
-    // Проверяем только прописные русские буквы
-    return (c >= L'А' && c <= L'Я') || c == L'Ё';
-}
-
-inline wchar_t modAlphaCipher::toUpperChar(wchar_t c) {
-    // Преобразуем в прописные русские буквы
-    if (c >= L'а' && c <= L'я') return c - L'а' + L'А';
-    if (c == L'ё') return L'Ё';
-    return c;
-}
-
-inline std::wstring modAlphaCipher::getValidKey(const std::wstring& s)
-{
-    if (s.empty())
-        throw cipher_error("Empty key");
-    
-    std::wstring tmp(s);
-    for (auto & c:tmp) {
-        if (!isValidChar(c))
-            throw cipher_error("Invalid key");
-        c = toUpperChar(c);
-    }
-    return tmp;
-}
-
-inline std::wstring modAlphaCipher::getValidOpenText(const std::wstring& s)
-{
-    std::wstring tmp;
-    for (auto c:s) {
-        if (isValidChar(c)) {
-            tmp.push_back(toUpperChar(c));
-        }
-    }
-    if (tmp.empty())
-        throw cipher_error("Empty open text");
-    return tmp;
-}
-
-inline std::wstring modAlphaCipher::getValidCipherText(const std::wstring& s)
-{
-    if (s.empty())
-        throw cipher_error("Empty cipher text");
+    std::wstring decrypt(const std::wstring& cipher_text) const;
     
-    for (auto c:s) {
-        if (!isUpperChar(c))
-            throw cipher_error("Invalid cipher text");
+    /**
+     * @brief Шифрует текст без исключений
+     * @param open_text Открытый текст для шифрования
+     * @param position Число букв потока перед текстом: первая буква
+     *        шифруется буквой ключа с номером position mod длина ключа
+     * @return Зашифрованный текст или код ошибки EmptyOpenText
+     * 
+     * С position текст шифруется как продолжение потока, поэтому
+     * фрагменты потока можно шифровать и дешифровать независимо.
+     */
+    Result tryEncrypt(const std::wstring& open_text, size_t position = 0) const;
+    
+    /**
+     * @brief Дешифрует текст без исключений
+     * @param cipher_text Зашифрованный текст
+     * @param position Число букв потока перед текстом (см. tryEncrypt)
+     * @return Расшифрованный текст или код ошибки EmptyCipherText,
+     *         InvalidCipherText (с позицией недопустимого символа)
+     */
+    Result tryDecrypt(const std::wstring& cipher_text, size_t position = 0) const;
+    
+    /**
+     * @brief Дешифрует окно шифротекста
+     * @param cipher_text Весь шифротекст
+     * @param offset Начало окна
+     * @param length Длина окна (обрезается по концу текста)
+     * @param index Индекс шифротекста (buildSeekIndex) или nullptr;
+     *        используется только в режиме Passthrough
+     * @return Открытый текст окна
+     * @throw cipher_error если окно пустое или вне текста, индекс построен
+     *        по тексту другой длины, или окно содержит недопустимые символы
+     *
+     * Результат совпадает с частью decrypt(cipher_text), соответствующей
+     * окну, но проверяется и обрабатывается только окно: O(length) в
+     * режиме Filter и O(length + stride) в режиме Passthrough с индексом
+     * (без индекса буквы перед окном считаются заново).
+     */
+    std::wstring decryptRange(const std::wstring& cipher_text, size_t offset, size_t length,
+                              const SeekIndex* index = nullptr) const;
+    
+    /**
+     * @brief Дешифрует окно шифротекста без исключений
+     * @return Открытый текст окна или код ошибки EmptyCipherText,
+     *         InvalidRange, InvalidCipherText (с позицией во всём шифротексте)
+     */
+    Result tryDecryptRange(const std::wstring& cipher_text, size_t offset, size_t length,
+                           const SeekIndex* index = nullptr) const;
+    
+    /**
+     * @brief Шифрует текст на месте (режим Passthrough)
+     * @param text Текст, заменяемый зашифрованным
+     * @return Error::None, EmptyOpenText или UnsupportedMode в режиме Filter
+     */
+    Error encryptInPlace(std::wstring& text) const;
+    
+    /**
+     * @brief Дешифрует текст на месте (режим Passthrough)
+     * @param text Текст, заменяемый расшифрованным
+     * @return Error::None, EmptyCipherText или UnsupportedMode в режиме Filter
+     */
+    Error decryptInPlace(std::wstring& text) const;
+    
+    /**
+     * @brief Шифрует текст в байтовой кодировке
+     * @param open_text Открытый текст в кодировке encoding
+     * @param encoding Кодировка входа и результата
+     * @return Зашифрованный текст
+     * @throw cipher_error если текст не содержит букв
+     * 
+     * Результат совпадает с encrypt() для того же текста, декодированного
+     * в std::wstring, но без преобразования в широкие символы и без локали.
+     * Буквы UTF-8 декодируются векторами SSE2 по 8 букв прямо в индексы
+     * алфавита и записываются обратно по 16 букв за шаг; текст с другими
+     * символами - попарно.
+     */
+    std::string encrypt(const std::string& open_text, Encoding encoding) const;
+    
+    /**
+     * @brief Дешифрует текст в байтовой кодировке
+     * @param cipher_text Зашифрованный текст в кодировке encoding
+     * @param encoding Кодировка входа и результата
+     * @return Расшифрованный текст
+     * @throw cipher_error если текст пустой или содержит недопустимые символы
+     */
+    std::string decrypt(const std::string& cipher_text, Encoding encoding) const;
+    
+    /**
+     * @brief Шифрует текст в байтовой кодировке без исключений
+     * @param open_text Открытый текст в кодировке encoding
+     * @param encoding Кодировка входа и результата
+     * @param position Число букв потока перед текстом (см. tryEncrypt)
+     * @return Зашифрованный текст или код ошибки EmptyOpenText
+     */
+    ByteResult tryEncrypt(const std::string& open_text, Encoding encoding, size_t position = 0) const;
+    
+    /**
+     * @brief Дешифрует текст в байтовой кодировке без исключений
+     * @param cipher_text Зашифрованный текст в кодировке encoding
+     * @param encoding Кодировка входа и результата
+     * @param position Число букв потока перед текстом (см. tryEncrypt)
+     * @return Расшифрованный текст или код ошибки EmptyCipherText,
+     *         InvalidCipherText (с позицией недопустимого байта)
+     */
+    ByteResult tryDecrypt(const std::string& cipher_text, Encoding encoding, size_t position = 0) const;
+    
+    /**
+     * @brief Дешифрует окно шифротекста в байтовой кодировке
+     * @throw cipher_error при ошибке (см. decryptRange для std::wstring)
+     */
+    std::string decryptRange(const std::string& cipher_text, Encoding encoding, size_t offset, size_t length,
+                             const SeekIndex* index = nullptr) const;
+    
+    /**
+     * @brief Дешифрует окно шифротекста в байтовой кодировке без исключений
+     * @return Открытый текст окна или код ошибки с позицией во всём шифротексте;
+     *         окно, начало или конец которого разрезает букву UTF-8, - InvalidRange
+     */
+    ByteResult tryDecryptRange(const std::string& cipher_text, Encoding encoding, size_t offset, size_t length,
+                               const SeekIndex* index = nullptr) const;
+    
+    /**
+     * @brief Шифрует текст в байтовой кодировке на месте (режим Passthrough)
+     * @param text Текст, заменяемый зашифрованным
+     * @param encoding Кодировка текста
+     * @return Error::None, EmptyOpenText или UnsupportedMode в режиме Filter
+     */
+    Error encryptInPlace(std::string& text, Encoding encoding) const;
+    
+    /**
+     * @brief Дешифрует текст в байтовой кодировке на месте (режим Passthrough)
+     * @param text Текст, заменяемый расшифрованным
+     * @param encoding Кодировка текста
+     * @return Error::None, EmptyCipherText или UnsupportedMode в режиме Filter
+     */
+    Error decryptInPlace(std::string& text, Encoding encoding) const;
+    
+private:
+    /// Режим обработки небуквенных символов
+    TextMode mode;
+    
+    /// Сохранять регистр букв
+    bool preserveCase;
+    
+    /// Шифр без ключа: ключ задаёт fromIndices
+    modAlphaCipher(TextMode mode, bool preserveCase) :
+        inlineKey(), keySize(0), mode(mode), preserveCase(preserveCase) {}
+    
+    /**
+     * @brief Ядра сдвига алфавита Alphabet для длины ключа
+     *
+     * Выбор - несколько сравнений (alpha_core::selectKernels), поэтому
+     * ядра выбираются при каждом вызове, а не хранятся в объекте.
+     */
+    template <class Alphabet>
+    const alpha_core::Kernels<Alphabet>& kernelsFor() const
+    {
+        return alpha_core::selectKernels<Alphabet>(keySize);
     }
-    return s;
-}
+    
+    /**
+     * @brief Шифрует или дешифрует текст алфавитом Alphabet
+     * @tparam Alphabet Алфавит ядра (alpha_core::WideAlphabet, Cp1251Alphabet, Koi8rAlphabet,
+     *         Utf8Alphabet)
+     * @tparam ResultT Result или ByteResult
+     * @param text Входной текст
+     * @param decrypt true - дешифрование
+     * @param phase Позиция в ключе для первой буквы
+     * 
+     * Определён в modAlphaCipher.cpp: все открытые методы сводятся к нему
+     * и к transformInPlace.
+     */
+    template <class Alphabet, class ResultT>
+    ResultT transform(const std::basic_string<typename Alphabet::char_type>& text, bool decrypt,
+                      size_t phase) const;
+    
+    /**
+     * @brief Шифрует или дешифрует текст на месте (режим Passthrough)
+     * @tparam Alphabet Алфавит ядра
+     * @param text Текст, заменяемый результатом
+     * @param decrypt true - дешифрование
+     * @param phase Позиция в ключе для первой буквы
+     * @return Код ошибки
+     */
+    template <class Alphabet>
+    Error transformInPlace(std::basic_string<typename Alphabet::char_type>& text, bool decrypt,
+                           size_t phase = 0) const;
+    
+    /**
+     * @brief Дешифрует окно шифротекста алфавитом Alphabet
+     * @tparam Alphabet Алфавит ядра
+     * @tparam ResultT Result или ByteResult
+     */
+    template <class Alphabet, class ResultT>
+    ResultT transformRange(const std::basic_string<typename Alphabet::char_type>& text, size_t offset,
+                           size_t length, const SeekIndex* index) const;
+    
+    /**
+     * @brief Строит индекс числа букв алфавитом Alphabet
+     * @tparam Alphabet Алфавит ядра
+     */
+    template <class Alphabet>
+    static SeekIndex seekIndex(const std::basic_string<typename Alphabet::char_type>& text, size_t stride);
+};
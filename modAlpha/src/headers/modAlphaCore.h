@@ -0,0 +1,1247 @@
+/**
+ * @file modAlphaCore.h
+ * @brief Заголовочное шаблонное ядро модифицированного алфавитного шифра
+ *
+ * @details
+ * Алгоритмы шифра параметризованы алфавитом (политикой), который задаёт
+ * тип символа, классификацию букв и быструю проверку шифротекста:
+ * - WideAlphabet - русский алфавит в wchar_t;
+ * - Cp1251Alphabet, Koi8rAlphabet - тот же алфавит в однобайтовых
+ *   кодировках (таблицы строятся компилятором);
+ * - Utf8Alphabet - UTF-8: буква - два байта, декодер переводит их в коды
+ *   CodeAlphabet, ядра сдвигают коды, кодировщик пишет байты обратно.
+ *
+ * Все функции определены в заголовке, поэтому вызывающий код с
+ * известным алфавитом и ключом получает полностью специализированную
+ * и встроенную версию без LTO. Класс modAlphaCipher - нешаблонная
+ * обёртка над этими функциями.
+ *
+ * Для ключей длины 1..16, 32 и 64 есть ядра с длиной ключа в параметре
+ * шаблона (shiftLettersFixed, filterLettersFixed): сплошные буквы
+ * сдвигаются векторами SSE2 с заранее загруженными сдвигами ключа.
+ * selectKernels выбирает ядра по длине ключа за несколько сравнений.
+ *
+ * Алгоритмы - constexpr, поэтому они же шифруют строковые литералы на
+ * этапе компиляции:
+ * ```
+ * constexpr auto secret = alpha_core::encryptLiteral(L"ПРИВЕТ", L"КЛЮЧ");
+ * static_assert(secret[0] == L'Ъ', "");
+ * ```
+ * Текст литерала заканчивается первым нулевым символом, поэтому
+ * результат (CipherLiteral::chars) можно снова передать в decryptLiteral.
+ * Слабый, пустой или недопустимый ключ, пустой текст и (при
+ * дешифровании) недопустимый шифротекст в литерале - ошибка компиляции.
+ */
+
+#pragma once
+#include "CipherLiteral.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace alpha_core {
+
+/// Размер алфавита (АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ)
+constexpr unsigned ALPHABET_SIZE = 33;
+
+/// Индекс буквы Ё в алфавите
+constexpr unsigned YO_INDEX = 6;
+
+/// Код символа, не являющегося буквой
+constexpr unsigned NOT_LETTER = 0xFF;
+
+/// Признак строчной буквы в коде символа (младшие биты - индекс)
+constexpr unsigned LOWER_FLAG = 0x40;
+
+/**
+ * @brief Код буквы wchar_t: индекс в алфавите, у строчных - с LOWER_FLAG
+ * @return Код или NOT_LETTER
+ */
+constexpr unsigned letterCode(wchar_t c)
+{
+    if (c >= L'А' && c <= L'Е') return c - L'А';
+    if (c >= L'Ж' && c <= L'Я') return c - L'Ж' + YO_INDEX + 1;
+    if (c == L'Ё') return YO_INDEX;
+    if (c >= L'а' && c <= L'е') return (c - L'а') | LOWER_FLAG;
+    if (c >= L'ж' && c <= L'я') return (c - L'ж' + YO_INDEX + 1) | LOWER_FLAG;
+    if (c == L'ё') return YO_INDEX | LOWER_FLAG;
+    return NOT_LETTER;
+}
+
+/**
+ * @brief Буква wchar_t по индексу в алфавите
+ * @param index Индекс 0..32
+ * @param lower true - строчная буква
+ */
+constexpr wchar_t letter(unsigned index, bool lower)
+{
+    return index == YO_INDEX ? (lower ? L'ё' : L'Ё')
+           : static_cast<wchar_t>((index < YO_INDEX ? L'А' + index : L'Ж' + index - YO_INDEX - 1)
+                                  + (lower ? L'а' - L'А' : 0));
+}
+
+/**
+ * @brief Сдвигает индекс на индекс ключа
+ * @param decrypt true - обратный сдвиг
+ *
+ * Сумма меньше 2 * 33, поэтому вместо взятия по модулю - одно
+ * условное вычитание.
+ */
+constexpr unsigned shift(unsigned index, unsigned key, bool decrypt)
+{
+    unsigned v = index + (decrypt ? ALPHABET_SIZE - key : key);
+    return v >= ALPHABET_SIZE ? v - ALPHABET_SIZE : v;
+}
+
+/**
+ * @struct WideAlphabet
+ * @brief Русский алфавит в wchar_t
+ */
+struct WideAlphabet {
+    using char_type = wchar_t;      ///< Тип символа
+    static constexpr size_t UNITS = 1;  ///< Символов на букву
+
+    /// Код символа (см. letterCode)
+    static constexpr unsigned code(wchar_t c) { return letterCode(c); }
+
+    /// Символ по индексу и регистру
+    static constexpr wchar_t symbol(unsigned index, bool lower) { return letter(index, lower); }
+
+    /**
+     * @brief Ищет первый символ, не являющийся допустимой буквой
+     * @param anyCase true - допустимы буквы обоих регистров, false - только прописные
+     * @return Индекс символа или std::wstring::npos
+     */
+    static size_t findInvalid(const wchar_t* s, size_t n, bool anyCase)
+    {
+        size_t i = 0;
+#ifdef __SSE2__
+        // Проверка диапазона А..Я (А..я) и символов Ё (Ё, ё) по 16 символов за шаг
+        if (sizeof(wchar_t) == 4) {
+            const __m128i lo = _mm_set1_epi32(L'А' - 1);
+            const __m128i hi = _mm_set1_epi32((anyCase ? L'я' : L'Я') + 1);
+            const __m128i yo = _mm_set1_epi32(L'Ё');
+            const __m128i yoLower = _mm_set1_epi32(anyCase ? L'ё' : L'Ё');
+            auto valid = [&](size_t at) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + at));
+                __m128i range = _mm_and_si128(_mm_cmpgt_epi32(v, lo), _mm_cmplt_epi32(v, hi));
+                __m128i yos = _mm_or_si128(_mm_cmpeq_epi32(v, yo), _mm_cmpeq_epi32(v, yoLower));
+                return _mm_or_si128(range, yos);
+            };
+            for (; i + 16 <= n; i += 16) {
+                __m128i ok = _mm_and_si128(_mm_and_si128(valid(i), valid(i + 4)),
+                                           _mm_and_si128(valid(i + 8), valid(i + 12)));
+                if (_mm_movemask_epi8(ok) != 0xFFFF)
+                    break;
+            }
+        }
+#endif
+        // Хвост и уточнение позиции ошибки
+        for (; i < n; i++) {
+            unsigned c = code(s[i]);
+            if (c == NOT_LETTER || (!anyCase && (c & LOWER_FLAG)))
+                return i;
+        }
+        return std::wstring::npos;
+    }
+
+    /**
+     * @brief Считает буквы обоих регистров
+     * @return Число символов с кодом, отличным от NOT_LETTER
+     *
+     * Длина результата режима Filter без его построения.
+     */
+    static size_t countLetters(const wchar_t* s, size_t n)
+    {
+        size_t letters = 0;
+        size_t i = 0;
+#ifdef __SSE2__
+        // А..я - непрерывный диапазон, Ё и ё - отдельно; по 4 символа за шаг
+        if (sizeof(wchar_t) == 4) {
+            const __m128i lo = _mm_set1_epi32(L'А' - 1);
+            const __m128i hi = _mm_set1_epi32(L'я' + 1);
+            const __m128i yo = _mm_set1_epi32(L'Ё');
+            const __m128i yoLower = _mm_set1_epi32(L'ё');
+            // Маска буквы - -1 в своей дорожке: вычитание считает буквы
+            // в четырёх дорожках, сумма дорожек - в конце
+            __m128i count = _mm_setzero_si128();
+            for (; i + 4 <= n; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+                __m128i range = _mm_and_si128(_mm_cmpgt_epi32(v, lo), _mm_cmplt_epi32(v, hi));
+                __m128i yos = _mm_or_si128(_mm_cmpeq_epi32(v, yo), _mm_cmpeq_epi32(v, yoLower));
+                count = _mm_sub_epi32(count, _mm_or_si128(range, yos));
+            }
+            uint32_t lanes[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), count);
+            letters = size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+#endif
+        for (; i < n; i++)
+            letters += code(s[i]) != NOT_LETTER;
+        return letters;
+    }
+
+    /// Символов в векторе shiftLanes (0 - векторного сдвига нет)
+    static constexpr size_t LANES = sizeof(wchar_t) == 4 ? 4 : 0;
+
+#ifdef __SSE2__
+    /// Сдвиги amount[0..3] в дорожках вектора
+    static __m128i laneAmounts(const uint8_t* amount)
+    {
+        return _mm_setr_epi32(amount[0], amount[1], amount[2], amount[3]);
+    }
+
+    /**
+     * @brief Сдвигает 4 символа, если все они - буквы
+     * @param v Символы
+     * @param amount Сдвиг каждой дорожки вперёд, 1..33
+     * @param preserveCase true - строчные буквы остаются строчными
+     * @param letters Выход: маска _mm_movemask_epi8 букв, 0xFFFF - все буквы
+     * @return Сдвинутые буквы (дорожки не-букв не определены)
+     *
+     * Буквы кроме Ё идут подряд от А: младшие 5 бит смещения от А -
+     * индекс без Ё, бит 0x20 - строчная буква.
+     */
+    static __m128i shiftLanes(__m128i v, __m128i amount, bool preserveCase, int& letters)
+    {
+        const __m128i first = _mm_set1_epi32(L'А');
+        const __m128i yo = _mm_set1_epi32(L'Ё');
+        const __m128i yoLower = _mm_set1_epi32(L'ё');
+        __m128i range = _mm_and_si128(_mm_cmpgt_epi32(v, _mm_set1_epi32(L'А' - 1)),
+                                      _mm_cmplt_epi32(v, _mm_set1_epi32(L'я' + 1)));
+        __m128i isYoLower = _mm_cmpeq_epi32(v, yoLower);
+        __m128i yos = _mm_or_si128(_mm_cmpeq_epi32(v, yo), isYoLower);
+        letters = _mm_movemask_epi8(_mm_or_si128(range, yos));
+
+        __m128i offset = _mm_sub_epi32(v, first);
+        __m128i lower = _mm_and_si128(_mm_or_si128(_mm_and_si128(range, offset), isYoLower),
+                                      _mm_set1_epi32(preserveCase ? 0x20 : 0));
+        // Индекс: после Ё - на единицу больше, у Ё - YO_INDEX
+        __m128i base = _mm_and_si128(offset, _mm_set1_epi32(0x1F));
+        __m128i index = _mm_sub_epi32(base, _mm_cmpgt_epi32(base, _mm_set1_epi32(YO_INDEX - 1)));
+        index = _mm_or_si128(_mm_andnot_si128(yos, index), _mm_and_si128(yos, _mm_set1_epi32(YO_INDEX)));
+        __m128i t = _mm_add_epi32(index, amount);
+        t = _mm_sub_epi32(t, _mm_and_si128(_mm_cmpgt_epi32(t, _mm_set1_epi32(ALPHABET_SIZE - 1)),
+                                           _mm_set1_epi32(ALPHABET_SIZE)));
+
+        __m128i toYo = _mm_cmpeq_epi32(t, _mm_set1_epi32(YO_INDEX));
+        __m128i upper = _mm_cmpeq_epi32(lower, _mm_setzero_si128());
+        __m128i letter = _mm_add_epi32(_mm_add_epi32(t, _mm_cmpgt_epi32(t, _mm_set1_epi32(YO_INDEX))),
+                                       _mm_add_epi32(first, lower));
+        __m128i yoLetter = _mm_or_si128(_mm_and_si128(upper, yo), _mm_andnot_si128(upper, yoLower));
+        return _mm_or_si128(_mm_andnot_si128(toYo, letter), _mm_and_si128(toYo, yoLetter));
+    }
+#endif
+};
+
+/**
+ * @struct ByteTables
+ * @brief Таблицы перекодировки байт <-> индекс алфавита для одной кодировки
+ */
+struct ByteTables {
+    uint8_t byteIndex[256] = {};            ///< Байт -> код (индекс | LOWER_FLAG или NOT_LETTER)
+    uint8_t upper[ALPHABET_SIZE] = {};      ///< Индекс -> прописная буква
+    uint8_t lower[ALPHABET_SIZE] = {};      ///< Индекс -> строчная буква
+    uint8_t upperFirst = 0xFF;              ///< Начало непрерывного диапазона прописных букв
+    uint8_t upperLast = 0;                  ///< Конец непрерывного диапазона прописных букв
+    uint8_t letterFirst = 0xFF;             ///< Начало непрерывного диапазона букв обоих регистров
+    uint8_t letterLast = 0;                 ///< Конец непрерывного диапазона букв обоих регистров
+    uint8_t upperYo = 0;                    ///< Прописная Ё (вне диапазонов)
+    uint8_t lowerYo = 0;                    ///< Строчная ё (вне диапазонов)
+    bool linear = true;                     ///< Буквы кроме Ё идут подряд от upperFirst, строчная = прописная + 0x20
+
+    /**
+     * @brief Строит таблицы по буквам в порядке алфавита
+     */
+    constexpr ByteTables(const uint8_t (&up)[ALPHABET_SIZE], const uint8_t (&low)[ALPHABET_SIZE])
+    {
+        for (auto& b : byteIndex)
+            b = static_cast<uint8_t>(NOT_LETTER);
+        for (unsigned i = 0; i < ALPHABET_SIZE; i++) {
+            upper[i] = up[i];
+            lower[i] = low[i];
+            byteIndex[up[i]] = static_cast<uint8_t>(i);
+            byteIndex[low[i]] = static_cast<uint8_t>(i | LOWER_FLAG);
+            if (i == YO_INDEX)
+                continue;
+            upperFirst = up[i] < upperFirst ? up[i] : upperFirst;
+            upperLast = up[i] > upperLast ? up[i] : upperLast;
+            uint8_t first = up[i] < low[i] ? up[i] : low[i];
+            uint8_t last = up[i] > low[i] ? up[i] : low[i];
+            letterFirst = first < letterFirst ? first : letterFirst;
+            letterLast = last > letterLast ? last : letterLast;
+        }
+        upperYo = up[YO_INDEX];
+        lowerYo = low[YO_INDEX];
+        for (unsigned i = 0; i < ALPHABET_SIZE; i++)
+            if (i != YO_INDEX && (up[i] != upperFirst + i - (i > YO_INDEX) || low[i] != up[i] + 0x20))
+                linear = false;
+    }
+};
+
+// Буквы в порядке алфавита АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ
+inline constexpr uint8_t CP1251_UPPER[ALPHABET_SIZE] = {
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xA8, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+    0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF
+};
+inline constexpr uint8_t CP1251_LOWER[ALPHABET_SIZE] = {
+    0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xB8, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+inline constexpr uint8_t KOI8R_UPPER[ALPHABET_SIZE] = {
+    0xE1, 0xE2, 0xF7, 0xE7, 0xE4, 0xE5, 0xB3, 0xF6, 0xFA, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF, 0xF0,
+    0xF2, 0xF3, 0xF4, 0xF5, 0xE6, 0xE8, 0xE3, 0xFE, 0xFB, 0xFD, 0xFF, 0xF9, 0xF8, 0xFC, 0xE0, 0xF1
+};
+inline constexpr uint8_t KOI8R_LOWER[ALPHABET_SIZE] = {
+    0xC1, 0xC2, 0xD7, 0xC7, 0xC4, 0xC5, 0xA3, 0xD6, 0xDA, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF, 0xD0,
+    0xD2, 0xD3, 0xD4, 0xD5, 0xC6, 0xC8, 0xC3, 0xDE, 0xDB, 0xDD, 0xDF, 0xD9, 0xD8, 0xDC, 0xC0, 0xD1
+};
+
+/// Таблицы Windows-1251
+inline constexpr ByteTables CP1251_TABLES(CP1251_UPPER, CP1251_LOWER);
+
+/// Таблицы KOI8-R
+inline constexpr ByteTables KOI8R_TABLES(KOI8R_UPPER, KOI8R_LOWER);
+
+static_assert(CP1251_TABLES.upperFirst == 0xC0 && CP1251_TABLES.letterLast == 0xFF, "диапазоны CP1251");
+static_assert(KOI8R_TABLES.upperFirst == 0xE0 && KOI8R_TABLES.letterFirst == 0xC0, "диапазоны KOI8-R");
+static_assert(CP1251_TABLES.linear && !KOI8R_TABLES.linear, "порядок букв CP1251 и KOI8-R");
+
+/**
+ * @struct ByteAlphabet
+ * @brief Русский алфавит в однобайтовой кодировке
+ * @tparam Tables Таблицы кодировки
+ */
+template <const ByteTables& Tables>
+struct ByteAlphabet {
+    using char_type = char;         ///< Тип символа
+    static constexpr size_t UNITS = 1;  ///< Байтов на букву
+
+    /// Код байта: индекс | LOWER_FLAG или NOT_LETTER
+    static constexpr unsigned code(char c) { return Tables.byteIndex[static_cast<unsigned char>(c)]; }
+
+    /// Байт по индексу и регистру
+    static constexpr char symbol(unsigned index, bool lower)
+    {
+        return static_cast<char>(lower ? Tables.lower[index] : Tables.upper[index]);
+    }
+
+    /**
+     * @brief Ищет первый байт, не являющийся допустимой буквой
+     * @param anyCase true - допустимы буквы обоих регистров, false - только прописные
+     * @return Индекс байта или std::string::npos
+     *
+     * В обеих кодировках прописные буквы (и буквы обоих регистров), кроме Ё,
+     * занимают непрерывный диапазон, поэтому проверка 16 байт - одно
+     * вычитание и сравнение.
+     */
+    static size_t findInvalid(const char* text, size_t n, bool anyCase)
+    {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+        size_t i = 0;
+#ifdef __SSE2__
+        const uint8_t lo = anyCase ? Tables.letterFirst : Tables.upperFirst;
+        const uint8_t hi = anyCase ? Tables.letterLast : Tables.upperLast;
+        const __m128i first = _mm_set1_epi8(static_cast<char>(lo));
+        const __m128i span = _mm_set1_epi8(static_cast<char>(hi - lo));
+        const __m128i yo = _mm_set1_epi8(static_cast<char>(Tables.upperYo));
+        const __m128i yoLower = _mm_set1_epi8(static_cast<char>(anyCase ? Tables.lowerYo : Tables.upperYo));
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i offset = _mm_sub_epi8(v, first);
+            __m128i range = _mm_cmpeq_epi8(_mm_min_epu8(offset, span), offset);
+            __m128i yos = _mm_or_si128(_mm_cmpeq_epi8(v, yo), _mm_cmpeq_epi8(v, yoLower));
+            if (_mm_movemask_epi8(_mm_or_si128(range, yos)) != 0xFFFF)
+                break;
+        }
+#endif
+        for (; i < n; i++) {
+            unsigned c = Tables.byteIndex[s[i]];
+            // Не-буквы дают NOT_LETTER, строчные буквы - значения с LOWER_FLAG
+            if (c == NOT_LETTER || (!anyCase && (c & LOWER_FLAG)))
+                return i;
+        }
+        return std::string::npos;
+    }
+
+    /**
+     * @brief Считает буквы обоих регистров
+     * @return Число байтов с кодом, отличным от NOT_LETTER
+     */
+    static size_t countLetters(const char* text, size_t n)
+    {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+        size_t letters = 0;
+        size_t i = 0;
+#ifdef __SSE2__
+        const __m128i first = _mm_set1_epi8(static_cast<char>(Tables.letterFirst));
+        const __m128i span = _mm_set1_epi8(static_cast<char>(Tables.letterLast - Tables.letterFirst));
+        const __m128i yo = _mm_set1_epi8(static_cast<char>(Tables.upperYo));
+        const __m128i yoLower = _mm_set1_epi8(static_cast<char>(Tables.lowerYo));
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i zero = _mm_setzero_si128();
+        __m128i count = zero;
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i offset = _mm_sub_epi8(v, first);
+            __m128i range = _mm_cmpeq_epi8(_mm_min_epu8(offset, span), offset);
+            __m128i yos = _mm_or_si128(_mm_cmpeq_epi8(v, yo), _mm_cmpeq_epi8(v, yoLower));
+            // Сумма 16 байтов 0/1 - в двух 64-битных половинах
+            count = _mm_add_epi64(count, _mm_sad_epu8(_mm_and_si128(_mm_or_si128(range, yos), one), zero));
+        }
+        uint64_t halves[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(halves), count);
+        letters = static_cast<size_t>(halves[0] + halves[1]);
+#endif
+        for (; i < n; i++)
+            letters += Tables.byteIndex[s[i]] != NOT_LETTER;
+        return letters;
+    }
+
+    /// Байтов в векторе shiftLanes: только для кодировок с буквами подряд (CP1251)
+    static constexpr size_t LANES = Tables.linear ? 16 : 0;
+
+#ifdef __SSE2__
+    /// Сдвиги amount[0..15] в дорожках вектора
+    static __m128i laneAmounts(const uint8_t* amount)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(amount));
+    }
+
+    /**
+     * @brief Сдвигает 16 байтов, если все они - буквы (см. WideAlphabet::shiftLanes)
+     *
+     * Только для Tables.linear: индекс без Ё - младшие 5 бит смещения от
+     * upperFirst, бит 0x20 - строчная буква.
+     */
+    static __m128i shiftLanes(__m128i v, __m128i amount, bool preserveCase, int& letters)
+    {
+        const __m128i first = _mm_set1_epi8(static_cast<char>(Tables.upperFirst));
+        const __m128i yo = _mm_set1_epi8(static_cast<char>(Tables.upperYo));
+        const __m128i yoLower = _mm_set1_epi8(static_cast<char>(Tables.lowerYo));
+        __m128i offset = _mm_sub_epi8(v, first);
+        __m128i range = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(0x3F)), offset);
+        __m128i isYoLower = _mm_cmpeq_epi8(v, yoLower);
+        __m128i yos = _mm_or_si128(_mm_cmpeq_epi8(v, yo), isYoLower);
+        letters = _mm_movemask_epi8(_mm_or_si128(range, yos));
+
+        __m128i lower = _mm_and_si128(_mm_or_si128(_mm_and_si128(range, offset), isYoLower),
+                                      _mm_set1_epi8(preserveCase ? 0x20 : 0));
+        __m128i base = _mm_and_si128(offset, _mm_set1_epi8(0x1F));
+        __m128i index = _mm_sub_epi8(base, _mm_cmpgt_epi8(base, _mm_set1_epi8(YO_INDEX - 1)));
+        index = _mm_or_si128(_mm_andnot_si128(yos, index), _mm_and_si128(yos, _mm_set1_epi8(YO_INDEX)));
+        __m128i t = _mm_add_epi8(index, amount);
+        t = _mm_sub_epi8(t, _mm_and_si128(_mm_cmpgt_epi8(t, _mm_set1_epi8(ALPHABET_SIZE - 1)),
+                                          _mm_set1_epi8(ALPHABET_SIZE)));
+
+        __m128i toYo = _mm_cmpeq_epi8(t, _mm_set1_epi8(YO_INDEX));
+        __m128i upper = _mm_cmpeq_epi8(lower, _mm_setzero_si128());
+        __m128i letter = _mm_add_epi8(_mm_add_epi8(t, _mm_cmpgt_epi8(t, _mm_set1_epi8(YO_INDEX))),
+                                      _mm_add_epi8(first, lower));
+        __m128i yoLetter = _mm_or_si128(_mm_and_si128(upper, yo), _mm_andnot_si128(upper, yoLower));
+        return _mm_or_si128(_mm_andnot_si128(toYo, letter), _mm_and_si128(toYo, yoLetter));
+    }
+#endif
+};
+
+/// Windows-1251
+using Cp1251Alphabet = ByteAlphabet<CP1251_TABLES>;
+
+/// KOI8-R
+using Koi8rAlphabet = ByteAlphabet<KOI8R_TABLES>;
+
+/**
+ * @struct CodeAlphabet
+ * @brief Коды букв (индекс | LOWER_FLAG) вместо символов
+ *
+ * Промежуточное представление UTF-8: Utf8Alphabet декодирует буквы в
+ * коды, ядра сдвигают коды, кодировщик записывает их обратно. Вход -
+ * только коды букв и NOT_LETTER.
+ */
+struct CodeAlphabet {
+    using char_type = char;         ///< Тип символа
+    static constexpr size_t UNITS = 1;  ///< Кодов на букву
+
+    /// Код - сам байт
+    static constexpr unsigned code(char c) { return static_cast<unsigned char>(c); }
+
+    /// Код по индексу и регистру
+    static constexpr char symbol(unsigned index, bool lower)
+    {
+        return static_cast<char>(index | (lower ? LOWER_FLAG : 0));
+    }
+
+    /**
+     * @brief Ищет первый код, не являющийся допустимой буквой
+     * @param anyCase true - допустимы буквы обоих регистров, false - только прописные
+     * @return Индекс кода или std::string::npos
+     */
+    static size_t findInvalid(const char* s, size_t n, bool anyCase)
+    {
+        for (size_t i = 0; i < n; i++) {
+            unsigned c = code(s[i]);
+            if (c == NOT_LETTER || (!anyCase && (c & LOWER_FLAG)))
+                return i;
+        }
+        return std::string::npos;
+    }
+
+    /// Число кодов букв
+    static size_t countLetters(const char* s, size_t n)
+    {
+        size_t letters = 0;
+        for (size_t i = 0; i < n; i++)
+            letters += code(s[i]) != NOT_LETTER;
+        return letters;
+    }
+
+    /// Кодов в векторе shiftLanes
+    static constexpr size_t LANES = 16;
+
+#ifdef __SSE2__
+    /// Сдвиги amount[0..15] в дорожках вектора
+    static __m128i laneAmounts(const uint8_t* amount)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(amount));
+    }
+
+    /**
+     * @brief Сдвигает 16 кодов, если все они - буквы (см. WideAlphabet::shiftLanes)
+     *
+     * Индекс - младшие 6 бит кода, поэтому сдвиг - сложение и вычитание
+     * размера алфавита при переполнении.
+     */
+    static __m128i shiftLanes(__m128i v, __m128i amount, bool preserveCase, int& letters)
+    {
+        letters = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(NOT_LETTER)))) ^ 0xFFFF;
+        __m128i lower = _mm_and_si128(v, _mm_set1_epi8(preserveCase ? LOWER_FLAG : 0));
+        __m128i t = _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x3F)), amount);
+        t = _mm_sub_epi8(t, _mm_and_si128(_mm_cmpgt_epi8(t, _mm_set1_epi8(ALPHABET_SIZE - 1)),
+                                          _mm_set1_epi8(ALPHABET_SIZE)));
+        return _mm_or_si128(t, lower);
+    }
+#endif
+};
+
+/**
+ * @brief Код буквы UTF-8 по двум байтам
+ * @return Индекс | LOWER_FLAG или NOT_LETTER
+ *
+ * Все буквы алфавита - U+0401..U+0451: ведущий байт D0 или D1,
+ * младший бит которого и 6 бит второго байта - смещение от U+0400.
+ */
+constexpr unsigned utf8LetterCode(unsigned char lead, unsigned char next)
+{
+    return (lead & 0xFE) == 0xD0 && (next & 0xC0) == 0x80
+           ? letterCode(static_cast<wchar_t>(0x400 | (lead & 1) << 6 | (next & 0x3F)))
+           : NOT_LETTER;
+}
+
+/**
+ * @struct Utf8Alphabet
+ * @brief Русский алфавит в UTF-8
+ *
+ * Буква - пара байтов (UNITS = 2), поэтому посимвольные code и symbol
+ * заменены декодером и кодировщиком кодов CodeAlphabet, а ядра сдвига
+ * (selectKernels<Utf8Alphabet>) работают блоками кодов. Остальные
+ * символы, включая неверные последовательности UTF-8, - не-буквы:
+ * шифр их не проверяет и не изменяет.
+ */
+struct Utf8Alphabet {
+    using char_type = char;         ///< Тип символа
+    static constexpr size_t UNITS = 2;  ///< Байтов на букву
+
+#ifdef __SSE2__
+    /**
+     * @brief Декодирует 8 пар байтов
+     * @param v 16 байтов: ведущий и второй байт пары в 16-битной дорожке
+     * @param letters Выход: бит i - пара i является буквой
+     * @return Коды пар (NOT_LETTER для не-букв) в младших 8 байтах
+     *
+     * Смещение w от U+0400 - бит 0 ведущего байта и 6 бит второго; буквы -
+     * w из 0x10..0x4F (А..я, младшие 5 бит смещения от А - индекс без Ё,
+     * бит 0x20 - строчная буква), 0x01 (Ё) и 0x51 (ё).
+     */
+    static __m128i decodeLanes(__m128i v, int& letters)
+    {
+        __m128i lead = _mm_and_si128(v, _mm_set1_epi16(0xFF));
+        __m128i next = _mm_srli_epi16(v, 8);
+        __m128i pair = _mm_and_si128(
+            _mm_cmpeq_epi16(_mm_and_si128(lead, _mm_set1_epi16(0xFE)), _mm_set1_epi16(0xD0)),
+            _mm_cmpeq_epi16(_mm_and_si128(next, _mm_set1_epi16(0xC0)), _mm_set1_epi16(0x80)));
+        __m128i w = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(lead, _mm_set1_epi16(1)), 6),
+                                 _mm_and_si128(next, _mm_set1_epi16(0x3F)));
+        __m128i range = _mm_and_si128(_mm_cmpgt_epi16(w, _mm_set1_epi16(0x0F)),
+                                      _mm_cmplt_epi16(w, _mm_set1_epi16(0x50)));
+        __m128i isYoLower = _mm_cmpeq_epi16(w, _mm_set1_epi16(0x51));
+        __m128i yos = _mm_or_si128(_mm_cmpeq_epi16(w, _mm_set1_epi16(0x01)), isYoLower);
+        __m128i valid = _mm_and_si128(pair, _mm_or_si128(range, yos));
+        letters = _mm_movemask_epi8(_mm_packs_epi16(valid, valid)) & 0xFF;
+
+        __m128i offset = _mm_sub_epi16(w, _mm_set1_epi16(0x10));
+        __m128i lower = _mm_and_si128(_mm_or_si128(_mm_and_si128(range, offset), isYoLower),
+                                      _mm_set1_epi16(0x20));
+        __m128i base = _mm_and_si128(offset, _mm_set1_epi16(0x1F));
+        __m128i index = _mm_sub_epi16(base, _mm_cmpgt_epi16(base, _mm_set1_epi16(YO_INDEX - 1)));
+        index = _mm_or_si128(_mm_andnot_si128(yos, index), _mm_and_si128(yos, _mm_set1_epi16(YO_INDEX)));
+        __m128i codes = _mm_or_si128(_mm_or_si128(index, _mm_slli_epi16(lower, 1)),
+                                     _mm_andnot_si128(valid, _mm_set1_epi16(NOT_LETTER)));
+        return _mm_packus_epi16(codes, codes);
+    }
+#endif
+
+    /**
+     * @brief Декодирует буквы, идущие подряд с начала текста
+     * @param text Текст, начинающийся с буквы или не-буквы
+     * @param n Длина текста, байт
+     * @param codes Выход: коды букв (не меньше n / 2 элементов)
+     * @return Число букв до первой не-буквы
+     *
+     * По 16 байтов (8 букв) за шаг, сплошной текст без проверки каждого
+     * байта; первый вектор с не-буквой и хвост - попарно.
+     */
+    static size_t decodeLetters(const char* text, size_t n, char* codes)
+    {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+        size_t i = 0;
+#ifdef __SSE2__
+        for (; i + 16 <= n; i += 16) {
+            int letters;
+            __m128i c = decodeLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), letters);
+            if (letters != 0xFF)
+                break;
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(codes + i / 2), c);
+        }
+#endif
+        for (; i + 1 < n; i += 2) {
+            unsigned c = utf8LetterCode(s[i], s[i + 1]);
+            if (c == NOT_LETTER)
+                break;
+            codes[i / 2] = static_cast<char>(c);
+        }
+        return i / 2;
+    }
+
+#ifdef __SSE2__
+    /**
+     * @brief Смещения букв от U+0400 по 16 кодам (обратно decodeLanes)
+     * @param c Коды букв (только буквы)
+     * @return Смещения w: А..Я - 0x10..0x2F, а..я - 0x30..0x4F, Ё - 0x01, ё - 0x51
+     */
+    static __m128i encodeLanes(__m128i c)
+    {
+        __m128i index = _mm_and_si128(c, _mm_set1_epi8(0x3F));
+        __m128i lower = _mm_cmpeq_epi8(_mm_and_si128(c, _mm_set1_epi8(LOWER_FLAG)), _mm_set1_epi8(LOWER_FLAG));
+        __m128i yo = _mm_cmpeq_epi8(index, _mm_set1_epi8(YO_INDEX));
+        // Буквы после Ё сдвинуты на одну позицию: cmpgt даёт -1
+        __m128i w = _mm_add_epi8(_mm_add_epi8(index, _mm_set1_epi8(0x10)),
+                                 _mm_cmpgt_epi8(index, _mm_set1_epi8(YO_INDEX)));
+        w = _mm_or_si128(_mm_andnot_si128(yo, w), _mm_and_si128(yo, _mm_set1_epi8(0x01)));
+        __m128i caseOffset = _mm_or_si128(_mm_andnot_si128(yo, _mm_set1_epi8(0x20)),
+                                          _mm_and_si128(yo, _mm_set1_epi8(0x50)));
+        return _mm_add_epi8(w, _mm_and_si128(lower, caseOffset));
+    }
+#endif
+
+    /**
+     * @brief Записывает буквы по кодам
+     * @param codes Коды букв
+     * @param count Число кодов
+     * @param out Выход: ровно 2 * count байтов
+     *
+     * По 16 кодов (32 байта) за шаг: ведущий байт - D0 или D1 по биту 6
+     * смещения, второй - 0x80 и 6 младших бит; байты чередуются
+     * распаковкой (_mm_unpacklo/hi_epi8). Длина выхода известна заранее,
+     * поэтому проверок границ внутри шага нет.
+     */
+    static void encodeLetters(const char* codes, size_t count, char* out)
+    {
+        size_t j = 0;
+#ifdef __SSE2__
+        for (; j + 16 <= count; j += 16) {
+            __m128i w = encodeLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + j)));
+            __m128i lead = _mm_or_si128(_mm_set1_epi8(static_cast<char>(0xD0)),
+                                        _mm_and_si128(_mm_cmpgt_epi8(w, _mm_set1_epi8(0x3F)), _mm_set1_epi8(1)));
+            __m128i next = _mm_or_si128(_mm_set1_epi8(static_cast<char>(0x80)),
+                                        _mm_and_si128(w, _mm_set1_epi8(0x3F)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * j), _mm_unpacklo_epi8(lead, next));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * j + 16), _mm_unpackhi_epi8(lead, next));
+        }
+#endif
+        for (; j < count; j++) {
+            unsigned c = static_cast<unsigned char>(codes[j]);
+            wchar_t w = letter(c & ~LOWER_FLAG, c & LOWER_FLAG);
+            out[2 * j] = static_cast<char>(0xD0 | ((w >> 6) & 1));
+            out[2 * j + 1] = static_cast<char>(0x80 | (w & 0x3F));
+        }
+    }
+
+    /**
+     * @brief Коды всех букв текста, без не-букв
+     * @param codes Выход (не меньше n / 2 элементов)
+     * @return Число букв
+     */
+    static size_t letterCodes(const char* text, size_t n, char* codes)
+    {
+        size_t i = 0, count = 0;
+        while (i < n) {
+            if ((static_cast<unsigned char>(text[i]) & 0xFE) != 0xD0) {
+                i++;
+                continue;
+            }
+            size_t run = decodeLetters(text + i, n - i, codes + count);
+            i += run ? 2 * run : 1;
+            count += run;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Ищет первую пару байтов, не являющуюся допустимой буквой
+     * @param anyCase true - допустимы буквы обоих регистров, false - только прописные
+     * @return Смещение пары (или непарного последнего байта) или std::string::npos
+     */
+    static size_t findInvalid(const char* text, size_t n, bool anyCase)
+    {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+        size_t i = 0;
+#ifdef __SSE2__
+        const __m128i lowerFlag = _mm_set1_epi8(anyCase ? 0 : LOWER_FLAG);
+        for (; i + 16 <= n; i += 16) {
+            int letters;
+            __m128i c = decodeLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), letters);
+            if (letters != 0xFF || (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(c, lowerFlag), lowerFlag))
+                                    & 0xFF) != (anyCase ? 0xFF : 0))
+                break;
+        }
+#endif
+        for (; i < n; i += 2) {
+            unsigned c = i + 1 < n ? utf8LetterCode(s[i], s[i + 1]) : NOT_LETTER;
+            if (c == NOT_LETTER || (!anyCase && (c & LOWER_FLAG)))
+                return i;
+        }
+        return std::string::npos;
+    }
+
+    /**
+     * @brief Считает буквы обоих регистров
+     * @return Число пар байтов, являющихся буквой
+     *
+     * Ведущий байт буквы (D0, D1) не бывает вторым байтом, поэтому пары
+     * не пересекаются и считаются с любого смещения: буква, начатая
+     * последним байтом текста, не учитывается.
+     */
+    static size_t countLetters(const char* text, size_t n)
+    {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+        size_t letters = 0;
+        size_t i = 0;
+#ifdef __SSE2__
+        // Буквы: D0 81, D0 90..BF, D1 80..8F, D1 91 - ведущие байты в v, вторые в w
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i zero = _mm_setzero_si128();
+        auto in = [](__m128i v, int first, int span) {
+            __m128i offset = _mm_sub_epi8(v, _mm_set1_epi8(static_cast<char>(first)));
+            return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(static_cast<char>(span))), offset);
+        };
+        __m128i count = zero;
+        for (; i + 17 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 1));
+            __m128i d0 = _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(0xD0))),
+                                       _mm_or_si128(in(w, 0x90, 0x2F), in(w, 0x81, 0)));
+            __m128i d1 = _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(0xD1))),
+                                       _mm_or_si128(in(w, 0x80, 0x0F), in(w, 0x91, 0)));
+            count = _mm_add_epi64(count, _mm_sad_epu8(_mm_and_si128(_mm_or_si128(d0, d1), one), zero));
+        }
+        uint64_t halves[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(halves), count);
+        letters = static_cast<size_t>(halves[0] + halves[1]);
+#endif
+        for (; i + 1 < n; i++)
+            letters += utf8LetterCode(s[i], s[i + 1]) != NOT_LETTER;
+        return letters;
+    }
+
+    /**
+     * @brief Проверяет, разрезает ли смещение букву
+     * @return true, если байты at - 1 и at - одна буква
+     */
+    static bool insideLetter(const char* text, size_t n, size_t at)
+    {
+        return at > 0 && at < n
+               && utf8LetterCode(static_cast<unsigned char>(text[at - 1]), static_cast<unsigned char>(text[at]))
+                  != NOT_LETTER;
+    }
+
+    /// Векторного сдвига символов нет: сдвигаются коды (CodeAlphabet)
+    static constexpr size_t LANES = 0;
+};
+
+/**
+ * @brief Сдвигает буквы текста на месте, не трогая остальные символы
+ * @tparam Alphabet Алфавит (WideAlphabet, Cp1251Alphabet, Koi8rAlphabet)
+ * @param text Начало текста
+ * @param n Длина текста
+ * @param key Индексы ключа
+ * @param keySize Длина ключа
+ * @param decrypt true - обратный сдвиг
+ * @param preserveCase true - строчные буквы остаются строчными
+ * @param phase Позиция в ключе для первой буквы (меньше keySize)
+ *
+ * Позиция в ключе увеличивается только на буквах (режим Passthrough).
+ */
+template <class Alphabet>
+constexpr void shiftLetters(typename Alphabet::char_type* text, size_t n, const uint8_t* key, size_t keySize,
+                            bool decrypt, bool preserveCase, size_t phase = 0)
+{
+    size_t k = phase;
+    for (size_t i = 0; i < n; i++) {
+        unsigned c = Alphabet::code(text[i]);
+        if (c == NOT_LETTER)
+            continue;
+        text[i] = Alphabet::symbol(shift(c & ~LOWER_FLAG, key[k], decrypt), preserveCase && (c & LOWER_FLAG));
+        if (++k == keySize)
+            k = 0;
+    }
+}
+
+/**
+ * @brief Записывает сдвинутые буквы текста, отбрасывая остальные символы
+ * @tparam Alphabet Алфавит
+ * @param in Входной текст
+ * @param n Длина входного текста
+ * @param out Выход (не меньше n символов; может совпадать с in)
+ * @param phase Позиция в ключе для первой буквы (меньше keySize)
+ * @return Число записанных букв
+ *
+ * Режим Filter за один проход: проверка, перевод регистра и сдвиг без
+ * промежуточных строк и векторов индексов.
+ */
+template <class Alphabet>
+constexpr size_t filterLetters(const typename Alphabet::char_type* in, size_t n, typename Alphabet::char_type* out,
+                               const uint8_t* key, size_t keySize, bool decrypt, bool preserveCase,
+                               size_t phase = 0)
+{
+    size_t k = phase, pos = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned c = Alphabet::code(in[i]);
+        if (c == NOT_LETTER)
+            continue;
+        out[pos++] = Alphabet::symbol(shift(c & ~LOWER_FLAG, key[k], decrypt), preserveCase && (c & LOWER_FLAG));
+        if (++k == keySize)
+            k = 0;
+    }
+    return pos;
+}
+
+/// Ядро режима Passthrough (сигнатура shiftLetters)
+template <class Alphabet>
+using ShiftKernel = void (*)(typename Alphabet::char_type* text, size_t n, const uint8_t* key, size_t keySize,
+                             bool decrypt, bool preserveCase, size_t phase);
+
+/// Ядро режима Filter (сигнатура filterLetters)
+template <class Alphabet>
+using FilterKernel = size_t (*)(const typename Alphabet::char_type* in, size_t n, typename Alphabet::char_type* out,
+                                const uint8_t* key, size_t keySize, bool decrypt, bool preserveCase, size_t phase);
+
+/**
+ * @struct Kernels
+ * @brief Ядра обоих режимов для одной длины ключа (selectKernels)
+ */
+template <class Alphabet>
+struct Kernels {
+    ShiftKernel<Alphabet> shift;    ///< Режим Passthrough
+    FilterKernel<Alphabet> filter;  ///< Режим Filter
+};
+
+#ifdef __SSE2__
+namespace detail {
+
+/// Букв подряд, после которых ядро с фиксированной длиной ключа переходит на векторы
+constexpr size_t DENSE_RUN = 16;
+
+/**
+ * @brief Сдвиг букв с длиной ключа K, известной при компиляции
+ * @tparam Filter true - не-буквы отбрасываются (filterLetters), иначе остаются на месте
+ * @tparam S 0..L-1, L = НОК(K, LANES) / LANES - векторов сдвигов на период ключа
+ * @return Число записанных символов
+ *
+ * Скалярный цикл - как у filterLetters, но со сдвигами ключа,
+ * вычисленными заранее. После DENSE_RUN букв подряд текст обрабатывается
+ * по Alphabet::LANES символов за шаг: L векторов сдвигов, начиная с
+ * текущей позиции в ключе, загружаются в регистры, и цикл, развёрнутый
+ * на период ключа, обращается к ним по номеру шага без вычисления
+ * позиции в ключе. Первый вектор с не-буквой возвращает к скалярному
+ * циклу.
+ */
+template <class Alphabet, size_t K, bool Filter, size_t... S>
+size_t shiftFixed(const typename Alphabet::char_type* in, size_t n, typename Alphabet::char_type* out,
+                  const uint8_t* key, bool decrypt, bool preserveCase, size_t phase, std::index_sequence<S...>)
+{
+    constexpr size_t LANES = Alphabet::LANES;
+    // Сдвиги вперёд на период ключа и ещё один вектор через конец периода
+    uint8_t amount[K + LANES];
+    for (size_t j = 0; j < K + LANES; j++)
+        amount[j] = static_cast<uint8_t>(decrypt ? ALPHABET_SIZE - key[j % K] : key[j % K]);
+
+    size_t k = phase, pos = 0, i = 0, run = 0;
+    while (i < n) {
+        if (run == DENSE_RUN) {
+            const __m128i shifts[] = {Alphabet::laneAmounts(amount + (k + S * LANES) % K)...};
+            size_t start = i;
+            auto step = [&](__m128i shiftAmount) {
+                if (n - i < LANES)
+                    return false;
+                int letters;
+                __m128i v = Alphabet::shiftLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)),
+                                                 shiftAmount, preserveCase, letters);
+                if (letters != 0xFFFF)
+                    return false;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (Filter ? pos : i)), v);
+                i += LANES;
+                pos += LANES;
+                return true;
+            };
+            while ((step(shifts[S]) && ...)) {
+            }
+            k = (k + i - start) % K;
+            run = 0;
+        }
+        for (; i < n; i++) {
+            unsigned c = Alphabet::code(in[i]);
+            if (c == NOT_LETTER) {
+                run = 0;
+                continue;
+            }
+            out[Filter ? pos : i] = Alphabet::symbol(shift(c & ~LOWER_FLAG, amount[k], false),
+                                                     preserveCase && (c & LOWER_FLAG));
+            pos++;
+            if (++k == K)
+                k = 0;
+            if (++run == DENSE_RUN) {
+                i++;
+                break;
+            }
+        }
+    }
+    return pos;
+}
+
+} // namespace detail
+
+/**
+ * @brief shiftLetters для ключа длины K
+ * @tparam K Длина ключа (keySize игнорируется)
+ */
+template <class Alphabet, size_t K>
+void shiftLettersFixed(typename Alphabet::char_type* text, size_t n, const uint8_t* key, size_t /*keySize*/,
+                       bool decrypt, bool preserveCase, size_t phase)
+{
+    detail::shiftFixed<Alphabet, K, false>(text, n, text, key, decrypt, preserveCase, phase,
+                                           std::make_index_sequence<K / std::gcd(K, Alphabet::LANES)>());
+}
+
+/**
+ * @brief filterLetters для ключа длины K
+ * @tparam K Длина ключа (keySize игнорируется)
+ */
+template <class Alphabet, size_t K>
+size_t filterLettersFixed(const typename Alphabet::char_type* in, size_t n, typename Alphabet::char_type* out,
+                          const uint8_t* key, size_t /*keySize*/, bool decrypt, bool preserveCase, size_t phase)
+{
+    return detail::shiftFixed<Alphabet, K, true>(in, n, out, key, decrypt, preserveCase, phase,
+                                                 std::make_index_sequence<K / std::gcd(K, Alphabet::LANES)>());
+}
+
+namespace detail {
+
+/// Ядра для ключей длины 1..sizeof...(K)
+template <class Alphabet, size_t... K>
+const Kernels<Alphabet>& fixedKernels(size_t keySize, std::index_sequence<K...>)
+{
+    static constexpr Kernels<Alphabet> table[] = {
+        {&shiftLettersFixed<Alphabet, K + 1>, &filterLettersFixed<Alphabet, K + 1>}...};
+    return table[keySize - 1];
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @brief Выбирает ядра для длины ключа
+ * @tparam Alphabet Алфавит
+ * @param keySize Длина ключа
+ * @return Ядра с фиксированной длиной ключа для 1..16, 32 и 64 или
+ *         обобщённые shiftLetters и filterLetters
+ *
+ * Фиксированные ядра есть для алфавитов с векторным сдвигом
+ * (Alphabet::LANES != 0) при сборке с SSE2. Результат любого ядра
+ * совпадает с обобщённым.
+ */
+template <class Alphabet>
+const Kernels<Alphabet>& selectKernels(size_t keySize)
+{
+    static constexpr Kernels<Alphabet> generic = {&shiftLetters<Alphabet>, &filterLetters<Alphabet>};
+#ifdef __SSE2__
+    if constexpr (Alphabet::LANES != 0) {
+        static constexpr Kernels<Alphabet> key32 = {&shiftLettersFixed<Alphabet, 32>,
+                                                    &filterLettersFixed<Alphabet, 32>};
+        static constexpr Kernels<Alphabet> key64 = {&shiftLettersFixed<Alphabet, 64>,
+                                                    &filterLettersFixed<Alphabet, 64>};
+        if (keySize >= 1 && keySize <= 16)
+            return detail::fixedKernels<Alphabet>(keySize, std::make_index_sequence<16>());
+        if (keySize == 32)
+            return key32;
+        if (keySize == 64)
+            return key64;
+    }
+#endif
+    return generic;
+}
+
+namespace detail {
+
+/// Букв в блоке кодов ядер UTF-8
+constexpr size_t UTF8_BLOCK = 256;
+
+/// Букв подряд, начиная с которых блок кодов сдвигается ядром CodeAlphabet
+constexpr size_t UTF8_KERNEL_RUN = 16;
+
+/**
+ * @brief Сдвиг букв UTF-8 через коды
+ * @tparam Filter true - не-буквы отбрасываются, иначе остаются на месте
+ * @return Число записанных байтов
+ *
+ * Не-буквы пропускаются по ведущему байту; буквы подряд декодируются
+ * в блок кодов (Utf8Alphabet::decodeLetters), блок сдвигается ядром
+ * CodeAlphabet для длины ключа и записывается обратно на место букв.
+ * Короткие слова сдвигаются на месте: вызов ядра дороже самого сдвига.
+ * Буква UTF-8 не меняет длину, поэтому на месте (out == in) запись
+ * не обгоняет чтение.
+ */
+template <bool Filter>
+size_t shiftUtf8(const char* in, size_t n, char* out, const uint8_t* key, size_t keySize, bool decrypt,
+                 bool preserveCase, size_t phase)
+{
+    ShiftKernel<CodeAlphabet> shiftCodes = selectKernels<CodeAlphabet>(keySize).shift;
+    char codes[UTF8_BLOCK];
+    size_t i = 0, pos = 0, k = phase;
+    while (i < n) {
+        if ((static_cast<unsigned char>(in[i]) & 0xFE) != 0xD0) {
+            i++;
+            continue;
+        }
+        size_t count = Utf8Alphabet::decodeLetters(in + i, std::min(n - i, 2 * UTF8_BLOCK), codes);
+        if (count == 0) {
+            i++;
+            continue;
+        }
+        if (count < UTF8_KERNEL_RUN) {
+            for (size_t j = 0; j < count; j++) {
+                unsigned c = CodeAlphabet::code(codes[j]);
+                codes[j] = CodeAlphabet::symbol(shift(c & ~LOWER_FLAG, key[k], decrypt),
+                                                preserveCase && (c & LOWER_FLAG));
+                if (++k == keySize)
+                    k = 0;
+            }
+        } else {
+            shiftCodes(codes, count, key, keySize, decrypt, preserveCase, k);
+            k = (k + count) % keySize;
+        }
+        Utf8Alphabet::encodeLetters(codes, count, out + (Filter ? pos : i));
+        i += 2 * count;
+        pos += 2 * count;
+    }
+    return pos;
+}
+
+} // namespace detail
+
+/// shiftLetters для UTF-8
+inline void shiftUtf8Letters(char* text, size_t n, const uint8_t* key, size_t keySize, bool decrypt,
+                             bool preserveCase, size_t phase)
+{
+    detail::shiftUtf8<false>(text, n, text, key, keySize, decrypt, preserveCase, phase);
+}
+
+/// filterLetters для UTF-8
+inline size_t filterUtf8Letters(const char* in, size_t n, char* out, const uint8_t* key, size_t keySize,
+                                bool decrypt, bool preserveCase, size_t phase)
+{
+    return detail::shiftUtf8<true>(in, n, out, key, keySize, decrypt, preserveCase, phase);
+}
+
+/**
+ * @brief Ядра UTF-8
+ *
+ * Одни на все длины ключа: ядро CodeAlphabet для длины ключа выбирается
+ * при каждом вызове.
+ */
+template <>
+inline const Kernels<Utf8Alphabet>& selectKernels<Utf8Alphabet>(size_t /*keySize*/)
+{
+    static constexpr Kernels<Utf8Alphabet> utf8 = {&shiftUtf8Letters, &filterUtf8Letters};
+    return utf8;
+}
+
+/**
+ * @enum KeyError
+ * @brief Ошибки ключа
+ */
+enum class KeyError {
+    None,       ///< Ключ допустим
+    Empty,      ///< Ключ пуст
+    Invalid,    ///< Ключ содержит не буквы
+    Weak        ///< Все буквы ключа одинаковые (в том числе ключ из одной буквы)
+};
+
+/**
+ * @brief Сообщение об ошибке ключа (текст cipher_error)
+ */
+constexpr const char* keyErrorMessage(KeyError error)
+{
+    return error == KeyError::Empty ? "Empty key"
+         : error == KeyError::Invalid ? "Invalid key"
+         : error == KeyError::Weak ? "Weak key" : "No error";
+}
+
+/**
+ * @brief Переводит ключ в индексы алфавита
+ * @param key Буквы ключа (любого регистра)
+ * @param n Длина ключа
+ * @param indices Выход: n индексов
+ * @return Код ошибки; проверки идут в порядке Empty, Invalid, Weak
+ */
+constexpr KeyError keyIndices(const wchar_t* key, size_t n, uint8_t* indices)
+{
+    if (n == 0)
+        return KeyError::Empty;
+    bool weak = true;
+    for (size_t i = 0; i < n; i++) {
+        unsigned c = letterCode(key[i]);
+        if (c == NOT_LETTER)
+            return KeyError::Invalid;
+        indices[i] = static_cast<uint8_t>(c & ~LOWER_FLAG);
+        if (indices[i] != indices[0])
+            weak = false;
+    }
+    return weak ? KeyError::Weak : KeyError::None;
+}
+
+/**
+ * @brief Проверяет готовые индексы ключа (например, из файла ключей)
+ * @param indices Индексы букв
+ * @param n Длина ключа
+ * @return Код ошибки: Empty, Invalid (индекс вне алфавита) или Weak, как у keyIndices
+ */
+constexpr KeyError checkIndices(const uint8_t* indices, size_t n)
+{
+    if (n == 0)
+        return KeyError::Empty;
+    bool weak = true;
+    for (size_t i = 0; i < n; i++) {
+        if (indices[i] >= ALPHABET_SIZE)
+            return KeyError::Invalid;
+        if (indices[i] != indices[0])
+            weak = false;
+    }
+    return weak ? KeyError::Weak : KeyError::None;
+}
+
+namespace detail {
+
+/**
+ * @brief Индексы ключа-литерала по правилам modAlphaCipher
+ * @throw std::invalid_argument если ключ пустой, недопустимый или слабый
+ */
+template <size_t K>
+constexpr CipherLiteral<uint8_t, K> keyIndices(const wchar_t (&key)[K])
+{
+    CipherLiteral<uint8_t, K> indices;
+    while (indices.length + 1 < K && key[indices.length] != 0)
+        indices.length++;
+    KeyError error = alpha_core::keyIndices(key, indices.length, indices.chars);
+    if (error != KeyError::None)
+        throw std::invalid_argument(keyErrorMessage(error));
+    return indices;
+}
+
+/**
+ * @brief Шифрует или дешифрует литерал теми же функциями, что и modAlphaCipher
+ *
+ * Без passthrough небуквы открытого текста отбрасываются, а в
+ * шифротексте запрещены; строчные буквы шифротекста допустимы только
+ * с preserveCase.
+ */
+template <size_t N, size_t K>
+constexpr CipherLiteral<wchar_t, N> transform(const wchar_t (&text)[N], const wchar_t (&key)[K],
+                                              bool passthrough, bool preserveCase, bool decrypt)
+{
+    CipherLiteral<uint8_t, K> indices = keyIndices(key);
+    CipherLiteral<wchar_t, N> result;
+    while (result.length + 1 < N && text[result.length] != 0) {
+        unsigned c = letterCode(text[result.length]);
+        if (decrypt && !passthrough && (c == NOT_LETTER || ((c & LOWER_FLAG) && !preserveCase)))
+            throw std::invalid_argument("Invalid cipher text");
+        result.chars[result.length] = text[result.length];
+        result.length++;
+    }
+    if (result.length == 0)
+        throw std::invalid_argument(decrypt ? "Empty cipher text" : "Empty open text");
+    if (passthrough) {
+        shiftLetters<WideAlphabet>(result.chars, result.length, indices.chars, indices.length, decrypt, preserveCase);
+        return result;
+    }
+    size_t letters = filterLetters<WideAlphabet>(result.chars, result.length, result.chars, indices.chars,
+                                                 indices.length, decrypt, preserveCase);
+    if (letters == 0)
+        throw std::invalid_argument("Empty open text");
+    for (size_t i = letters; i < result.length; i++)
+        result.chars[i] = 0;
+    result.length = letters;
+    return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Шифрует строковый литерал на этапе компиляции
+ * @param text Открытый текст
+ * @param key Ключ
+ * @param passthrough true - небуквы сохраняются (TextMode::Passthrough)
+ * @param preserveCase true - строчные буквы остаются строчными
+ * @throw std::invalid_argument при ошибке; в константном выражении -
+ *        ошибка компиляции
+ */
+template <size_t N, size_t K>
+CIPHER_CONSTEVAL CipherLiteral<wchar_t, N> encryptLiteral(const wchar_t (&text)[N], const wchar_t (&key)[K],
+                                                          bool passthrough = false, bool preserveCase = false)
+{
+    return detail::transform(text, key, passthrough, preserveCase, false);
+}
+
+/**
+ * @brief Дешифрует строковый литерал на этапе компиляции
+ * @param text Шифротекст
+ * @param key Ключ
+ * @param passthrough true - небуквы сохраняются (TextMode::Passthrough)
+ * @param preserveCase true - строчные буквы остаются строчными
+ * @throw std::invalid_argument при ошибке; в константном выражении -
+ *        ошибка компиляции
+ */
+template <size_t N, size_t K>
+CIPHER_CONSTEVAL CipherLiteral<wchar_t, N> decryptLiteral(const wchar_t (&text)[N], const wchar_t (&key)[K],
+                                                          bool passthrough = false, bool preserveCase = false)
+{
+    return detail::transform(text, key, passthrough, preserveCase, true);
+}
+
+} // namespace alpha_core
@@ -0,0 +1,100 @@
+/**
+ * @file modAlphaSolver.h
+ * @brief Заголовочный файл для подбора ключа модифицированного алфавитного шифра
+ * @author Генералов Л.К.
+ * @version 1.0
+ * @copyright ИБСТ ПГУ
+ * @date 2025
+ *
+ * @details
+ * Восстановление утерянного ключа по шифротексту при известной длине ключа
+ * (периоде). Каждая буква ключа подбирается независимо по частотной оценке
+ * своего смежного класса, затем ключ уточняется восхождением к вершине
+ * по биграммной оценке с ранним отсечением кандидатов.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @struct SolverStats
+ * @brief Статистика работы подбора ключа
+ */
+struct SolverStats {
+    size_t candidates = 0;     ///< Количество оценённых кандидатов ключа
+    size_t pruned = 0;         ///< Количество кандидатов, отброшенных досрочно
+    size_t rounds = 0;         ///< Количество раундов восхождения к вершине
+    double seconds = 0.0;      ///< Время до получения решения, с
+    double keysPerSecond = 0.0;///< Скорость перебора, кандидатов/с
+};
+
+/**
+ * @struct SolverResult
+ * @brief Результат подбора ключа
+ */
+struct SolverResult {
+    std::wstring key;          ///< Найденный ключ в верхнем регистре
+    double score = 0.0;        ///< Биграммная оценка открытого текста (логарифм правдоподобия)
+    SolverStats stats;         ///< Статистика работы
+};
+
+class SolverPool;
+
+/**
+ * @class modAlphaSolver
+ * @brief Класс для подбора ключа модифицированного алфавитного шифра
+ *
+ * Подбор выполняется в два этапа:
+ * 1. Для каждой позиции ключа перебираются все 33 буквы; выбирается та,
+ *    при которой смежный класс шифротекста (символы i, i + period, ...)
+ *    даёт распределение, наиболее близкое к частотам русского языка.
+ * 2. Полученный ключ уточняется восхождением к вершине: в каждом раунде
+ *    оцениваются все замены одной буквы ключа по биграммной оценке
+ *    на выборке текста. Оценка кандидата прекращается, как только
+ *    частичная сумма опускается ниже лучшей известной.
+ *
+ * Кандидаты обоих этапов распределяются между потоками пула
+ * с перехватом работы (work stealing). Пул создаётся конструктором
+ * и живёт, пока жив объект: solve() вызывает его на каждом этапе
+ * и в каждом раунде, не создавая потоков заново.
+ */
+class modAlphaSolver
+{
+private:
+    /// Количество рабочих потоков
+    unsigned threads;
+
+    /// Пул потоков (threads - 1 потоков, нулевой - вызывающий)
+    std::unique_ptr<SolverPool> pool;
+
+    /// Максимальная длина выборки для биграммной оценки
+    size_t sampleSize;
+
+public:
+    /**
+     * @brief Конструктор
+     * @param threads Количество потоков (0 - по числу ядер)
+     * @param sampleSize Максимальное число букв для биграммной оценки
+     */
+    explicit modAlphaSolver(unsigned threads = 0, size_t sampleSize = 65536);
+
+    /**
+     * @brief Деструктор: останавливает потоки пула
+     */
+    ~modAlphaSolver();
+
+    modAlphaSolver(const modAlphaSolver&) = delete;
+    modAlphaSolver& operator=(const modAlphaSolver&) = delete;
+
+    /**
+     * @brief Подбирает ключ заданной длины
+     * @param cipher_text Зашифрованный текст (небуквенные символы пропускаются)
+     * @param period Длина ключа
+     * @return Найденный ключ, его оценка и статистика
+     * @throw cipher_error если период равен нулю или текст не содержит букв
+     */
+    SolverResult solve(const std::wstring& cipher_text, size_t period) const;
+};
@@ -25,10 +25,19 @@
  * - Проверка на слабые ключи
  * - Обработка исключений
  * - Поддержка широких символов (wstring)
+ * - Сохранение регистра букв в режимах Filter и Passthrough
+ * - Кодировки CP1251, KOI8-R и UTF-8 без преобразования в wstring
+ * - Шифрование строковых литералов на этапе компиляции (modAlphaCore.h)
+ * - Подбор утерянного ключа по шифротексту (modAlphaSolver)
+ * - Дешифрование окна шифротекста без обработки всего текста (decryptRange)
+ * - Компактный объект шифра: ключ в объекте, общие таблицы алфавита
  * 
  * ## Структура проекта
  * - `modAlphaCipher.h` - заголовочный файл с объявлением класса
  * - `modAlphaCipher.cpp` - реализация методов класса
+ * - `modAlphaCore.h` - заголовочное шаблонное ядро шифра (алфавиты wchar_t,
+ *   CP1251, KOI8-R, UTF-8; общее для литералов и класса)
+ * - `modAlphaSolver.h`, `modAlphaSolver.cpp` - подбор ключа
  * - `main.cpp` - тестирование функциональности
  * 
  * ## Алгоритм шифрования
@@ -51,10 +60,14 @@
  * ```
  */
 
+#include <chrono>
 #include <iostream>
 #include <locale>
 #include <codecvt>
+#include <memory>
+#include <vector>
 #include "modAlphaCipher.h"
+#include "modAlphaSolver.h"
 
 using namespace std;
 
@@ -102,6 +115,487 @@ void check(const wstring& Text, const wstring& key, const wstring& testName,
     wcout << endl;
 }
 
+/**
+ * @brief Тестирует режим Passthrough
+ * @param Text Исходный текст со знаками препинания и пробелами
+ * @param key Ключ шифрования
+ * @param testName Название теста
+ * 
+ * Небуквенные символы должны остаться на своих местах, регистр -
+ * сохраниться, а буквы - совпасть с результатом режима Filter.
+ */
+void checkPassthrough(const wstring& Text, const wstring& key, const wstring& testName)
+{
+    try {
+        modAlphaCipher cipher(key, modAlphaCipher::TextMode::Passthrough, true);
+        modAlphaCipher filter(key);
+        wstring cipherText = cipher.encrypt(Text);
+        wstring decryptedText = cipher.decrypt(cipherText);
+        
+        wcout << L"=== " << testName << L" ===" << endl;
+        wcout << L"Исходный текст: " << Text << endl;
+        wcout << L"Зашифрованный: " << cipherText << endl;
+        wcout << L"Расшифрованный: " << decryptedText << endl;
+        
+        // Буквы шифротекста (после фильтрации) совпадают с режимом Filter
+        wstring cipherLetters = filter.decrypt(filter.encrypt(cipherText));
+        if (Text == decryptedText && cipherLetters == filter.encrypt(Text))
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+            
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << e.what() << endl;
+    }
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует текст без букв в режимах Filter и Passthrough
+ * @param testName Название теста
+ * 
+ * Filter отвергает непустой текст без букв (EmptyOpenText при
+ * шифровании, InvalidCipherText при дешифровании), Passthrough
+ * возвращает его без изменений. Пустой текст - ошибка в обоих режимах.
+ */
+void checkNoLetters(const wstring& testName)
+{
+    typedef modAlphaCipher::Error Error;
+    const wstring text = L"2025, 12:00 - ok!";
+    modAlphaCipher filter(L"КЛЮЧ");
+    modAlphaCipher passthrough(L"КЛЮЧ", modAlphaCipher::TextMode::Passthrough);
+    
+    wcout << L"=== " << testName << L" ===" << endl;
+    wcout << L"Текст: " << text << endl;
+    modAlphaCipher::Result filtered = filter.tryEncrypt(text);
+    modAlphaCipher::Result kept = passthrough.tryEncrypt(text);
+    modAlphaCipher::Result restored = passthrough.tryDecrypt(text);
+    wcout << L"Filter: ошибка " << static_cast<int>(filtered.error)
+          << L", Passthrough: \"" << kept.text << L"\"" << endl;
+    
+    bool ok = filtered.error == Error::EmptyOpenText
+              && filter.tryDecrypt(text).error == Error::InvalidCipherText
+              && kept.error == Error::None && kept.text == text
+              && restored.error == Error::None && restored.text == text
+              && passthrough.tryEncrypt(L"").error == Error::EmptyOpenText
+              && passthrough.tryDecrypt(L"").error == Error::EmptyCipherText;
+    wcout << (ok ? L"[OK] Тест пройден\n" : L"[ERROR] Ошибка!\n");
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует режим Filter с сохранением регистра
+ * @param Text Исходный текст со знаками препинания и пробелами
+ * @param letters Ожидаемый результат дешифрования (буквы текста в исходном регистре)
+ * @param key Ключ шифрования
+ * @param testName Название теста
+ * 
+ * Небуквенные символы удаляются, регистр букв сохраняется: шифротекст
+ * совпадает с режимом Passthrough для одних только букв текста.
+ */
+void checkFilterCase(const wstring& Text, const wstring& letters, const wstring& key, const wstring& testName)
+{
+    try {
+        modAlphaCipher cipher(key, modAlphaCipher::TextMode::Filter, true);
+        modAlphaCipher passthrough(key, modAlphaCipher::TextMode::Passthrough, true);
+        modAlphaCipher filter(key);
+        wstring cipherText = cipher.encrypt(Text);
+        wstring decryptedText = cipher.decrypt(cipherText);
+        
+        wcout << L"=== " << testName << L" ===" << endl;
+        wcout << L"Исходный текст: " << Text << endl;
+        wcout << L"Зашифрованный: " << cipherText << endl;
+        wcout << L"Расшифрованный: " << decryptedText << endl;
+        
+        // Без сохранения регистра шифротекст со строчными буквами недопустим
+        bool lowerRejected = filter.tryDecrypt(cipherText).error == modAlphaCipher::Error::InvalidCipherText;
+        if (decryptedText == letters && cipherText == passthrough.encrypt(letters) && lowerRejected)
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+            
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << e.what() << endl;
+    }
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует дешифрование без исключений
+ * @param cipherText Зашифрованный текст
+ * @param key Ключ шифрования
+ * @param testName Название теста
+ * 
+ * Выводит код ошибки и позицию недопустимого символа вместо исключения.
+ */
+void checkNoThrow(const wstring& cipherText, const wstring& key, const wstring& testName)
+{
+    modAlphaCipher cipher(key);
+    modAlphaCipher::Result result = cipher.tryDecrypt(cipherText);
+    
+    wcout << L"=== " << testName << L" ===" << endl;
+    wcout << L"Шифротекст: " << cipherText << endl;
+    if (result)
+        wcout << L"Расшифрованный: " << result.text << endl;
+    else
+        wcout << L"Ошибка: " << modAlphaCipher::errorMessage(result.error)
+              << L", позиция: " << result.position << endl;
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует шифрование текста в однобайтовой кодировке
+ * @param Text Исходный текст в кодировке encoding
+ * @param expected Ожидаемый шифротекст в той же кодировке
+ * @param key Ключ шифрования
+ * @param encoding Кодировка (CP1251 или KOI8-R)
+ * @param testName Название теста
+ * 
+ * Используется режим Passthrough с сохранением регистра: результат
+ * должен совпасть с шифрованием того же текста в std::wstring.
+ */
+void checkBytes(const string& Text, const string& expected, const wstring& key,
+                modAlphaCipher::Encoding encoding, const wstring& testName)
+{
+    try {
+        modAlphaCipher cipher(key, modAlphaCipher::TextMode::Passthrough, true);
+        string cipherText = cipher.encrypt(Text, encoding);
+        string decryptedText = cipher.decrypt(cipherText, encoding);
+        
+        wcout << L"=== " << testName << L" ===" << endl;
+        wcout << L"Байт: " << Text.size() << L", зашифровано: " << cipherText.size() << endl;
+        if (cipherText == expected && decryptedText == Text)
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+            
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << e.what() << endl;
+    }
+    wcout << endl;
+}
+
+/// "Привет, Мир!", зашифрованный компилятором (Passthrough, с регистром)
+constexpr auto LITERAL_PASSTHROUGH = alpha_core::encryptLiteral(L"Привет, Мир!", L"КЛЮЧ", true, true);
+static_assert(LITERAL_PASSTHROUGH.size() == 12 && LITERAL_PASSTHROUGH[0] == L'Ъ'
+              && LITERAL_PASSTHROUGH[6] == L',' && LITERAL_PASSTHROUGH[8] == L'К', "constexpr encryption");
+
+/// Круговой путь на этапе компиляции (Filter)
+constexpr auto LITERAL_FILTER = alpha_core::encryptLiteral(L"ПРИВЕТМИР", L"КЛЮЧ");
+constexpr auto LITERAL_ROUND_TRIP = alpha_core::decryptLiteral(LITERAL_FILTER.chars, L"КЛЮЧ");
+static_assert(LITERAL_ROUND_TRIP.size() == 9 && LITERAL_ROUND_TRIP[0] == L'П'
+              && LITERAL_ROUND_TRIP[8] == L'Р', "constexpr round trip");
+
+/**
+ * @brief Сравнивает литералы, зашифрованные компилятором, с modAlphaCipher
+ * @param testName Название теста
+ */
+void checkLiteral(const wstring& testName)
+{
+    try {
+        modAlphaCipher passthrough(L"КЛЮЧ", modAlphaCipher::TextMode::Passthrough, true);
+        modAlphaCipher filter(L"КЛЮЧ");
+        
+        wcout << L"=== " << testName << L" ===" << endl;
+        wcout << L"Зашифровано компилятором: " << LITERAL_PASSTHROUGH.c_str() << endl;
+        wcout << L"Зашифровано классом: " << passthrough.encrypt(L"Привет, Мир!") << endl;
+        if (LITERAL_PASSTHROUGH.str() == passthrough.encrypt(L"Привет, Мир!")
+            && LITERAL_FILTER.str() == filter.encrypt(L"ПРИВЕТМИР")
+            && LITERAL_ROUND_TRIP.str() == L"ПРИВЕТМИР")
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+            
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << e.what() << endl;
+    }
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует дешифрование окна шифротекста
+ * @param testName Название теста
+ * 
+ * Окна длинного шифротекста в обоих режимах должны совпасть с
+ * соответствующими частями полного дешифрования. В режиме Filter окно
+ * задаётся блоками открытого текста через индекс, построенный при
+ * шифровании. Выводится время полного дешифрования и дешифрования окна
+ * в конце текста.
+ */
+void checkRange(const wstring& testName)
+{
+    try {
+        const wstring line = L"Запись журнала: Съешь же ещё этих мягких французских булок, да выпей чаю!\n";
+        wstring Text;
+        for (int i = 0; i < 20000; i++)
+            Text += line;
+        
+        modAlphaCipher passthrough(L"КЛЮЧ", modAlphaCipher::TextMode::Passthrough, true);
+        modAlphaCipher filter(L"КЛЮЧ", modAlphaCipher::TextMode::Filter, true);
+        wstring closed = passthrough.encrypt(Text);
+        wstring filtered = filter.encrypt(Text);
+        modAlphaCipher::SeekIndex index = modAlphaCipher::buildSeekIndex(closed);
+        modAlphaCipher::SeekIndex openIndex = modAlphaCipher::buildSeekIndex(Text, line.size());
+        
+        // Окна на границах блоков индекса и внутри них
+        bool ok = true;
+        const size_t offsets[] = {0, 1, 4095, 4096, 4097, 777777, Text.size() - 5};
+        for (size_t offset : offsets)
+            ok = ok && passthrough.decryptRange(closed, offset, 100, &index) == Text.substr(offset, 100)
+                 && passthrough.decryptRange(closed, offset, 100) == Text.substr(offset, 100);
+        
+        // Записи 1234-1236 в режиме Filter: смещения из индекса открытого текста
+        size_t from = openIndex.letters[1234], to = openIndex.letters[1237];
+        wstring records = filter.decryptRange(filtered, from, to - from);
+        ok = ok && records == filter.decrypt(filtered).substr(from, to - from)
+             && records == filter.decrypt(filter.encrypt(line + line + line));
+        
+        modAlphaCipher::Result outside = passthrough.tryDecryptRange(closed, closed.size(), 1, &index);
+        modAlphaCipher::SeekIndex other = modAlphaCipher::buildSeekIndex(filtered);
+        modAlphaCipher::Result stale = passthrough.tryDecryptRange(closed, 0, 1, &other);
+        ok = ok && outside.error == modAlphaCipher::Error::InvalidRange
+             && stale.error == modAlphaCipher::Error::InvalidRange;
+        
+        auto seconds = [](auto&& run) {
+            auto start = chrono::steady_clock::now();
+            run();
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        };
+        double full = seconds([&] { passthrough.decrypt(closed); });
+        double window = seconds([&] { passthrough.decryptRange(closed, closed.size() - 100, 100, &index); });
+        
+        wcout << L"=== " << testName << L" ===" << endl;
+        wcout << L"Символов: " << closed.size() << L", записи 1234-1236: " << records.size() << L" букв" << endl;
+        wcout << L"Полное дешифрование: " << full * 1e6 << L" мкс, окно в конце: " << window * 1e6 << L" мкс"
+              << endl;
+        if (ok)
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+            
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << e.what() << endl;
+    }
+    wcout << endl;
+}
+
+/**
+ * @brief Сравнивает ядра с фиксированной длиной ключа с обобщёнными
+ * @param testName Название теста
+ * 
+ * Для каждой длины ключа, для которой есть фиксированные ядра
+ * (alpha_core::selectKernels), выводится ускорение дешифрования
+ * шифротекста Filter (одни буквы) в wchar_t и CP1251 и дешифрования
+ * текста с пробелами и знаками Passthrough. Лучшее из трёх измерений
+ * каждого варианта; результаты ядер должны совпасть.
+ */
+void checkKernels(const wstring& testName)
+{
+    using namespace alpha_core;
+    const wstring phrase = L"Съешь же ещё этих мягких французских булок, да выпей чаю! ";
+    wstring mixed, letters;
+    for (size_t i = 0; i < (1 << 16); i++)
+        mixed += phrase[i % phrase.size()];
+    for (wchar_t c : mixed)
+        if (letterCode(c) != NOT_LETTER)
+            letters += c;
+    string bytes;
+    for (wchar_t c : letters)
+        bytes += Cp1251Alphabet::symbol(letterCode(c) & ~LOWER_FLAG, letterCode(c) & LOWER_FLAG);
+    
+    uint8_t key[64];
+    for (size_t i = 0; i < 64; i++)
+        key[i] = static_cast<uint8_t>((i * 7 + 3) % ALPHABET_SIZE);
+    
+    auto best = [](auto&& run) {
+        double result = 0;
+        for (int attempt = 0; attempt < 3; attempt++) {
+            auto start = chrono::steady_clock::now();
+            for (int round = 0; round < 20; round++)
+                run();
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            result = attempt == 0 || elapsed.count() < result ? elapsed.count() : result;
+        }
+        return result;
+    };
+    // Ускорение ядра kernel относительно generic; same - совпадение результатов
+    auto speedup = [&](auto generic, auto kernel, const auto& text, size_t keySize, bool& same) {
+        auto in = text, fast = text, slow = text;
+        double slowTime = best([&] { slow = in; generic(&slow[0], slow.size(), keySize); });
+        double fastTime = best([&] { fast = in; kernel(&fast[0], fast.size(), keySize); });
+        same = same && fast == slow;
+        return slowTime / fastTime;
+    };
+    
+    wcout << L"=== " << testName << L" ===" << endl;
+    wcout << L"Ключ | wchar_t | CP1251 | Passthrough" << endl;
+    bool same = true;
+    const size_t sizes[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 32, 64};
+    for (size_t size : sizes) {
+        auto filter = [&](auto kernel) {
+            return [&, kernel](auto* text, size_t n, size_t keySize) {
+                kernel(text, n, text, key, keySize, true, true, 0);
+            };
+        };
+        auto shift = [&](auto kernel) {
+            return [&, kernel](auto* text, size_t n, size_t keySize) {
+                kernel(text, n, key, keySize, true, true, 0);
+            };
+        };
+        double wide = speedup(filter(&filterLetters<WideAlphabet>),
+                              filter(selectKernels<WideAlphabet>(size).filter), letters, size, same);
+        double cp1251 = speedup(filter(&filterLetters<Cp1251Alphabet>),
+                                filter(selectKernels<Cp1251Alphabet>(size).filter), bytes, size, same);
+        double passthrough = speedup(shift(&shiftLetters<WideAlphabet>),
+                                     shift(selectKernels<WideAlphabet>(size).shift), mixed, size, same);
+        wcout << size << L" | x" << wide << L" | x" << cp1251 << L" | x" << passthrough << endl;
+    }
+    if (same)
+        wcout << L"[OK] Тест пройден\n";
+    else
+        wcout << L"[ERROR] Ошибка!\n";
+    wcout << endl;
+}
+
+/**
+ * @brief Сравнивает UTF-8 с преобразованием через std::wstring
+ * @param testName Название теста
+ * 
+ * Байтовые методы с Encoding::UTF8 должны давать то же, что
+ * wstring_convert, шифр std::wstring и обратное преобразование; для
+ * обоих путей выводится скорость дешифрования шифротекста Filter
+ * (одни буквы) и текста с пробелами и знаками Passthrough. Лучшее из
+ * трёх измерений каждого варианта.
+ */
+void checkUtf8(const wstring& testName)
+{
+    const wstring phrase = L"Съешь же ещё этих мягких французских булок, да выпей чаю! ";
+    wstring mixed;
+    for (size_t i = 0; i < (1 << 16); i++)
+        mixed += phrase[i % phrase.size()];
+    wstring_convert<codecvt_utf8<wchar_t>> utf8;
+    modAlphaCipher filter(L"КЛЮЧ", modAlphaCipher::TextMode::Filter, true);
+    modAlphaCipher passthrough(L"КЛЮЧ", modAlphaCipher::TextMode::Passthrough, true);
+    const modAlphaCipher::Encoding UTF8 = modAlphaCipher::Encoding::UTF8;
+    string letters = utf8.to_bytes(filter.encrypt(mixed));
+    string text = utf8.to_bytes(mixed);
+    
+    auto best = [](auto&& run) {
+        double result = 0;
+        for (int attempt = 0; attempt < 3; attempt++) {
+            auto start = chrono::steady_clock::now();
+            for (int round = 0; round < 20; round++)
+                run();
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            result = attempt == 0 || elapsed.count() < result ? elapsed.count() : result;
+        }
+        return result;
+    };
+    // Скорость дешифрования in двумя путями, МБ/с; same - совпадение результатов
+    bool same = true;
+    auto compare = [&](modAlphaCipher& cipher, const string& in, const wchar_t* name) {
+        string direct, converted;
+        double directTime = best([&] { direct = cipher.decrypt(in, UTF8); });
+        double convertedTime = best([&] { converted = utf8.to_bytes(cipher.decrypt(utf8.from_bytes(in))); });
+        same = same && direct == converted;
+        double megabytes = 20.0 * in.size() / 1e6;
+        wcout << name << L": UTF-8 " << megabytes / directTime << L" МБ/с, через wstring "
+              << megabytes / convertedTime << L" МБ/с, ускорение x" << convertedTime / directTime << endl;
+    };
+    
+    wcout << L"=== " << testName << L" ===" << endl;
+    compare(filter, letters, L"Filter");
+    compare(passthrough, text, L"Passthrough");
+    
+    // Шифрование, строчные буквы без сохранения регистра и ошибки
+    modAlphaCipher upper(L"КЛЮЧ");
+    string open = utf8.to_bytes(L"Привет, Мир! Ёж ёлка");
+    modAlphaCipher::ByteResult invalid = upper.tryDecrypt(utf8.to_bytes(L"ЪЬЖЩzЮ"), UTF8);
+    same = same && filter.encrypt(open, UTF8) == utf8.to_bytes(filter.encrypt(utf8.from_bytes(open)))
+           && upper.encrypt(open, UTF8) == utf8.to_bytes(upper.encrypt(utf8.from_bytes(open)))
+           && passthrough.encrypt(open, UTF8) == utf8.to_bytes(passthrough.encrypt(utf8.from_bytes(open)))
+           && invalid.error == modAlphaCipher::Error::InvalidCipherText && invalid.position == 8;
+    if (same)
+        wcout << L"[OK] Тест пройден\n";
+    else
+        wcout << L"[ERROR] Ошибка!\n";
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует размер и создание объектов шифра
+ * @param testName Название теста
+ * 
+ * Выводит размер объекта и время создания 100000 шифров с коротким
+ * ключом (ключ хранится в объекте). Копия шифра с длинным ключом
+ * должна шифровать так же, как оригинал, и после его удаления.
+ */
+void checkInstances(const wstring& testName)
+{
+    const wstring open = L"СЪЕШЬЖЕЕЩЁЭТИХМЯГКИХФРАНЦУЗСКИХБУЛОК";
+    const wstring keys[] = {L"КЛЮЧ", L"ШИФРОВАНИЕТЕКСТА", L"МОДИФИЦИРОВАННЫЙАЛФАВИТНЫЙШИФР"};
+    
+    wcout << L"=== " << testName << L" ===" << endl;
+    wcout << L"sizeof(modAlphaCipher): " << sizeof(modAlphaCipher) << L" байт" << endl;
+    
+    vector<modAlphaCipher> ciphers;
+    ciphers.reserve(100000);
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < 100000; i++)
+        ciphers.emplace_back(keys[i % 2]);
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    wcout << L"Создание шифра: " << elapsed.count() / ciphers.size() << L" нс" << endl;
+    
+    bool same = ciphers[0].encrypt(open) == modAlphaCipher(keys[0]).encrypt(open)
+                && ciphers[1].encrypt(open) == modAlphaCipher(keys[1]).encrypt(open);
+    for (const wstring& key : keys) {
+        auto original = make_unique<modAlphaCipher>(key, modAlphaCipher::TextMode::Passthrough);
+        wstring expected = original->encrypt(open);
+        modAlphaCipher copy = *original;
+        original.reset();
+        same = same && copy.encrypt(open) == expected && copy.decrypt(expected) == open;
+    }
+    if (same)
+        wcout << L"[OK] Тест пройден\n";
+    else
+        wcout << L"[ERROR] Ошибка!\n";
+    wcout << endl;
+}
+
+/**
+ * @brief Тестирует подбор ключа по шифротексту
+ * @param Text Исходный текст
+ * @param key Ключ шифрования (подбирается только по его длине)
+ * @param testName Название теста
+ */
+void checkSolver(const wstring& Text, const wstring& key, const wstring& testName)
+{
+    try {
+        modAlphaCipher cipher(key);
+        wstring cipherText = cipher.encrypt(Text);
+        
+        modAlphaSolver solver;
+        SolverResult result = solver.solve(cipherText, key.size());
+        
+        wcout << L"=== " << testName << L" ===" << endl;
+        wcout << L"Ключ: " << key << endl;
+        wcout << L"Найденный ключ: " << result.key << endl;
+        wcout << L"Кандидатов: " << result.stats.candidates
+              << L", отсечено: " << result.stats.pruned << endl;
+        wcout << L"Время: " << result.stats.seconds << L" с, "
+              << result.stats.keysPerSecond << L" ключей/с" << endl;
+        
+        if (result.key == key)
+            wcout << L"[OK] Тест пройден\n";
+        else
+            wcout << L"[ERROR] Ошибка!\n";
+            
+    } catch (const cipher_error& e) {
+        wcout << L"Ошибка cipher_error: " << e.what() << endl;
+    }
+    wcout << endl;
+}
+
 /**
  * @brief Главная функция программы
  * @return 0 при успешном выполнении
@@ -110,6 +604,15 @@ void check(const wstring& Text, const wstring& key, const wstring& testName,
  * 1. Тесты с русским текстом
  * 2. Тесты с английским текстом (должны вызывать исключения)
  * 3. Тесты с ошибочными входными данными
+ * 4. Тест режима Passthrough и текста без букв
+ * 5. Тест режима Filter с сохранением регистра
+ * 6. Тесты однобайтовых кодировок CP1251 и KOI8-R
+ * 7. Тест дешифрования без исключений
+ * 8. Тест дешифрования окна шифротекста
+ * 9. Сравнение ядер с фиксированной длиной ключа
+ * 10. Тест кодировки UTF-8
+ * 11. Тест размера и создания объектов
+ * 12. Тест подбора ключа
  */
 int main()
 {
@@ -141,7 +644,52 @@ int main()
     // Тест с порчей шифротекста
     check(L"ТЕСТ", L"ПАРОЛЬ", L"Тест с порчей шифротекста", true);
     
+    // Тест режима Passthrough
+    checkPassthrough(L"Привет, Мир! 2025 год.", L"КЛЮЧ", L"Режим Passthrough");
+    checkNoLetters(L"Текст без букв в режимах Filter и Passthrough");
+    
+    // Тест режима Filter с сохранением регистра
+    checkFilterCase(L"Привет, Мир! 2025 год.", L"ПриветМиргод", L"КЛЮЧ", L"Режим Filter с сохранением регистра");
+    
+    // Тесты однобайтовых кодировок: "Привет, Мир!" -> "Ъьжщпю, Каы!"
+    checkBytes("\xCF\xF0\xE8\xE2\xE5\xF2, \xCC\xE8\xF0!", "\xDA\xFC\xE6\xF9\xEF\xFE, \xCA\xE0\xFB!",
+               L"КЛЮЧ", modAlphaCipher::Encoding::CP1251, L"Кодировка CP1251");
+    checkBytes("\xF0\xD2\xC9\xD7\xC5\xD4, \xED\xC9\xD2!", "\xFF\xD8\xD6\xDD\xD0\xC0, \xEB\xC1\xD9!",
+               L"КЛЮЧ", modAlphaCipher::Encoding::KOI8R, L"Кодировка KOI8-R");
+    
+    // Тест шифрования литералов на этапе компиляции
+    checkLiteral(L"Шифрование литералов на этапе компиляции");
+    
+    // Тест дешифрования без исключений
+    checkNoThrow(L"ШИФРoТЕКСТ", L"КЛЮЧ", L"Дешифрование без исключений");
+    
+    // Тест дешифрования окна шифротекста
+    checkRange(L"Дешифрование окна шифротекста");
+    
+    // Ускорение ядер для коротких ключей
+    checkKernels(L"Ядра с фиксированной длиной ключа");
+    
+    // UTF-8 без преобразования в std::wstring
+    checkUtf8(L"Кодировка UTF-8");
+    
+    // Ключ в объекте и общие таблицы алфавита
+    checkInstances(L"Размер объекта шифра");
+    
+    // Тест подбора ключа
+    checkSolver(L"ЖИЛСТАРИКСОСВОЕЮСТАРУХОЙУСАМОГОСИНЕГОМОРЯОНИЖИЛИВВЕТХОЙЗЕМЛЯНКЕ"
+                L"РОВНОТРИДЦАТЬЛЕТИТРИГОДАСТАРИКЛОВИЛНЕВОДОМРЫБУСТАРУХАПРЯЛАСВОЮПРЯЖУ"
+                L"РАЗОНВМОРЕЗАКИНУЛНЕВОДПРИШЕЛНЕВОДСОДНОЮТИНОЙОНВДРУГОЙРАЗЗАКИНУЛНЕВОД"
+                L"ПРИШЕЛНЕВОДСТРАВОЙМОРСКОЮВТРЕТИЙРАЗЗАКИНУЛОННЕВОДПРИШЕЛНЕВОДСОДНОЮРЫБКОЙ",
+                L"КЛЮЧ", L"Подбор ключа");
+    
     wcout << L"=== ТЕСТИРОВАНИЕ ЗАВЕРШЕНО ===\n";
     
+    // Счётчики стадий шифра (при сборке make STATS=1); wcout занят
+    // широким выводом, поэтому таблица выводится в cerr
+    if (cipher_stats::enabled()) {
+        wcout.flush();
+        cipher_stats::report(cerr, cipher_stats::snapshot());
+    }
+    
     return 0;
 }
@@ -7,51 +7,249 @@
  * @date 2025
  * 
  * @details
- * Содержит реализацию основных методов шифрования и дешифрования,
- * а также вспомогательных методов преобразования.
+ * Нешаблонная обёртка над ядром modAlphaCore.h: открытые методы
+ * выбирают алфавит ядра и сводятся к transform и transformInPlace.
  */
 
 #include "modAlphaCipher.h"
-#include <iostream>
-#include <locale>
-#include <codecvt>
+#include <algorithm>
 
 using namespace std;
 
 /**
  * @brief Конструктор класса modAlphaCipher
  * @param skey Ключ шифрования
- * @throw cipher_error если ключ слабый (все символы одинаковые)
+ * @param mode Режим обработки небуквенных символов
+ * @param preserveCase Сохранять регистр букв
+ * @throw cipher_error если ключ пустой, содержит недопустимые символы
+ *        или слабый (все символы одинаковые)
  * 
- * Инициализирует алфавит и преобразует ключ в числовое представление.
+ * Преобразует ключ в индексы алфавита; ключ до INLINE_KEY букв
+ * записывается в объект без выделения памяти.
  */
-modAlphaCipher::modAlphaCipher(const std::wstring& skey)
+modAlphaCipher::modAlphaCipher(const std::wstring& skey, TextMode mode, bool preserveCase) :
+    inlineKey(), keySize(0), mode(mode), preserveCase(preserveCase)
 {
-    // Инициализация отображения символ -> индекс
-    for(unsigned i = 0; i < numAlpha.size(); i++) {
-        alphaNum[numAlpha[i]] = i;
+    setValidKey(skey);
+}
+
+/**
+ * @brief Шифр над готовыми индексами ключа без копирования
+ * @param owner Владелец памяти ключа
+ * @param key Индексы букв ключа 0..32
+ * @param size Длина ключа
+ * @param mode Режим обработки небуквенных символов
+ * @param preserveCase Сохранять регистр букв
+ * @throw cipher_error если ключ пустой, индекс вне алфавита или ключ слабый
+ * 
+ * longKey разделяет владение с owner (конструктор-псевдоним shared_ptr),
+ * поэтому память ключа живёт, пока жив шифр или его копия.
+ */
+modAlphaCipher modAlphaCipher::fromIndices(const std::shared_ptr<const void>& owner, const uint8_t* key, size_t size,
+                                           TextMode mode, bool preserveCase)
+{
+    alpha_core::KeyError error = alpha_core::checkIndices(key, size);
+    if (error != alpha_core::KeyError::None)
+        throw cipher_error(alpha_core::keyErrorMessage(error));
+    modAlphaCipher cipher(mode, preserveCase);
+    cipher.longKey = std::shared_ptr<const uint8_t[]>(owner, key);
+    cipher.keySize = size;
+    return cipher;
+}
+
+/**
+ * @brief Валидирует ключ шифрования и сохраняет его индексы
+ * @param s Входной ключ
+ * @throw cipher_error если ключ пустой, содержит недопустимые символы
+ *        или слабый
+ */
+void modAlphaCipher::setValidKey(const std::wstring& s)
+{
+    std::unique_ptr<uint8_t[]> indices;
+    if (s.size() > INLINE_KEY)
+        indices.reset(new uint8_t[s.size()]);
+    alpha_core::KeyError error = alpha_core::keyIndices(s.data(), s.size(), indices ? indices.get() : inlineKey);
+    if (error != alpha_core::KeyError::None)
+        throw cipher_error(alpha_core::keyErrorMessage(error));
+    longKey = std::move(indices);
+    keySize = s.size();
+}
+
+/**
+ * @brief Шифрует или дешифрует текст алфавитом Alphabet
+ * @param text Входной текст
+ * @param decrypt true - дешифрование
+ * @param phase Позиция в ключе для первой буквы
+ * @return Результат или код ошибки
+ * 
+ * Шифротекст проверяется без копирования, затем буквы сдвигаются
+ * за один проход ядром режима Filter (alpha_core::filterLetters или
+ * его версией для длины ключа): это и фильтрация открытого текста,
+ * и перевод регистра.
+ */
+template <class Alphabet, class ResultT>
+ResultT modAlphaCipher::transform(const std::basic_string<typename Alphabet::char_type>& text, bool decrypt,
+                                  size_t phase) const
+{
+    using CharT = typename Alphabet::char_type;
+    ResultT result;
+    if (mode == TextMode::Passthrough) {
+        result.text = text;
+        result.error = transformInPlace<Alphabet>(result.text, decrypt, phase);
+        return result;
     }
     
-    // Валидация ключа
-    std::wstring validKey = getValidKey(skey);
+    if (decrypt) {
+        if (text.empty()) {
+            result.error = Error::EmptyCipherText;
+            return result;
+        }
+        size_t invalid;
+        {
+            CIPHER_STAGE(AlphaValidate, cipher_stats::encodedBytes(text.data(), text.size()));
+            invalid = Alphabet::findInvalid(text.data(), text.size(), preserveCase);
+        }
+        if (invalid != std::basic_string<CharT>::npos) {
+            result.error = Error::InvalidCipherText;
+            result.position = invalid;
+            return result;
+        }
+    }
     
-    // Проверка на слабый ключ (все одинаковые символы)
-    bool isWeakKey = true;
-    if (validKey.size() > 1) {
-        wchar_t firstChar = validKey[0];
-        for (size_t i = 1; i < validKey.size(); i++) {
-            if (validKey[i] != firstChar) {
-                isWeakKey = false;
-                break;
-            }
+    CIPHER_STAGE(AlphaShift, cipher_stats::encodedBytes(text.data(), text.size()));
+    result.text.resize(text.size());
+    size_t letters = kernelsFor<Alphabet>().filter(text.data(), text.size(), &result.text[0], key(), keySize,
+                                                   decrypt, preserveCase, phase);
+    if (letters == 0) {
+        result.text.clear();
+        result.error = Error::EmptyOpenText;
+        return result;
+    }
+    result.text.resize(letters);
+    return result;
+}
+
+/**
+ * @brief Шифрует или дешифрует текст на месте (режим Passthrough)
+ * @param text Текст, заменяемый результатом
+ * @param decrypt true - дешифрование
+ * @param phase Позиция в ключе для первой буквы
+ * @return Код ошибки
+ * 
+ * Позиция в ключе увеличивается только на буквах.
+ */
+template <class Alphabet>
+modAlphaCipher::Error modAlphaCipher::transformInPlace(std::basic_string<typename Alphabet::char_type>& text,
+                                                       bool decrypt, size_t phase) const
+{
+    if (mode != TextMode::Passthrough)
+        return Error::UnsupportedMode;
+    if (text.empty())
+        return decrypt ? Error::EmptyCipherText : Error::EmptyOpenText;
+    CIPHER_STAGE(AlphaShift, cipher_stats::encodedBytes(text.data(), text.size()));
+    kernelsFor<Alphabet>().shift(&text[0], text.size(), key(), keySize, decrypt, preserveCase, phase);
+    return Error::None;
+}
+
+/**
+ * @brief Дешифрует окно шифротекста алфавитом Alphabet
+ * @param text Весь шифротекст
+ * @param offset Начало окна
+ * @param length Длина окна
+ * @param index Индекс шифротекста или nullptr
+ * @return Открытый текст окна или код ошибки
+ * 
+ * Позиция в ключе для первой буквы окна: в режиме Filter каждый символ
+ * шифротекста - буква, поэтому это offset / Alphabet::UNITS mod длина
+ * ключа; в режиме Passthrough - число букв перед окном mod длина ключа,
+ * которое индекс даёт с точностью до одного блока. Окно не может
+ * разрезать букву из нескольких байтов.
+ */
+template <class Alphabet, class ResultT>
+ResultT modAlphaCipher::transformRange(const std::basic_string<typename Alphabet::char_type>& text, size_t offset,
+                                       size_t length, const SeekIndex* index) const
+{
+    using CharT = typename Alphabet::char_type;
+    ResultT result;
+    if (text.empty()) {
+        result.error = Error::EmptyCipherText;
+        return result;
+    }
+    if (offset >= text.size() || length == 0) {
+        result.error = Error::InvalidRange;
+        return result;
+    }
+    length = std::min(length, text.size() - offset);
+    const CharT* window = text.data() + offset;
+    if constexpr (Alphabet::UNITS > 1) {
+        if (Alphabet::insideLetter(text.data(), text.size(), offset)
+            || Alphabet::insideLetter(text.data(), text.size(), offset + length)) {
+            result.error = Error::InvalidRange;
+            return result;
         }
     }
-    if (isWeakKey && validKey.size() > 0) {
-        throw cipher_error("Weak key");
+    
+    if (mode == TextMode::Passthrough) {
+        if (index && (index->stride == 0 || index->size != text.size()
+                      || index->letters.size() != text.size() / index->stride + 1)) {
+            result.error = Error::InvalidRange;
+            return result;
+        }
+        CIPHER_STAGE(AlphaShift, cipher_stats::encodedBytes(window, length));
+        size_t block = index ? offset / index->stride * index->stride : 0;
+        size_t letters = (index ? index->letters[offset / index->stride] : 0)
+                         + Alphabet::countLetters(text.data() + block, offset - block);
+        result.text.assign(window, length);
+        kernelsFor<Alphabet>().shift(&result.text[0], length, key(), keySize, true, preserveCase,
+                                     letters % keySize);
+        return result;
     }
     
-    // Преобразование ключа в числовое представление
-    key = convert(validKey);
+    size_t invalid;
+    {
+        CIPHER_STAGE(AlphaValidate, cipher_stats::encodedBytes(window, length));
+        invalid = Alphabet::findInvalid(window, length, preserveCase);
+    }
+    if (invalid != std::basic_string<CharT>::npos) {
+        result.error = Error::InvalidCipherText;
+        result.position = offset + invalid;
+        return result;
+    }
+    CIPHER_STAGE(AlphaShift, cipher_stats::encodedBytes(window, length));
+    result.text.resize(length);
+    kernelsFor<Alphabet>().filter(window, length, &result.text[0], key(), keySize, true, preserveCase,
+                                  offset / Alphabet::UNITS % keySize);
+    return result;
+}
+
+/**
+ * @brief Строит индекс числа букв алфавитом Alphabet
+ * @param text Текст
+ * @param stride Шаг индекса
+ * @return Индекс
+ * @throw cipher_error если шаг равен нулю
+ *
+ * Буква из нескольких байтов на границе блоков не входит целиком ни в
+ * один блок и прибавляется к числу букв на этой границе.
+ */
+template <class Alphabet>
+modAlphaCipher::SeekIndex modAlphaCipher::seekIndex(const std::basic_string<typename Alphabet::char_type>& text,
+                                                    size_t stride)
+{
+    if (stride == 0)
+        throw cipher_error("Invalid index stride");
+    SeekIndex index;
+    index.stride = stride;
+    index.size = text.size();
+    index.letters.reserve(text.size() / stride + 1);
+    index.letters.push_back(0);
+    for (size_t at = 0; at + stride <= text.size(); at += stride) {
+        size_t letters = Alphabet::countLetters(text.data() + at, stride);
+        if constexpr (Alphabet::UNITS > 1)
+            letters += Alphabet::insideLetter(text.data(), text.size(), at + stride);
+        index.letters.push_back(index.letters.back() + letters);
+    }
+    return index;
 }
 
 /**
@@ -60,68 +258,311 @@ modAlphaCipher::modAlphaCipher(const std::wstring& skey)
  * @return Зашифрованный текст
  * @throw cipher_error если текст пустой после фильтрации
  * 
- * Алгоритм шифрования: (символ_текста + символ_ключа) mod размер_алфавита
+ * Обёртка над tryEncrypt, преобразующая код ошибки в исключение.
  */
-std::wstring modAlphaCipher::encrypt(const std::wstring& open_text)
+std::wstring modAlphaCipher::encrypt(const std::wstring& open_text) const
 {
-    std::vector<int> work = convert(getValidOpenText(open_text));
-    for(unsigned i = 0; i < work.size(); i++) {
-        work[i] = (work[i] + key[i % key.size()]) % numAlpha.size();
-    }
-    return convert(work);
+    Result result = tryEncrypt(open_text);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
 }
 
 /**
  * @brief Дешифрует зашифрованный текст
  * @param cipher_text Зашифрованный текст
  * @return Расшифрованный текст
- * @throw cipher_error если текст пустой или содержит строчные буквы
+ * @throw cipher_error если текст пустой или содержит небуквенные символы
+ *        (или строчные буквы без сохранения регистра)
+ * 
+ * Обёртка над tryDecrypt, преобразующая код ошибки в исключение.
+ */
+std::wstring modAlphaCipher::decrypt(const std::wstring& cipher_text) const
+{
+    Result result = tryDecrypt(cipher_text);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Шифрует открытый текст без исключений
+ * @param open_text Открытый текст для шифрования
+ * @param position Число букв потока перед текстом
+ * @return Зашифрованный текст или код ошибки
+ * 
+ * Алгоритм шифрования: (символ_текста + символ_ключа) mod размер_алфавита
+ */
+modAlphaCipher::Result modAlphaCipher::tryEncrypt(const std::wstring& open_text, size_t position) const
+{
+    return transform<alpha_core::WideAlphabet, Result>(open_text, false, position % keySize);
+}
+
+/**
+ * @brief Дешифрует зашифрованный текст без исключений
+ * @param cipher_text Зашифрованный текст
+ * @param position Число букв потока перед текстом
+ * @return Расшифрованный текст или код ошибки с позицией
  * 
  * Алгоритм дешифрования: (символ_шифротекста - символ_ключа + размер_алфавита) mod размер_алфавита
  */
-std::wstring modAlphaCipher::decrypt(const std::wstring& cipher_text)
+modAlphaCipher::Result modAlphaCipher::tryDecrypt(const std::wstring& cipher_text, size_t position) const
+{
+    return transform<alpha_core::WideAlphabet, Result>(cipher_text, true, position % keySize);
+}
+
+/**
+ * @brief Дешифрует окно шифротекста
+ * @throw cipher_error при ошибке
+ */
+std::wstring modAlphaCipher::decryptRange(const std::wstring& cipher_text, size_t offset, size_t length,
+                                          const SeekIndex* index) const
+{
+    Result result = tryDecryptRange(cipher_text, offset, length, index);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Дешифрует окно шифротекста без исключений
+ */
+modAlphaCipher::Result modAlphaCipher::tryDecryptRange(const std::wstring& cipher_text, size_t offset,
+                                                       size_t length, const SeekIndex* index) const
 {
-    std::vector<int> work = convert(getValidCipherText(cipher_text));
-    for(unsigned i = 0; i < work.size(); i++) {
-        work[i] = (work[i] + numAlpha.size() - key[i % key.size()]) % numAlpha.size();
+    return transformRange<alpha_core::WideAlphabet, Result>(cipher_text, offset, length, index);
+}
+
+/**
+ * @brief Строит индекс числа букв текста
+ * @throw cipher_error если шаг равен нулю
+ */
+modAlphaCipher::SeekIndex modAlphaCipher::buildSeekIndex(const std::wstring& text, size_t stride)
+{
+    return seekIndex<alpha_core::WideAlphabet>(text, stride);
+}
+
+/**
+ * @brief Шифрует текст на месте (режим Passthrough)
+ * @param text Текст, заменяемый зашифрованным
+ * @return Код ошибки
+ */
+modAlphaCipher::Error modAlphaCipher::encryptInPlace(std::wstring& text) const
+{
+    return transformInPlace<alpha_core::WideAlphabet>(text, false);
+}
+
+/**
+ * @brief Дешифрует текст на месте (режим Passthrough)
+ * @param text Текст, заменяемый расшифрованным
+ * @return Код ошибки
+ */
+modAlphaCipher::Error modAlphaCipher::decryptInPlace(std::wstring& text) const
+{
+    return transformInPlace<alpha_core::WideAlphabet>(text, true);
+}
+
+/**
+ * @brief Возвращает текст сообщения об ошибке
+ * @param error Код ошибки
+ * @return Сообщение, совпадающее с текстом cipher_error
+ */
+const char* modAlphaCipher::errorMessage(Error error)
+{
+    switch (error) {
+    case Error::None:
+        return "No error";
+    case Error::EmptyOpenText:
+        return "Empty open text";
+    case Error::EmptyCipherText:
+        return "Empty cipher text";
+    case Error::InvalidCipherText:
+        return "Invalid cipher text";
+    case Error::UnsupportedMode:
+        return "Unsupported text mode";
+    case Error::InvalidRange:
+        return "Invalid range";
     }
-    return convert(work);
+    return "Unknown error";
+}
+
+// Байтовые кодировки
+
+/**
+ * @brief Шифрует текст в байтовой кодировке
+ * @param open_text Открытый текст
+ * @param encoding Кодировка
+ * @return Зашифрованный текст
+ * @throw cipher_error если текст не содержит букв
+ */
+std::string modAlphaCipher::encrypt(const std::string& open_text, Encoding encoding) const
+{
+    ByteResult result = tryEncrypt(open_text, encoding);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
 }
 
 /**
- * @brief Преобразует строку в вектор числовых индексов
- * @param s Входная строка
- * @return Вектор индексов символов в алфавите
+ * @brief Дешифрует текст в байтовой кодировке
+ * @param cipher_text Зашифрованный текст
+ * @param encoding Кодировка
+ * @return Расшифрованный текст
+ * @throw cipher_error если текст пустой или содержит недопустимые символы
+ */
+std::string modAlphaCipher::decrypt(const std::string& cipher_text, Encoding encoding) const
+{
+    ByteResult result = tryDecrypt(cipher_text, encoding);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Шифрует текст в байтовой кодировке без исключений
+ * @param open_text Открытый текст
+ * @param encoding Кодировка
+ * @param position Число букв потока перед текстом
+ * @return Зашифрованный текст или код ошибки
  * 
- * Каждый символ строки преобразуется в его позицию в алфавите.
- * Символы, отсутствующие в алфавите, игнорируются.
+ * Однобайтовая буква переводится в индекс таблицей ядра на 256
+ * элементов и обратно, буква UTF-8 - декодером ядра: байты -> байты
+ * без промежуточных широких строк.
  */
-std::vector<int> modAlphaCipher::convert(const std::wstring& s)
+modAlphaCipher::ByteResult modAlphaCipher::tryEncrypt(const std::string& open_text, Encoding encoding,
+                                                      size_t position) const
 {
-    std::vector<int> result;
-    for(auto c : s) {
-        if (alphaNum.find(c) != alphaNum.end()) {
-            result.push_back(alphaNum[c]);
-        }
+    size_t phase = position % keySize;
+    switch (encoding) {
+    case Encoding::KOI8R:
+        return transform<alpha_core::Koi8rAlphabet, ByteResult>(open_text, false, phase);
+    case Encoding::UTF8:
+        return transform<alpha_core::Utf8Alphabet, ByteResult>(open_text, false, phase);
+    case Encoding::CP1251:
+        break;
     }
-    return result;
+    return transform<alpha_core::Cp1251Alphabet, ByteResult>(open_text, false, phase);
 }
 
 /**
- * @brief Преобразует вектор числовых индексов в строку
- * @param v Вектор индексов
- * @return Строка символов
- * 
- * Каждый индекс преобразуется в соответствующий символ алфавита.
- * Индексы вне диапазона алфавита игнорируются.
+ * @brief Дешифрует текст в байтовой кодировке без исключений
+ * @param cipher_text Зашифрованный текст
+ * @param encoding Кодировка
+ * @param position Число букв потока перед текстом
+ * @return Расшифрованный текст или код ошибки с позицией
  */
-std::wstring modAlphaCipher::convert(const std::vector<int>& v)
+modAlphaCipher::ByteResult modAlphaCipher::tryDecrypt(const std::string& cipher_text, Encoding encoding,
+                                                      size_t position) const
 {
-    std::wstring result;
-    for(auto i : v) {
-        if (i >= 0 && i < (int)numAlpha.size()) {
-            result.push_back(numAlpha[i]);
-        }
+    size_t phase = position % keySize;
+    switch (encoding) {
+    case Encoding::KOI8R:
+        return transform<alpha_core::Koi8rAlphabet, ByteResult>(cipher_text, true, phase);
+    case Encoding::UTF8:
+        return transform<alpha_core::Utf8Alphabet, ByteResult>(cipher_text, true, phase);
+    case Encoding::CP1251:
+        break;
     }
-    return result;
+    return transform<alpha_core::Cp1251Alphabet, ByteResult>(cipher_text, true, phase);
+}
+
+/**
+ * @brief Дешифрует окно шифротекста в байтовой кодировке
+ * @throw cipher_error при ошибке
+ */
+std::string modAlphaCipher::decryptRange(const std::string& cipher_text, Encoding encoding, size_t offset,
+                                         size_t length, const SeekIndex* index) const
+{
+    ByteResult result = tryDecryptRange(cipher_text, encoding, offset, length, index);
+    if (!result)
+        throw cipher_error(errorMessage(result.error));
+    return std::move(result.text);
+}
+
+/**
+ * @brief Дешифрует окно шифротекста в байтовой кодировке без исключений
+ */
+modAlphaCipher::ByteResult modAlphaCipher::tryDecryptRange(const std::string& cipher_text, Encoding encoding,
+                                                           size_t offset, size_t length, const SeekIndex* index) const
+{
+    switch (encoding) {
+    case Encoding::KOI8R:
+        return transformRange<alpha_core::Koi8rAlphabet, ByteResult>(cipher_text, offset, length, index);
+    case Encoding::UTF8:
+        return transformRange<alpha_core::Utf8Alphabet, ByteResult>(cipher_text, offset, length, index);
+    case Encoding::CP1251:
+        break;
+    }
+    return transformRange<alpha_core::Cp1251Alphabet, ByteResult>(cipher_text, offset, length, index);
+}
+
+/**
+ * @brief Строит индекс числа букв текста в байтовой кодировке
+ * @throw cipher_error если шаг равен нулю
+ */
+modAlphaCipher::SeekIndex modAlphaCipher::buildSeekIndex(const std::string& text, Encoding encoding, size_t stride)
+{
+    switch (encoding) {
+    case Encoding::KOI8R:
+        return seekIndex<alpha_core::Koi8rAlphabet>(text, stride);
+    case Encoding::UTF8:
+        return seekIndex<alpha_core::Utf8Alphabet>(text, stride);
+    case Encoding::CP1251:
+        break;
+    }
+    return seekIndex<alpha_core::Cp1251Alphabet>(text, stride);
+}
+
+/**
+ * @brief Считает буквы текста в байтовой кодировке
+ */
+size_t modAlphaCipher::countLetters(const std::string& text, Encoding encoding)
+{
+    switch (encoding) {
+    case Encoding::KOI8R:
+        return alpha_core::Koi8rAlphabet::countLetters(text.data(), text.size());
+    case Encoding::UTF8:
+        return alpha_core::Utf8Alphabet::countLetters(text.data(), text.size());
+    case Encoding::CP1251:
+        break;
+    }
+    return alpha_core::Cp1251Alphabet::countLetters(text.data(), text.size());
+}
+
+/**
+ * @brief Шифрует текст в байтовой кодировке на месте (режим Passthrough)
+ * @param text Текст, заменяемый зашифрованным
+ * @param encoding Кодировка
+ * @return Код ошибки
+ */
+modAlphaCipher::Error modAlphaCipher::encryptInPlace(std::string& text, Encoding encoding) const
+{
+    switch (encoding) {
+    case Encoding::KOI8R:
+        return transformInPlace<alpha_core::Koi8rAlphabet>(text, false);
+    case Encoding::UTF8:
+        return transformInPlace<alpha_core::Utf8Alphabet>(text, false);
+    case Encoding::CP1251:
+        break;
+    }
+    return transformInPlace<alpha_core::Cp1251Alphabet>(text, false);
+}
+
+/**
+ * @brief Дешифрует текст в байтовой кодировке на месте (режим Passthrough)
+ * @param text Текст, заменяемый расшифрованным
+ * @param encoding Кодировка
+ * @return Код ошибки
+ */
+modAlphaCipher::Error modAlphaCipher::decryptInPlace(std::string& text, Encoding encoding) const
+{
+    switch (encoding) {
+    case Encoding::KOI8R:
+        return transformInPlace<alpha_core::Koi8rAlphabet>(text, true);
+    case Encoding::UTF8:
+        return transformInPlace<alpha_core::Utf8Alphabet>(text, true);
+    case Encoding::CP1251:
+        break;
+    }
+    return transformInPlace<alpha_core::Cp1251Alphabet>(text, true);
 }
@@ -0,0 +1,472 @@
+/**
+ * @file modAlphaSolver.cpp
+ * @brief Реализация подбора ключа модифицированного алфавитного шифра
+ * @author Генералов Л.К.
+ * @version 1.0
+ * @copyright ИБСТ ПГУ
+ * @date 2025
+ *
+ * @details
+ * Содержит частотную и биграммную модели русского языка, постоянный
+ * пул потоков с перехватом работы и оба этапа подбора ключа.
+ */
+
+#include "modAlphaSolver.h"
+#include "modAlphaCipher.h"
+#include "modAlphaCore.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class SolverPool
+ * @brief Постоянный пул потоков подбора ключа
+ *
+ * Потоки создаются один раз вместе с modAlphaSolver и ждут заданий
+ * на условной переменной. run() раздаёт одно задание всем потокам
+ * (номер 0 выполняет вызывающий поток) и ждёт их завершения; вызовы
+ * run() из разных потоков выполняются по очереди.
+ */
+class SolverPool
+{
+private:
+    typedef std::function<void(unsigned)> Job;
+
+    std::vector<std::thread> workers;   ///< Потоки 1..size()-1
+    std::mutex serial;                  ///< Одно задание за раз
+    std::mutex lock;                    ///< Защищает поля ниже
+    std::condition_variable wake;       ///< Новое задание или остановка
+    std::condition_variable finished;   ///< Все потоки завершили задание
+    const Job* job = nullptr;           ///< Текущее задание
+    size_t generation = 0;              ///< Номер текущего задания
+    unsigned active = 0;                ///< Потоков, ещё выполняющих задание
+    bool stop = false;                  ///< Остановка пула
+
+    /**
+     * @brief Цикл потока пула
+     * @param self Номер потока
+     */
+    void loop(unsigned self)
+    {
+        size_t seen = 0;
+        for (;;) {
+            const Job* current;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return stop || generation != seen; });
+                if (stop) return;
+                seen = generation;
+                current = job;
+            }
+            (*current)(self);
+            std::lock_guard<std::mutex> guard(lock);
+            if (--active == 0)
+                finished.notify_one();
+        }
+    }
+
+public:
+    /**
+     * @brief Запускает threads - 1 потоков
+     */
+    explicit SolverPool(unsigned threads)
+    {
+        for (unsigned w = 1; w < threads; w++)
+            workers.emplace_back(&SolverPool::loop, this, w);
+    }
+
+    /**
+     * @brief Останавливает и присоединяет потоки
+     */
+    ~SolverPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    SolverPool(const SolverPool&) = delete;
+    SolverPool& operator=(const SolverPool&) = delete;
+
+    /// Число потоков вместе с вызывающим
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    /**
+     * @brief Выполняет task(0..size()-1) на всех потоках и ждёт завершения
+     */
+    void run(const Job& task)
+    {
+        std::lock_guard<std::mutex> one(serial);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            job = &task;
+            active = static_cast<unsigned>(workers.size());
+            generation++;
+        }
+        wake.notify_all();
+        task(0);
+        std::unique_lock<std::mutex> guard(lock);
+        finished.wait(guard, [&] { return active == 0; });
+        job = nullptr;
+    }
+};
+
+namespace {
+
+/// Размер алфавита (индексы букв - как в alpha_core и modAlphaCipher)
+const int ALPHA = static_cast<int>(alpha_core::ALPHABET_SIZE);
+
+/// Частоты букв русского языка, % (в порядке алфавита)
+const double FREQ[ALPHA] = {
+    8.01, 1.59, 4.54, 1.70, 2.98, 8.45, 0.04, 0.94, 1.65, 7.35, 1.21,
+    3.49, 4.40, 3.21, 6.70, 10.97, 2.81, 4.73, 5.47, 6.26, 2.62, 0.26,
+    0.97, 0.48, 1.44, 0.73, 0.36, 0.04, 1.90, 1.74, 0.32, 0.64, 2.01
+};
+
+/// Наиболее частые биграммы русского языка
+const wchar_t* const COMMON_BIGRAMS[] = {
+    L"СТ", L"НО", L"ТО", L"НА", L"ЕН", L"ОВ", L"НИ", L"РА", L"ВО", L"КО",
+    L"ЛИ", L"ЕР", L"ОС", L"ПО", L"ГО", L"ОР", L"ПР", L"АЛ", L"ЕТ", L"ТА",
+    L"ОЛ", L"НЕ", L"ОН", L"ЛЕ", L"ВА", L"КА", L"РЕ", L"ЕЛ", L"ЕС", L"АН",
+    L"ТЕ", L"ЛО", L"ОМ", L"ОД", L"ЕМ", L"ИЕ", L"ВЕ", L"ДЕ", L"ИЛ", L"ТИ"
+};
+
+/**
+ * @brief Возвращает индекс буквы в алфавите или -1
+ * @param c Символ (регистр не учитывается)
+ */
+int letterIndex(wchar_t c)
+{
+    unsigned code = alpha_core::letterCode(c);
+    return code == alpha_core::NOT_LETTER ? -1 : static_cast<int>(code & ~alpha_core::LOWER_FLAG);
+}
+
+/**
+ * @brief Логарифмы частот букв
+ */
+const std::vector<double>& unigramScores()
+{
+    static const std::vector<double> scores = [] {
+        std::vector<double> s(ALPHA);
+        for (int i = 0; i < ALPHA; i++)
+            s[i] = std::log(FREQ[i] / 100.0);
+        return s;
+    }();
+    return scores;
+}
+
+/**
+ * @brief Упрощённая биграммная модель
+ *
+ * Вероятность биграммы - произведение частот букв, увеличенное
+ * для частых сочетаний и уменьшенное для невозможных (Ь, Ъ, Ы после
+ * гласной, Й, Ь или Ъ). После нормировки все оценки отрицательны,
+ * поэтому частичная сумма по тексту может только убывать.
+ */
+const std::vector<double>& bigramScores()
+{
+    static const std::vector<double> scores = [] {
+        const std::wstring vowels = L"АЕЁИОУЫЭЮЯЙЬЪ";
+        const std::wstring soft = L"ЬЪЫ";
+        std::vector<double> p(ALPHA * ALPHA);
+        for (int a = 0; a < ALPHA; a++) {
+            for (int b = 0; b < ALPHA; b++) {
+                double w = FREQ[a] * FREQ[b];
+                if (vowels.find(alpha_core::letter(a, false)) != std::wstring::npos &&
+                    soft.find(alpha_core::letter(b, false)) != std::wstring::npos)
+                    w *= 0.01;
+                p[a * ALPHA + b] = w;
+            }
+        }
+        for (auto bigram : COMMON_BIGRAMS)
+            p[letterIndex(bigram[0]) * ALPHA + letterIndex(bigram[1])] *= 4.0;
+
+        double total = 0.0;
+        for (auto w : p) total += w;
+        for (auto& w : p) w = std::log(w / total);
+        return p;
+    }();
+    return scores;
+}
+
+/**
+ * @brief Наибольшая (наименее отрицательная) оценка биграммы
+ */
+double bestBigramScore()
+{
+    static const double best = [] {
+        const std::vector<double>& table = bigramScores();
+        return *std::max_element(table.begin(), table.end());
+    }();
+    return best;
+}
+
+/**
+ * @struct WorkQueue
+ * @brief Диапазон задач одного потока
+ */
+struct WorkQueue {
+    std::mutex lock;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+/**
+ * @brief Берёт следующую задачу из собственной очереди
+ */
+bool takeOwn(WorkQueue& q, size_t& task)
+{
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.begin == q.end) return false;
+    task = q.begin++;
+    return true;
+}
+
+/**
+ * @brief Перехватывает верхнюю половину чужой очереди
+ */
+bool stealHalf(WorkQueue& victim, WorkQueue& self)
+{
+    size_t from, to;
+    {
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.begin == victim.end) return false;
+        from = victim.begin + (victim.end - victim.begin) / 2;
+        to = victim.end;
+        victim.end = from;
+    }
+    std::lock_guard<std::mutex> guard(self.lock);
+    self.begin = from;
+    self.end = to;
+    return true;
+}
+
+/**
+ * @brief Выполняет task(i) для i из [0, count) на пуле с перехватом работы
+ *
+ * Диапазон делится между потоками поровну; освободившийся поток
+ * забирает половину оставшихся задач у соседа.
+ */
+template <class Task>
+void parallelFor(size_t count, SolverPool& pool, const Task& task)
+{
+    unsigned threads = pool.size();
+    if (threads > count) threads = static_cast<unsigned>(count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    std::vector<WorkQueue> queues(threads);
+    for (unsigned w = 0; w < threads; w++) {
+        queues[w].begin = count * w / threads;
+        queues[w].end = count * (w + 1) / threads;
+    }
+
+    pool.run([&](unsigned self) {
+        if (self >= threads) return;
+        size_t i;
+        for (;;) {
+            if (takeOwn(queues[self], i)) {
+                task(i);
+                continue;
+            }
+            bool stolen = false;
+            for (unsigned d = 1; d < threads && !stolen; d++)
+                stolen = stealHalf(queues[(self + d) % threads], queues[self]);
+            if (!stolen) return;
+        }
+    });
+}
+
+/**
+ * @brief Атомарно увеличивает значение, если новое больше
+ */
+bool raiseTo(std::atomic<double>& target, double value)
+{
+    double current = target.load();
+    while (value > current) {
+        if (target.compare_exchange_weak(current, value))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Биграммная оценка расшифровки выборки заданным ключом
+ * @param sample Выборка шифротекста (индексы букв)
+ * @param key Ключ (индексы букв)
+ * @param bound Порог отсечения
+ * @return Оценка или -inf, если даже при наилучших оставшихся биграммах
+ *         итог не превысит порог
+ */
+double bigramScore(const std::vector<int>& sample, const std::vector<int>& key,
+                   const std::atomic<double>& bound)
+{
+    const std::vector<double>& table = bigramScores();
+    const double ceiling = bestBigramScore();
+    const size_t period = key.size();
+    double sum = 0.0;
+    int prev = (sample[0] - key[0] + ALPHA) % ALPHA;
+    size_t k = 1 % period;
+    for (size_t i = 1; i < sample.size(); i++) {
+        int cur = (sample[i] - key[k] + ALPHA) % ALPHA;
+        sum += table[prev * ALPHA + cur];
+        prev = cur;
+        if (++k == period) k = 0;
+        // Верхняя граница итога: оставшиеся биграммы не лучше наилучшей
+        if ((i & 63) == 0 &&
+            sum + (sample.size() - 1 - i) * ceiling < bound.load(std::memory_order_relaxed))
+            return -std::numeric_limits<double>::infinity();
+    }
+    return sum;
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор
+ * @param threads Количество потоков (0 - по числу ядер)
+ * @param sampleSize Максимальное число букв для биграммной оценки
+ */
+modAlphaSolver::modAlphaSolver(unsigned threads, size_t sampleSize) :
+    threads(threads), sampleSize(sampleSize)
+{
+    if (this->threads == 0)
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+    if (this->sampleSize < 2)
+        this->sampleSize = 2;
+    pool.reset(new SolverPool(this->threads));
+}
+
+/**
+ * @brief Деструктор: останавливает потоки пула
+ */
+modAlphaSolver::~modAlphaSolver() = default;
+
+/**
+ * @brief Подбирает ключ заданной длины
+ * @param cipher_text Зашифрованный текст
+ * @param period Длина ключа
+ * @return Найденный ключ, его оценка и статистика
+ * @throw cipher_error если период равен нулю или текст не содержит букв
+ */
+SolverResult modAlphaSolver::solve(const std::wstring& cipher_text, size_t period) const
+{
+    if (period == 0)
+        throw cipher_error("Zero key period");
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<int> letters;
+    letters.reserve(cipher_text.size());
+    for (auto c : cipher_text) {
+        int i = letterIndex(c);
+        if (i >= 0) letters.push_back(i);
+    }
+    if (letters.empty())
+        throw cipher_error("Empty cipher text");
+
+    SolverResult result;
+
+    // Этап 1: гистограммы смежных классов по частям текста
+    const size_t sliceSize = 1 << 16;
+    const size_t slices = (letters.size() + sliceSize - 1) / sliceSize;
+    std::vector<std::vector<size_t>> partial(slices);
+    parallelFor(slices, *pool, [&](size_t s) {
+        std::vector<size_t> counts(period * ALPHA, 0);
+        size_t begin = s * sliceSize;
+        size_t end = std::min(letters.size(), begin + sliceSize);
+        size_t p = begin % period;
+        for (size_t i = begin; i < end; i++) {
+            counts[p * ALPHA + letters[i]]++;
+            if (++p == period) p = 0;
+        }
+        partial[s].swap(counts);
+    });
+    std::vector<size_t> counts(period * ALPHA, 0);
+    for (const auto& part : partial)
+        for (size_t i = 0; i < counts.size(); i++)
+            counts[i] += part[i];
+
+    // Этап 1: 33 кандидата на каждую позицию ключа
+    const std::vector<double>& uni = unigramScores();
+    std::vector<double> cosetScore(period * ALPHA);
+    parallelFor(period * ALPHA, *pool, [&](size_t task) {
+        size_t p = task / ALPHA;
+        int k = static_cast<int>(task % ALPHA);
+        double s = 0.0;
+        for (int j = 0; j < ALPHA; j++)
+            s += counts[p * ALPHA + j] * uni[(j - k + ALPHA) % ALPHA];
+        cosetScore[task] = s;
+    });
+    result.stats.candidates += period * ALPHA;
+
+    std::vector<int> key(period);
+    for (size_t p = 0; p < period; p++) {
+        auto first = cosetScore.begin() + p * ALPHA;
+        key[p] = static_cast<int>(std::max_element(first, first + ALPHA) - first);
+    }
+
+    // Этап 2: восхождение к вершине по биграммной оценке
+    if (letters.size() > 1) {
+        std::vector<int> sample(letters.begin(),
+                                letters.begin() + std::min(letters.size(), sampleSize));
+        std::atomic<double> unbounded(-std::numeric_limits<double>::infinity());
+        double current = bigramScore(sample, key, unbounded);
+        std::atomic<size_t> pruned(0);
+
+        for (;;) {
+            std::atomic<double> best(current);
+            std::mutex bestLock;
+            size_t bestTask = 0;
+            bool improved = false;
+
+            parallelFor(period * (ALPHA - 1), *pool, [&](size_t task) {
+                size_t p = task / (ALPHA - 1);
+                int k = static_cast<int>(task % (ALPHA - 1));
+                if (k >= key[p]) k++;
+                std::vector<int> candidate(key);
+                candidate[p] = k;
+                double s = bigramScore(sample, candidate, best);
+                if (s == -std::numeric_limits<double>::infinity()) {
+                    pruned++;
+                    return;
+                }
+                std::lock_guard<std::mutex> guard(bestLock);
+                if (raiseTo(best, s)) {
+                    bestTask = task;
+                    improved = true;
+                }
+            });
+            result.stats.candidates += period * (ALPHA - 1);
+
+            if (!improved) break;
+            size_t p = bestTask / (ALPHA - 1);
+            int k = static_cast<int>(bestTask % (ALPHA - 1));
+            key[p] = k >= key[p] ? k + 1 : k;
+            current = best.load();
+            result.stats.rounds++;
+        }
+        result.score = current;
+        result.stats.pruned = pruned.load();
+    }
+
+    for (auto k : key)
+        result.key.push_back(alpha_core::letter(k, false));
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.stats.seconds = elapsed.count();
+    if (result.stats.seconds > 0)
+        result.stats.keysPerSecond = result.stats.candidates / result.stats.seconds;
+    return result;
+}